@@ -0,0 +1,94 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "CMakeFiles/VerifyGlobs.cmake"
+  "CMakeFiles/cmake.verify_globs"
+  "/root/repo/test/3rd/CMakeLists.txt"
+  "/root/repo/test/3rd/benchmark-1.6.1/CMakeLists.txt"
+  "/root/repo/test/3rd/benchmark-1.6.1/cmake/AddCXXCompilerFlag.cmake"
+  "/root/repo/test/3rd/benchmark-1.6.1/cmake/CXXFeatureCheck.cmake"
+  "/root/repo/test/3rd/benchmark-1.6.1/cmake/Config.cmake.in"
+  "/root/repo/test/3rd/benchmark-1.6.1/cmake/GetGitVersion.cmake"
+  "/root/repo/test/3rd/benchmark-1.6.1/cmake/benchmark.pc.in"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/CMakeLists.txt"
+  "/root/repo/test/CMakeLists.txt"
+  "/root/repo/test/bt/CMakeLists.txt"
+  "/root/repo/test/fixture/CMakeLists.txt"
+  "/root/repo/tools/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/BasicConfigVersion-SameMajorVersion.cmake.in"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCheckCompilerFlagCommonPatterns.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakePackageConfigHelpers.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXCompilerFlag.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindGit.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/GNUInstallDirs.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckCompilerFlag.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckFlagCommonConfig.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  "/usr/share/cmake-3.25/Modules/WriteBasicConfigVersionFile.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "test/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "test/3rd/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "test/3rd/benchmark-1.6.1/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "test/3rd/benchmark-1.6.1/benchmarkConfig.cmake"
+  "test/3rd/benchmark-1.6.1/benchmarkConfigVersion.cmake"
+  "test/3rd/benchmark-1.6.1/benchmark.pc"
+  "test/3rd/benchmark-1.6.1/src/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "test/fixture/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "test/bt/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tools/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/DependInfo.cmake"
+  "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark_main.dir/DependInfo.cmake"
+  "test/fixture/CMakeFiles/fixture.dir/DependInfo.cmake"
+  "test/bt/CMakeFiles/shmap_bench_test.dir/DependInfo.cmake"
+  "tools/CMakeFiles/shmap-stat.dir/DependInfo.cmake"
+  "tools/CMakeFiles/shmap-inspect.dir/DependInfo.cmake"
+  "tools/CMakeFiles/shmap-trace.dir/DependInfo.cmake"
+  )
@@ -0,0 +1,134 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by CMake Version 3.25
+cmake_policy(SET CMP0009 NEW)
+
+# SOURCES at test/bt/CMakeLists.txt:7 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/bt/*.C")
+set(OLD_GLOB
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bt_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SOURCES at test/bt/CMakeLists.txt:7 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/bt/*.CC")
+set(OLD_GLOB
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bt_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SOURCES at test/bt/CMakeLists.txt:7 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/bt/*.CPP")
+set(OLD_GLOB
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bt_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SOURCES at test/bt/CMakeLists.txt:7 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/bt/*.c")
+set(OLD_GLOB
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bt_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SOURCES at test/bt/CMakeLists.txt:7 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/bt/*.c++")
+set(OLD_GLOB
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bt_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SOURCES at test/bt/CMakeLists.txt:7 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/bt/*.cc")
+set(OLD_GLOB
+  "/root/repo/test/bt/test_shm_hash_table.cc"
+  "/root/repo/test/bt/test_shm_ring_buffer_mp.cc"
+  "/root/repo/test/bt/test_shm_storage_mp.cc"
+  "/root/repo/test/bt/test_shmap.cc"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bt_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SOURCES at test/bt/CMakeLists.txt:7 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/bt/*.cpp")
+set(OLD_GLOB
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bt_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SOURCES at test/fixture/CMakeLists.txt:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/fixture/*.C")
+set(OLD_GLOB
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bt_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SOURCES at test/fixture/CMakeLists.txt:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/fixture/*.CC")
+set(OLD_GLOB
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bt_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SOURCES at test/fixture/CMakeLists.txt:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/fixture/*.CPP")
+set(OLD_GLOB
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bt_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SOURCES at test/fixture/CMakeLists.txt:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/fixture/*.c")
+set(OLD_GLOB
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bt_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SOURCES at test/fixture/CMakeLists.txt:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/fixture/*.c++")
+set(OLD_GLOB
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bt_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SOURCES at test/fixture/CMakeLists.txt:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/fixture/*.cc")
+set(OLD_GLOB
+  "/root/repo/test/fixture/process_launcher.cc"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bt_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SOURCES at test/fixture/CMakeLists.txt:1 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/test/fixture/*.cpp")
+set(OLD_GLOB
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_bt_build/CMakeFiles/cmake.verify_globs")
+endif()
@@ -0,0 +1,37 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/test/3rd/benchmark-1.6.1/src/benchmark.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/benchmark.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/benchmark.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/benchmark_api_internal.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/benchmark_api_internal.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/benchmark_api_internal.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/benchmark_name.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/benchmark_name.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/benchmark_name.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/benchmark_register.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/benchmark_register.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/benchmark_register.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/benchmark_runner.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/benchmark_runner.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/benchmark_runner.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/colorprint.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/colorprint.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/colorprint.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/commandlineflags.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/commandlineflags.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/commandlineflags.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/complexity.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/complexity.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/complexity.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/console_reporter.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/console_reporter.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/console_reporter.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/counter.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/counter.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/counter.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/csv_reporter.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/csv_reporter.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/csv_reporter.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/json_reporter.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/json_reporter.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/json_reporter.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/perf_counters.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/perf_counters.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/perf_counters.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/reporter.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/reporter.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/reporter.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/sleep.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/sleep.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/sleep.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/statistics.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/statistics.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/statistics.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/string_util.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/string_util.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/string_util.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/sysinfo.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/sysinfo.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/sysinfo.cc.o.d"
+  "/root/repo/test/3rd/benchmark-1.6.1/src/timers.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/timers.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/timers.cc.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,20 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/test/3rd/benchmark-1.6.1/src/benchmark_main.cc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark_main.dir/benchmark_main.cc.o" "gcc" "test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark_main.dir/benchmark_main.cc.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_bt_build/test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
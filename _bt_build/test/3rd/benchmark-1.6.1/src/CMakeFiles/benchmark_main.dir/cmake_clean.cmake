@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/benchmark_main.dir/benchmark_main.cc.o"
+  "CMakeFiles/benchmark_main.dir/benchmark_main.cc.o.d"
+  "libbenchmark_main.a"
+  "libbenchmark_main.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchmark_main.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
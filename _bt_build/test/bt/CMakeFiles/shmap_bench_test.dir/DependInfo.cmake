@@ -0,0 +1,24 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/test/bt/test_shm_hash_table.cc" "test/bt/CMakeFiles/shmap_bench_test.dir/test_shm_hash_table.cc.o" "gcc" "test/bt/CMakeFiles/shmap_bench_test.dir/test_shm_hash_table.cc.o.d"
+  "/root/repo/test/bt/test_shm_ring_buffer_mp.cc" "test/bt/CMakeFiles/shmap_bench_test.dir/test_shm_ring_buffer_mp.cc.o" "gcc" "test/bt/CMakeFiles/shmap_bench_test.dir/test_shm_ring_buffer_mp.cc.o.d"
+  "/root/repo/test/bt/test_shm_storage_mp.cc" "test/bt/CMakeFiles/shmap_bench_test.dir/test_shm_storage_mp.cc.o" "gcc" "test/bt/CMakeFiles/shmap_bench_test.dir/test_shm_storage_mp.cc.o.d"
+  "/root/repo/test/bt/test_shmap.cc" "test/bt/CMakeFiles/shmap_bench_test.dir/test_shmap.cc.o" "gcc" "test/bt/CMakeFiles/shmap_bench_test.dir/test_shmap.cc.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_bt_build/test/3rd/benchmark-1.6.1/src/CMakeFiles/benchmark.dir/DependInfo.cmake"
+  "/root/repo/_bt_build/test/fixture/CMakeFiles/fixture.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
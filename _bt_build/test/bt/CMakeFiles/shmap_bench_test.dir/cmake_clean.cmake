@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/shmap_bench_test.dir/test_shm_hash_table.cc.o"
+  "CMakeFiles/shmap_bench_test.dir/test_shm_hash_table.cc.o.d"
+  "CMakeFiles/shmap_bench_test.dir/test_shm_ring_buffer_mp.cc.o"
+  "CMakeFiles/shmap_bench_test.dir/test_shm_ring_buffer_mp.cc.o.d"
+  "CMakeFiles/shmap_bench_test.dir/test_shm_storage_mp.cc.o"
+  "CMakeFiles/shmap_bench_test.dir/test_shm_storage_mp.cc.o.d"
+  "CMakeFiles/shmap_bench_test.dir/test_shmap.cc.o"
+  "CMakeFiles/shmap_bench_test.dir/test_shmap.cc.o.d"
+  "shmap_bench_test"
+  "shmap_bench_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/shmap_bench_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/fixture.dir/process_launcher.cc.o"
+  "CMakeFiles/fixture.dir/process_launcher.cc.o.d"
+  "libfixture.a"
+  "libfixture.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/fixture.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/shmap-inspect.dir/shmap_inspect.cc.o"
+  "CMakeFiles/shmap-inspect.dir/shmap_inspect.cc.o.d"
+  "shmap-inspect"
+  "shmap-inspect.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/shmap-inspect.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
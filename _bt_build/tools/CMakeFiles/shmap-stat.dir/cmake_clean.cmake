@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/shmap-stat.dir/shmap_stat.cc.o"
+  "CMakeFiles/shmap-stat.dir/shmap_stat.cc.o.d"
+  "shmap-stat"
+  "shmap-stat.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/shmap-stat.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/shmap-trace.dir/shmap_trace.cc.o"
+  "CMakeFiles/shmap-trace.dir/shmap_trace.cc.o.d"
+  "shmap-trace"
+  "shmap-trace.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/shmap-trace.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
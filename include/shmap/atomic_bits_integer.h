@@ -0,0 +1,124 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef SHMAP_ATOMIC_BITS_INTEGER_H
+#define SHMAP_ATOMIC_BITS_INTEGER_H
+
+#include "shmap/bits_integer.h"
+
+#include <atomic>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace shmap {
+
+/* -------------------------------------------------------------------------- */
+/*          AtomicBitsInteger – lock-free packed word of BitsInteger fields   */
+/* -------------------------------------------------------------------------- */
+template<typename UnderlyingType, typename... Fields>
+struct AtomicBitsInteger {
+    using Bits = BitsInteger<UnderlyingType, Fields...>;
+
+    static_assert(std::atomic<UnderlyingType>::is_always_lock_free,
+        "Underlying atomic must be lock free to be shared across processes");
+
+    constexpr AtomicBitsInteger() noexcept
+    : value_(0) {}
+
+    explicit constexpr AtomicBitsInteger(Bits value) noexcept
+    : value_(value.GetValue()) {}
+
+    AtomicBitsInteger(const AtomicBitsInteger&) = delete;
+    AtomicBitsInteger& operator=(const AtomicBitsInteger&) = delete;
+
+    Bits Load(std::memory_order order = std::memory_order_acquire) const noexcept {
+        return Bits(value_.load(order));
+    }
+
+    void Store(Bits value, std::memory_order order = std::memory_order_release) noexcept {
+        value_.store(value.GetValue(), order);
+    }
+
+    Bits Exchange(Bits value, std::memory_order order = std::memory_order_acq_rel) noexcept {
+        return Bits(value_.exchange(value.GetValue(), order));
+    }
+
+    // On failure `expected` is updated with the current value
+    bool CompareExchange(Bits& expected, Bits desired,
+        std::memory_order success = std::memory_order_acq_rel,
+        std::memory_order failure = std::memory_order_acquire) noexcept {
+        UnderlyingType raw = expected.GetValue();
+        bool ok = value_.compare_exchange_strong(raw, desired.GetValue(), success, failure);
+        expected = raw;
+        return ok;
+    }
+
+    // CAS loop applying `fn` to the whole word.
+    // `fn` returns the new Bits, or std::optional<Bits> with nullopt to give up.
+    // Returns the old value on success, nullopt if `fn` gave up.
+    template<typename F /* Bits|std::optional<Bits> (Bits) */>
+    std::optional<Bits> FetchUpdate(F&& fn) noexcept {
+        UnderlyingType old = value_.load(std::memory_order_relaxed);
+        while (true) {
+            std::optional<Bits> desired = fn(Bits(old));
+            if (!desired) {
+                return std::nullopt;
+            }
+            if (value_.compare_exchange_weak(old, desired->GetValue(),
+                    std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                return Bits(old);
+            }
+        }
+    }
+
+    // CAS loop applying `fn` to field E only, other fields are kept as they are.
+    // `fn` returns the new field value, or std::optional of it with nullopt to give up.
+    // Returns the old value on success, nullopt if `fn` gave up or its result overflows the field.
+    template<auto E, typename F /* U|std::optional<U> (U) */>
+    std::optional<Bits> FetchUpdate(F&& fn) noexcept {
+        using Field = typename detail::FindField<E, Fields...>::type;
+        static_assert(!std::is_void_v<Field>, "Invalid enum value for this AtomicBitsInteger");
+
+        return FetchUpdate([&fn](Bits old) -> std::optional<Bits> {
+            std::optional<UnderlyingType> field = fn(old.template Get<E>());
+            if (!field || *field > Field::template MaxValue<UnderlyingType>()) {
+                return std::nullopt;
+            }
+            return Bits(old).template Set<E>(*field);
+        });
+    }
+
+    // Add `delta` to field E, fails with nullopt instead of overflowing into other fields
+    template<auto E>
+    std::optional<Bits> FetchAdd(UnderlyingType delta) noexcept {
+        using Field = typename detail::FindField<E, Fields...>::type;
+        static_assert(!std::is_void_v<Field>, "Invalid enum value for this AtomicBitsInteger");
+
+        return FetchUpdate<E>([delta](UnderlyingType v) -> std::optional<UnderlyingType> {
+            if (delta > Field::template MaxValue<UnderlyingType>() - v) {
+                return std::nullopt;
+            }
+            return v + delta;
+        });
+    }
+
+    // Subtract `delta` from field E, fails with nullopt instead of wrapping around
+    template<auto E>
+    std::optional<Bits> FetchSub(UnderlyingType delta) noexcept {
+        return FetchUpdate<E>([delta](UnderlyingType v) -> std::optional<UnderlyingType> {
+            if (delta > v) {
+                return std::nullopt;
+            }
+            return v - delta;
+        });
+    }
+
+private:
+    std::atomic<UnderlyingType> value_;
+};
+
+}
+
+#endif
@@ -5,42 +5,201 @@
 #ifndef SHMAP_BACKOFF_H
 #define SHMAP_BACKOFF_H
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <thread>
 
+#if defined(__x86_64__) || defined(__i386__)
+    #include <cpuid.h>
+    #include <x86intrin.h>
+#endif
+
 namespace shmap {
 
-struct Backoff {
-    Backoff(std::chrono::nanoseconds to)
-        : start_(Clock::now()), timeout_(to) {}
+namespace detail {
+    // Hint the CPU that we are spinning: frees the pipeline for the sibling
+    // hyper-thread and avoids the memory-order flush when the wait ends
+    inline void CpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        __asm__ __volatile__("yield" ::: "memory");
+#endif
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*          Clocks – monotonic tick sources for deadline checks               */
+/* -------------------------------------------------------------------------- */
+struct SteadyClock {
+    using Ticks = uint64_t;
+
+    static Ticks Now() noexcept {
+        return static_cast<Ticks>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static Ticks FromNanos(std::chrono::nanoseconds ns) noexcept {
+        return ns.count() > 0 ? static_cast<Ticks>(ns.count()) : 0;
+    }
+};
+
+// Reads the time stamp counter (a few ns, no vDSO call). The tick rate is
+// calibrated once per process against steady_clock, a ~200us spin; without an
+// invariant TSC it falls back to steady_clock nanoseconds.
+struct TscClock {
+    using Ticks = uint64_t;
+
+    static Ticks Now() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        if (Calibration().reliable) {
+            return __rdtsc();
+        }
+#endif
+        return SteadyClock::Now();
+    }
+
+    static Ticks FromNanos(std::chrono::nanoseconds ns) noexcept {
+        if (ns.count() <= 0) {
+            return 0;
+        }
+        double ticks = static_cast<double>(ns.count()) * Calibration().ticksPerNano;
+        return ticks >= static_cast<double>(UINT64_MAX) ? UINT64_MAX : static_cast<Ticks>(ticks);
+    }
+
+    static bool IsTsc() noexcept {
+        return Calibration().reliable;
+    }
+
+    // Pays for the calibration up front, e.g. when attaching a segment, instead of
+    // in the first wait that reads the clock
+    static void Calibrate() noexcept {
+        Calibration();
+    }
+
+private:
+    struct Calibrated {
+        bool   reliable{false};
+        double ticksPerNano{1.0};
+    };
+
+    static const Calibrated& Calibration() noexcept {
+        static const Calibrated calibrated = Measure();
+        return calibrated;
+    }
+
+    static Calibrated Measure() noexcept {
+        Calibrated result;
+#if defined(__x86_64__) || defined(__i386__)
+        // CPUID.80000007H:EDX[8], TSC runs at a constant rate in all power states
+        unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8))) {
+            return result;
+        }
+        // Spin ~200us once, enough for a rate well within 1% of the real one
+        constexpr uint64_t CALIBRATION_NANOS = 200'000;
+        uint64_t t0 = SteadyClock::Now();
+        uint64_t c0 = __rdtsc();
+        uint64_t t1 = t0;
+        while (t1 - t0 < CALIBRATION_NANOS) {
+            t1 = SteadyClock::Now();
+        }
+        uint64_t c1 = __rdtsc();
+        if (c1 > c0) {
+            result.reliable = true;
+            result.ticksPerNano = static_cast<double>(c1 - c0) / static_cast<double>(t1 - t0);
+        }
+#endif
+        return result;
+    }
+};
+
+/* -------------------------------------------------------------------------- */
+/*          Backoff policies                                                  */
+/* -------------------------------------------------------------------------- */
+// Phases: SPIN_LIMIT steps of pause spinning (1, 2, 4 ... 1 << MAX_PAUSE_EXP pauses),
+// then YIELD_LIMIT yields, then sleeps doubling from 1ns up to 1 << MAX_SLEEP_EXP ns.
+// While spinning the deadline is only checked every CLOCK_CHECK_INTERVAL steps.
+struct DefaultBackoffPolicy {
+    using Clock = TscClock;
+
+    static constexpr uint32_t SPIN_LIMIT           = 16;
+    static constexpr uint32_t MAX_PAUSE_EXP        = 6;
+    static constexpr uint32_t YIELD_LIMIT          = 10;
+    static constexpr uint32_t MAX_SLEEP_EXP        = 20;
+    static constexpr uint32_t CLOCK_CHECK_INTERVAL = 4;
+};
+
+// No pause phase, clock read every step: for waits known to be long
+struct YieldSleepBackoffPolicy {
+    using Clock = SteadyClock;
+
+    static constexpr uint32_t SPIN_LIMIT           = 0;
+    static constexpr uint32_t MAX_PAUSE_EXP        = 0;
+    static constexpr uint32_t YIELD_LIMIT          = 10;
+    static constexpr uint32_t MAX_SLEEP_EXP        = 20;
+    static constexpr uint32_t CLOCK_CHECK_INTERVAL = 1;
+};
+
+/* -------------------------------------------------------------------------- */
+/*          BasicBackoff                                                      */
+/* -------------------------------------------------------------------------- */
+template<typename POLICY>
+struct BasicBackoff {
+    static_assert(POLICY::CLOCK_CHECK_INTERVAL > 0, "CLOCK_CHECK_INTERVAL must be > 0");
+    static_assert(POLICY::MAX_PAUSE_EXP < 32 && POLICY::MAX_SLEEP_EXP < 63, "Backoff exponent is too large");
+
+    using Policy = POLICY;
+    using Clock  = typename POLICY::Clock;
+
+    // The clock is first read by next(), so an operation that never waits never reads it
+    BasicBackoff(std::chrono::nanoseconds to)
+        : to_(to) {}
 
     // one backoff step; return false if overall timeout exceeded
     bool next() {
-        if (Clock::now() - start_ > timeout_) return false;
+        if (step_ == 0) {
+            start_   = Clock::Now();
+            timeout_ = Clock::FromNanos(to_);
+        }
+        // Yield and sleep cost a syscall anyway, check the deadline on every one of them
+        if (step_ >= POLICY::SPIN_LIMIT || step_ % POLICY::CLOCK_CHECK_INTERVAL == 0) {
+            // After a migration the TSC of the new core may read a little behind start_:
+            // count that as no time elapsed rather than wrapping to a huge difference
+            const typename Clock::Ticks now = Clock::Now();
+            if (now > start_ && now - start_ > timeout_) return false;
+        }
 
-        if (spin_ < YIELD_LIMIT) {
+        if (step_ < POLICY::SPIN_LIMIT) {
+            uint32_t pauses = 1u << std::min(step_, POLICY::MAX_PAUSE_EXP);
+            for (uint32_t i = 0; i < pauses; ++i) {
+                detail::CpuRelax();
+            }
+        } else if (step_ < POLICY::SPIN_LIMIT + POLICY::YIELD_LIMIT) {
             std::this_thread::yield();
         } else {
-            int  expected = std::min(spin_ - YIELD_LIMIT, MAX_BACKOFF_EXP);
-            // Cap at 1ms to prevent overflow and excessive delays
-            auto nanos = std::chrono::nanoseconds(std::min(1LL << expected, 1'000'000LL));
-            std::this_thread::sleep_for(nanos);
+            uint32_t expected = std::min(step_ - POLICY::SPIN_LIMIT - POLICY::YIELD_LIMIT, POLICY::MAX_SLEEP_EXP);
+            std::this_thread::sleep_for(std::chrono::nanoseconds(1LL << expected));
         }
-        ++spin_;
+        ++step_;
         return true;
     }
+
+    // Number of steps taken so far
+    uint32_t steps() const noexcept {
+        return step_;
+    }
+
 private:
-    using Clock = std::chrono::steady_clock;
-    Clock::time_point start_;
-    std::chrono::nanoseconds timeout_;
-    int spin_{0};
-
-    // first N attempts use yield()
-    static constexpr int  YIELD_LIMIT      = 10;
-    // exponent cap: 1 << MAX_BACKOFF_EXP ns ~1ms
-    static constexpr int  MAX_BACKOFF_EXP  = 20;
+    std::chrono::nanoseconds to_;
+    typename Clock::Ticks start_{0};
+    typename Clock::Ticks timeout_{0};
+    uint32_t step_{0};
 };
 
+using Backoff = BasicBackoff<DefaultBackoffPolicy>;
+
 }
 
 #endif
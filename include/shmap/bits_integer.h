@@ -122,6 +122,12 @@ struct BitField {
         return (full_value & ~mask) | shifted_value;
     }
 
+    // Largest value the field can hold
+    template<typename T>
+    static constexpr T MaxValue() {
+        return CreateMask<T>() >> start_bit;
+    }
+
 private:
     template<typename T>
     static constexpr T CreateMask() {
@@ -6,8 +6,10 @@
 #define SHMAP_FIXED_STRING_H
 
 #include <string_view>
+#include <charconv>
 #include <cstring>
 #include <cstdarg>
+#include <cstdint>
 #include <string>
 #include <array>
 #include <ostream>
@@ -17,168 +19,323 @@
 
 namespace shmap {
 
+namespace detail {
+    // Smallest unsigned type able to hold a length in [0, N]
+    template<std::size_t N>
+    using FixedStringLength = std::conditional_t<(N <= UINT8_MAX), uint8_t,
+                              std::conditional_t<(N <= UINT16_MAX), uint16_t, uint32_t>>;
+
+    template<typename T>
+    struct IsFixedString : std::false_type {};
+}
+
+template<std::size_t N>
+struct FixedString;
+
+namespace detail {
+    template<std::size_t N>
+    struct IsFixedString<FixedString<N>> : std::true_type {};
+}
+
+template<std::size_t N = 128>
 struct FixedString {
+    static_assert(N > 0, "FixedString capacity must be > 0");
+    static_assert(N <= UINT32_MAX, "FixedString capacity is too large");
+
     static FixedString FromString(const std::string& src) {
         FixedString fs;
-        fs.Store(src);
+        fs.Store(src.data(), src.size());
         return fs;
     }
 
     static FixedString FromFormat(const char* fmt, ...) {
         FixedString fs;
-        std::memset(fs.chars_.data(), 0, FIXED_STRING_LEN_MAX);
-
         if (!fmt) {
-            fs.chars_[0] = '\0';
             return fs;
         }
 
-        va_list args;
+        va_list args, retry;
         va_start(args, fmt);
-        int n = std::vsnprintf(fs.chars_.data(), FIXED_STRING_LEN_MAX, fmt, args);
+        va_copy(retry, args);
+        int n = std::vsnprintf(fs.chars_.data(), N, fmt, args);
         va_end(args);
 
-        if (n < 0) {
-            // Format failed, clean fs
-            fs.chars_[0] = '\0';
-        } else if (static_cast<std::size_t>(n) >= FIXED_STRING_LEN_MAX) {
-            // The output is truncated. Ensure that the tail is still '\0'
-            fs.chars_[FIXED_STRING_LEN_MAX - 1] = '\0';
+        // vsnprintf spends one byte on the '\0', format again to keep all N chars as Store does
+        if (n >= static_cast<int>(N)) {
+            std::string full(static_cast<std::size_t>(n), '\0');
+            std::vsnprintf(full.data(), full.size() + 1, fmt, retry);
+            std::memcpy(fs.chars_.data(), full.data(), N);
+        }
+        va_end(retry);
+
+        // Format failed keeps fs empty, truncated output keeps the first N chars
+        if (n > 0) {
+            fs.len_ = static_cast<Length>(std::min(static_cast<std::size_t>(n), N));
+        }
+        return fs;
+    }
+
+    // Type-safe formatting without vsnprintf: each "{}" in fmt is replaced by the next
+    // argument, "{{" and "}}" are literal braces. Integers and floating points are written
+    // by std::to_chars, strings and chars are copied. A count mismatch shows in the output:
+    // a placeholder without argument is written "{?}" and each extra argument is appended
+    // as "{+arg}". The output is truncated to N chars.
+    template<typename... Args>
+    static FixedString Format(std::string_view fmt, const Args&... args) {
+        FixedString fs;
+        std::size_t pos = 0;
+        ((fs.AppendLiteral(fmt, pos) ? fs.AppendOne(args) : fs.AppendExtra(args)), ...);
+        while (fs.AppendLiteral(fmt, pos)) {
+            fs.AppendChars("{?}", 3);
         }
         return fs;
     }
 
+    static constexpr std::size_t capacity() noexcept {
+        return N;
+    }
+
     FixedString() = default;
 
     FixedString(const std::string& str) {
-        Store(str);
+        Store(str.data(), str.size());
     }
 
     FixedString(const char* cstr) {
-        Store(std::string(cstr));
+        Store(cstr, std::strlen(cstr));
+    }
+
+    FixedString(std::string_view sv) {
+        Store(sv.data(), sv.size());
+    }
+
+    // The size() chars of the string, NOT terminated by a '\0': use ToString() for C APIs
+    const char* data() const noexcept {
+        return chars_.data();
+    }
+
+    std::size_t size() const noexcept {
+        return len_;
+    }
+
+    bool empty() const noexcept {
+        return len_ == 0;
+    }
+
+    std::string_view View() const noexcept {
+        return std::string_view(chars_.data(), len_);
     }
 
     std::string ToString() const {
-        const char* begin = chars_.data();
-        const char* end = static_cast<const char*>(std::memchr(begin, '\0', FIXED_STRING_LEN_MAX));
-        if (end) {
-            return std::string(begin, end);
-        } else {
-            // No '\0' found, take the entire buffer
-            return std::string(begin, begin + FIXED_STRING_LEN_MAX);
-        }
+        return std::string(chars_.data(), len_);
     }
 
     FixedString& operator= (const std::string& src) {
-        Store(src);
+        Store(src.data(), src.size());
         return *this;
     }
 
     FixedString& operator= (const char* cstr) {
-        Store(std::string(cstr));
+        Store(cstr, std::strlen(cstr));
+        return *this;
+    }
+
+    FixedString& operator= (std::string_view sv) {
+        Store(sv.data(), sv.size());
+        return *this;
+    }
+
+    // Append the arguments formatted as in Format, truncating at N chars
+    template<typename... Args>
+    FixedString& Append(const Args&... args) {
+        (AppendOne(args), ...);
         return *this;
     }
 
 private:
-    void Store(const std::string& src) {
-        std::size_t copy_len = std::min(src.size(), FIXED_STRING_LEN_MAX);
-        std::memcpy(chars_.data(), src.data(), copy_len);
-        if (copy_len < FIXED_STRING_LEN_MAX) {
-            std::memset(chars_.data() + copy_len, 0, FIXED_STRING_LEN_MAX - copy_len);
+    using Length = detail::FixedStringLength<N>;
+
+    // Only the used bytes are written, bytes beyond len_ are never read
+    void Store(const char* src, std::size_t len) {
+        std::size_t copy_len = std::min(len, N);
+        std::memcpy(chars_.data(), src, copy_len);
+        len_ = static_cast<Length>(copy_len);
+    }
+
+    void AppendChars(const char* src, std::size_t len) {
+        std::size_t copy_len = std::min(len, N - len_);
+        std::memcpy(chars_.data() + len_, src, copy_len);
+        len_ = static_cast<Length>(len_ + copy_len);
+    }
+
+    template<typename T>
+    void AppendNumber(T v) {
+        auto r = std::to_chars(chars_.data() + len_, chars_.data() + N, v);
+        if (r.ec == std::errc()) {
+            len_ = static_cast<Length>(r.ptr - chars_.data());
+            return;
         }
+        // Not enough room left, keep the leading digits
+        char tmp[64];
+        r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        AppendChars(tmp, r.ptr - tmp);
     }
 
-private:
-    static constexpr std::size_t FIXED_STRING_LEN_MAX{128};
-    std::array<char, FIXED_STRING_LEN_MAX> chars_;
+    template<typename T>
+    void AppendOne(const T& v) {
+        if constexpr (std::is_same_v<T, bool>) {
+            v ? AppendChars("true", 4) : AppendChars("false", 5);
+        } else if constexpr (std::is_same_v<T, char>) {
+            AppendChars(&v, 1);
+        } else if constexpr (std::is_integral_v<T> || std::is_floating_point_v<T>) {
+            AppendNumber(v);
+        } else if constexpr (detail::IsFixedString<T>::value) {
+            AppendChars(v.data(), v.size());
+        } else {
+            static_assert(std::is_convertible_v<const T&, std::string_view>, "Unsupported format argument");
+            std::string_view sv(v);
+            AppendChars(sv.data(), sv.size());
+        }
+    }
+
+    // Copy literal text of fmt from pos up to the next "{}", return false at the end of fmt
+    template<typename T>
+    void AppendExtra(const T& v) {
+        AppendChars("{+", 2);
+        AppendOne(v);
+        AppendChars("}", 1);
+    }
+
+    bool AppendLiteral(std::string_view fmt, std::size_t& pos) {
+        while (pos < fmt.size()) {
+            std::size_t next = fmt.find_first_of("{}", pos);
+            if (next == std::string_view::npos) {
+                AppendChars(fmt.data() + pos, fmt.size() - pos);
+                pos = fmt.size();
+                return false;
+            }
+            AppendChars(fmt.data() + pos, next - pos);
+            if (fmt[next] == '{' && next + 1 < fmt.size() && fmt[next + 1] == '}') {
+                pos = next + 2;
+                return true;
+            }
+            // "{{", "}}" or a stray brace
+            bool escaped = next + 1 < fmt.size() && fmt[next + 1] == fmt[next];
+            AppendChars(fmt.data() + next, 1);
+            pos = next + (escaped ? 2 : 1);
+        }
+        return false;
+    }
+
+    static int Compare(const FixedString& a, const FixedString& b) {
+        int r = std::memcmp(a.chars_.data(), b.chars_.data(), std::min(a.len_, b.len_));
+        if (r != 0) return r;
+        return a.len_ < b.len_ ? -1 : (a.len_ > b.len_ ? 1 : 0);
+    }
+
+    // Anything viewable as std::string_view except FixedString itself
+    template<typename S>
+    using EnableIfStringLike = std::enable_if_t<
+        std::is_convertible_v<const S&, std::string_view> && !std::is_same_v<S, FixedString>>;
 
 private:
-    friend bool operator==(const FixedString& a, const FixedString& b);
-    friend bool operator<(const FixedString& a, const FixedString& b);
-    friend struct std::hash<FixedString>;
-    friend std::ostream& operator<<(std::ostream& os, const FixedString& fs);
-};
+    // Left uninitialized, only the first len_ chars are ever read
+    std::array<char, N> chars_;
+    Length len_{0};
 
-static_assert(std::is_trivially_copyable<FixedString>::value, "FixedString should be trivially copyable!");
-static_assert(std::is_standard_layout<FixedString>::value, "FixedString should be standard layout!");
+private:
+    friend bool operator==(const FixedString& a, const FixedString& b) {
+        return a.len_ == b.len_ && std::memcmp(a.chars_.data(), b.chars_.data(), a.len_) == 0;
+    }
+    friend bool operator!=(const FixedString& a, const FixedString& b) {
+        return !(a == b);
+    }
+    friend bool operator<(const FixedString& a, const FixedString& b) {
+        return Compare(a, b) < 0;
+    }
+    friend bool operator>(const FixedString& a, const FixedString& b) {
+        return b < a;
+    }
+    friend bool operator<=(const FixedString& a, const FixedString& b) {
+        return !(b < a);
+    }
+    friend bool operator>=(const FixedString& a, const FixedString& b) {
+        return !(a < b);
+    }
 
-inline bool operator==(const FixedString& a, const FixedString& b) {
-    return std::memcmp(a.chars_.data(), b.chars_.data(), FixedString::FIXED_STRING_LEN_MAX) == 0;
-}
-inline bool operator!=(const FixedString& a, const FixedString& b) { 
-    return !(a == b); 
-}
-inline bool operator<(const FixedString& a, const FixedString& b) {
-    return std::memcmp(a.chars_.data(), b.chars_.data(), FixedString::FIXED_STRING_LEN_MAX) < 0;
-}
-inline bool operator>(const FixedString& a, const FixedString& b) { 
-    return b < a; 
-}
-inline bool operator<=(const FixedString& a, const FixedString& b) { 
-    return !(b < a); 
-}
-inline bool operator>=(const FixedString& a, const FixedString& b) { 
-    return !(a < b); 
-}
+    // Mixed comparisons with std::string, std::string_view and C strings, without allocation
+    template<typename S, typename = EnableIfStringLike<S>>
+    friend bool operator==(const FixedString& a, const S& b) {
+        return a.View() == std::string_view(b);
+    }
+    template<typename S, typename = EnableIfStringLike<S>>
+    friend bool operator==(const S& a, const FixedString& b) {
+        return std::string_view(a) == b.View();
+    }
+    template<typename S, typename = EnableIfStringLike<S>>
+    friend bool operator!=(const FixedString& a, const S& b) {
+        return !(a == b);
+    }
+    template<typename S, typename = EnableIfStringLike<S>>
+    friend bool operator!=(const S& a, const FixedString& b) {
+        return !(a == b);
+    }
+    template<typename S, typename = EnableIfStringLike<S>>
+    friend bool operator<(const FixedString& a, const S& b) {
+        return a.View() < std::string_view(b);
+    }
+    template<typename S, typename = EnableIfStringLike<S>>
+    friend bool operator<(const S& a, const FixedString& b) {
+        return std::string_view(a) < b.View();
+    }
+    template<typename S, typename = EnableIfStringLike<S>>
+    friend bool operator<=(const FixedString& a, const S& b) {
+        return !(b < a);
+    }
+    template<typename S, typename = EnableIfStringLike<S>>
+    friend bool operator<=(const S& a, const FixedString& b) {
+        return !(b < a);
+    }
+    template<typename S, typename = EnableIfStringLike<S>>
+    friend bool operator>(const FixedString& a, const S& b) {
+        return b < a;
+    }
+    template<typename S, typename = EnableIfStringLike<S>>
+    friend bool operator>(const S& a, const FixedString& b) {
+        return b < a;
+    }
+    template<typename S, typename = EnableIfStringLike<S>>
+    friend bool operator>=(const FixedString& a, const S& b) {
+        return !(a < b);
+    }
+    template<typename S, typename = EnableIfStringLike<S>>
+    friend bool operator>=(const S& a, const FixedString& b) {
+        return !(a < b);
+    }
 
-inline bool operator==(const FixedString& a, const std::string& b) {
-    return a.ToString() == b;
-}
-inline bool operator==(const std::string& a, const FixedString& b) {
-    return a == b.ToString();
-}
-inline bool operator!=(const FixedString& a, const std::string& b) {
-    return !(a == b);
-}
-inline bool operator!=(const std::string& a, const FixedString& b) {
-    return !(a == b);
-}
-inline bool operator<(const FixedString& a, const std::string& b) {
-    return a.ToString() < b;
-}
-inline bool operator<(const std::string& a, const FixedString& b) {
-    return a < b.ToString();
-}
-inline bool operator<=(const FixedString& a, const std::string& b) {
-    return a.ToString() <= b;
-}
-inline bool operator<=(const std::string& a, const FixedString& b) {
-    return a <= b.ToString();
-}
-inline bool operator>(const FixedString& a, const std::string& b) {
-    return a.ToString() > b;
-}
-inline bool operator>(const std::string& a, const FixedString& b) {
-    return a > b.ToString();
-}
-inline bool operator>=(const FixedString& a, const std::string& b) {
-    return a.ToString() >= b;
-}
-inline bool operator>=(const std::string& a, const FixedString& b) {
-    return a >= b.ToString();
-}
+    friend std::ostream& operator<<(std::ostream& os, const FixedString& fs) {
+        return os.write(fs.chars_.data(), fs.len_);
+    }
+};
 
-inline std::ostream& operator<<(std::ostream& os, const FixedString& fs) {
-    os << fs.ToString();
-    return os;
-}
+static_assert(std::is_trivially_copyable<FixedString<>>::value, "FixedString should be trivially copyable!");
+static_assert(std::is_standard_layout<FixedString<>>::value, "FixedString should be standard layout!");
+static_assert(sizeof(FixedString<16>) == 17, "FixedString<16> should use a one byte length");
 
 }
 
 namespace std {
-    template<>
-    struct hash<shmap::FixedString> {
-        std::size_t operator()(const shmap::FixedString& fs) const noexcept {
-            // Hash the full buffer (including trailing zeros) for consistency with operator==
-            return std::hash<std::string_view>()(
-                std::string_view(fs.chars_.data(), shmap::FixedString::FIXED_STRING_LEN_MAX)
-            );
+    template<std::size_t N>
+    struct hash<shmap::FixedString<N>> {
+        std::size_t operator()(const shmap::FixedString<N>& fs) const noexcept {
+            // Hash only the used bytes, consistent with operator==
+            return std::hash<std::string_view>()(fs.View());
         }
     };
 
-    template<>
-    struct equal_to<shmap::FixedString> {
-        bool operator()(const shmap::FixedString& lhs, const shmap::FixedString& rhs) const noexcept {
+    template<std::size_t N>
+    struct equal_to<shmap::FixedString<N>> {
+        bool operator()(const shmap::FixedString<N>& lhs, const shmap::FixedString<N>& rhs) const noexcept {
             return lhs == rhs;
         }
     };
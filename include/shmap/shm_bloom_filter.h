@@ -0,0 +1,145 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef SHMAP_SHM_BLOOM_FILTER_H
+#define SHMAP_SHM_BLOOM_FILTER_H
+
+#include "shmap/shmap.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace shmap {
+
+/* -------------------------------------------------------------------------- */
+/*          NoFilter – default, every key may be present                      */
+/* -------------------------------------------------------------------------- */
+struct NoFilter {
+    static constexpr bool ENABLED = false;
+
+    bool MayContain(uint64_t) const noexcept { return true; }
+    bool Add(uint64_t) noexcept { return true; }
+};
+
+// Blocks for `keys` keys at `bitsPerKey`: 12 bits give about 1% false positives
+constexpr std::size_t BloomBlocksFor(std::size_t keys, std::size_t bitsPerKey = 12) noexcept {
+    const std::size_t blocks = (keys * bitsPerKey + CACHE_LINE_SIZE * 8 - 1) / (CACHE_LINE_SIZE * 8);
+    return blocks ? blocks : 1;
+}
+
+/* -------------------------------------------------------------------------- */
+/*          ShmBloomFilter – blocked Bloom filter inside the shm segment      */
+/* -------------------------------------------------------------------------- */
+// A key maps to one cache-line block of eight 64-bit words and sets one bit in
+// each word, so a lookup reads one line and an insert dirties at most that one.
+// The eight bit positions come from multiplying the hash by eight odd salts, a
+// loop the compiler vectorizes. Bits are only ever set: there is no removal.
+template<std::size_t BLOCKS>
+struct ShmBloomFilter {
+    static_assert(BLOCKS > 0 && BLOCKS <= UINT32_MAX, "BLOCKS must be in [1, 2^32)");
+
+    static constexpr bool ENABLED = true;
+    static constexpr uint32_t WORDS = CACHE_LINE_SIZE / sizeof(uint64_t);
+    static_assert(WORDS == 8, "one bit per word needs eight salts");
+
+    ShmBloomFilter() = default; // Only used for placement-new
+
+    static constexpr std::size_t Bits() noexcept {
+        return BLOCKS * WORDS * 64;
+    }
+
+    // Sets the bits of `hash`, true if one of them was clear: the key is surely new.
+    // Two processes adding the same key at once may both get true.
+    bool Add(uint64_t hash) noexcept {
+        const uint64_t h = Mix(hash);
+        Block& block = blocks_[BlockOf(h)];
+        std::array<uint64_t, WORDS> masks;
+        MasksOf(h, masks);
+
+        bool added = false;
+        for (uint32_t w = 0; w < WORDS; ++w) {
+            // Leave the line clean when the bit is already there. The set is a release,
+            // paired with the acquire loads in MayContain: whoever sees the bits also sees
+            // what the caller wrote before Add
+            if ((block.words[w].load(std::memory_order_relaxed) & masks[w]) == 0) {
+                added |= (block.words[w].fetch_or(masks[w], std::memory_order_release) & masks[w]) == 0;
+            }
+        }
+        return added;
+    }
+
+    // False only if `hash` was never added
+    bool MayContain(uint64_t hash) const noexcept {
+        const uint64_t h = Mix(hash);
+        const Block& block = blocks_[BlockOf(h)];
+        std::array<uint64_t, WORDS> masks;
+        MasksOf(h, masks);
+
+        uint64_t missing = 0;
+        for (uint32_t w = 0; w < WORDS; ++w) {
+            missing |= masks[w] & ~block.words[w].load(std::memory_order_acquire);
+        }
+        return missing == 0;
+    }
+
+    // Share of bits set; false positives are about FillRatio()^8
+    double FillRatio() const noexcept {
+        std::size_t set = 0;
+        for (const Block& block : blocks_) {
+            for (const auto& word : block.words) {
+                set += static_cast<std::size_t>(__builtin_popcountll(word.load(std::memory_order_relaxed)));
+            }
+        }
+        return static_cast<double>(set) / static_cast<double>(Bits());
+    }
+
+    // Only used in none parallel scenarios
+    void Clear() noexcept {
+        for (Block& block : blocks_) {
+            for (auto& word : block.words) {
+                word.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Block {
+        std::atomic<uint64_t> words[WORDS];
+    };
+
+    // Table hashes are often the identity, spread them over all 64 bits first
+    static uint64_t Mix(uint64_t h) noexcept {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // High half picks the block, low half the bits
+    static std::size_t BlockOf(uint64_t h) noexcept {
+        return static_cast<std::size_t>(((h >> 32) * BLOCKS) >> 32);
+    }
+
+    static void MasksOf(uint64_t h, std::array<uint64_t, WORDS>& masks) noexcept {
+        static constexpr uint32_t SALT[WORDS] = {
+            0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+            0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+        };
+        const uint32_t low = static_cast<uint32_t>(h);
+        for (uint32_t w = 0; w < WORDS; ++w) {
+            masks[w] = uint64_t{1} << ((low * SALT[w]) >> 26);
+        }
+    }
+
+private:
+    std::array<Block, BLOCKS> blocks_{};
+};
+
+}
+
+#endif
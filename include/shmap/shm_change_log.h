@@ -0,0 +1,170 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef SHMAP_SHM_CHANGE_LOG_H
+#define SHMAP_SHM_CHANGE_LOG_H
+
+#include "shmap/shmap.h"
+#include "shmap/tagged_index.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace shmap {
+
+enum class ChangeOp : uint8_t {
+    Insert = 1,
+    Update = 2,
+};
+
+/* -------------------------------------------------------------------------- */
+/*          NoChangeLog – default, compiles to nothing                        */
+/* -------------------------------------------------------------------------- */
+struct NoChangeLog {
+    static constexpr bool ENABLED = false;
+
+    template<typename KEY>
+    void Append(ChangeOp, std::size_t, const KEY&) noexcept {}
+};
+
+/* -------------------------------------------------------------------------- */
+/*          ShmChangeLog – lossy broadcast log of table mutations             */
+/* -------------------------------------------------------------------------- */
+// Writers (every process mutating the table) claim a version with one fetch_add
+// and overwrite the oldest record, so logging never blocks the table. Readers
+// keep their own cursor; one that falls more than CAPACITY records behind
+// skips ahead, counts the gap in Lost() and should resync with a full Travel.
+// Records carry the key, not the value: followers Visit the key for its state.
+// Slots are claimed through a SlotSequence, so two writers a lap apart never
+// write the same record at once. A record its writer gave up on, or never
+// published because it died, is skipped by readers and counted in Lost().
+template<typename KEY, std::size_t CAPACITY = 4096>
+struct ShmChangeLog {
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be power-of-two");
+    static_assert(std::is_trivially_copyable<KEY>::value, "KEY must be trivially copyable");
+
+    static constexpr bool ENABLED = true;
+    // Spins waiting for a writer a lap behind before giving the record up
+    static constexpr uint32_t CLAIM_SPINS = 1024;
+    // Readers give up on a record still unpublished this many records later
+    static constexpr uint64_t STALL_RECORDS = CAPACITY / 2;
+
+    struct Record {
+        uint64_t version;  // 1, 2, 3 ... in log order
+        uint32_t idx;      // bucket of the key
+        ChangeOp op;
+        KEY      key;
+    };
+
+    ShmChangeLog() = default; // Only used for placement-new
+
+    // Called by the table while it still holds the bucket, so the records of one
+    // key are in mutation order
+    void Append(ChangeOp op, std::size_t idx, const KEY& key) noexcept {
+        const uint64_t pos = head_.fetch_add(1, std::memory_order_relaxed);
+        Slot& s = slots_[pos & (CAPACITY - 1)];
+        if (!s.seq.Claim(pos, CLAIM_SPINS)) {
+            // Tell readers not to wait for this record
+            s.skipped.store(pos + 1, std::memory_order_release);
+            return;
+        }
+        Record r;
+        r.version = pos + 1;
+        r.idx     = static_cast<uint32_t>(idx);
+        r.op      = op;
+        r.key     = key;
+        s.record.Store(r);
+        s.seq.Publish(pos);
+    }
+
+    // Version of the latest record appended, 0 if none
+    uint64_t Version() const noexcept {
+        return head_.load(std::memory_order_acquire);
+    }
+
+    struct Reader {
+        const ShmChangeLog* log{nullptr};
+        uint64_t cursor{0};  // next position to read
+        uint64_t lost{0};
+
+        // Hands at most `max` records to f(const Record&) in order, returns how many.
+        // Stops early at a record whose writer has not finished it yet, unless the
+        // writer gave it up or STALL_RECORDS more were appended since: then it is lost.
+        template<typename F>
+        std::size_t Poll(F&& f, std::size_t max = SIZE_MAX) noexcept {
+            std::size_t n = 0;
+            while (n < max) {
+                const uint64_t head = log->head_.load(std::memory_order_acquire);
+                if (cursor >= head) {
+                    break;
+                }
+                if (head - cursor > CAPACITY) {
+                    lost  += head - CAPACITY - cursor;
+                    cursor = head - CAPACITY;
+                }
+                const Slot& s = log->slots_[cursor & (CAPACITY - 1)];
+                const uint64_t seq = s.seq.Load();
+                if (seq != SlotSequence::Published(cursor)) {
+                    if (seq > SlotSequence::Published(cursor)) {
+                        continue; // overwritten while we looked, the head moved on
+                    }
+                    if (s.skipped.load(std::memory_order_acquire) == cursor + 1 || head - cursor > STALL_RECORDS) {
+                        ++lost;
+                        ++cursor;
+                        continue;
+                    }
+                    break;
+                }
+                Record r;
+                s.record.Load(r);
+                if (s.seq.Load(std::memory_order_relaxed) != seq) {
+                    continue;
+                }
+                f(r);
+                ++cursor;
+                ++n;
+            }
+            return n;
+        }
+
+        // Records skipped because this reader fell behind or their writer never published them
+        uint64_t Lost() const noexcept {
+            return lost;
+        }
+
+        // Records appended and not read yet, lost ones included
+        uint64_t Pending() const noexcept {
+            const uint64_t head = log->head_.load(std::memory_order_acquire);
+            return head > cursor ? head - cursor : 0;
+        }
+    };
+
+    // From the next record appended
+    Reader Subscribe() const noexcept {
+        return Reader{this, Version(), 0};
+    }
+
+    // From the record with `version` on; records already overwritten count as lost
+    Reader SubscribeFrom(uint64_t version) const noexcept {
+        return Reader{this, version ? version - 1 : 0, 0};
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        SlotSequence seq;
+        std::atomic<uint64_t> skipped{0}; // position + 1 of the last record given up here
+        SlotPayload<Record> record;
+    };
+
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head_{0};
+    std::array<Slot, CAPACITY> slots_{};
+};
+
+}
+
+#endif
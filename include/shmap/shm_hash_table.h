@@ -7,11 +7,18 @@
 
 #include "shmap/shmap.h"
 #include "shmap/backoff.h"
+#include "shmap/shm_bloom_filter.h"
+#include "shmap/shm_change_log.h"
+#include "shmap/shm_metrics.h"
+#include "shmap/shm_trace.h"
 #include "shmap/status.h"
 
+#include <algorithm>
+#include <array>
 #include <type_traits>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <utility>
 #include <atomic>
 
@@ -32,6 +39,68 @@ struct alignas(CACHE_LINE_SIZE) ShmBucket {
     VALUE value;
 };
 
+/* -------------------------------------------------------------------------- */
+/*                     ShmBucketVersions – per-bucket write stamps            */
+/* -------------------------------------------------------------------------- */
+// Disabled: no storage, stamping compiles to nothing
+template<std::size_t CAPACITY, bool ENABLE>
+struct ShmBucketVersions {
+    void Stamp(std::size_t) noexcept {}
+    void Move(std::size_t, std::size_t) noexcept {}
+};
+
+// Every write takes the next global version and stamps it on its bucket. Each
+// region of REGION_BUCKETS buckets keeps the highest stamp in it, so a pass over
+// the changes skips unchanged regions. A writer also counts itself in its region
+// while it stamps, so a region being stamped is never skipped.
+template<std::size_t CAPACITY>
+struct ShmBucketVersions<CAPACITY, true> {
+    static constexpr std::size_t REGION_BUCKETS = 64;
+    static constexpr std::size_t REGIONS = (CAPACITY + REGION_BUCKETS - 1) / REGION_BUCKETS;
+
+    struct alignas(CACHE_LINE_SIZE) Region {
+        std::atomic<uint64_t> version{0}; // highest stamp in the region
+        std::atomic<uint32_t> writers{0}; // stamping right now
+    };
+
+    // Called with the bucket held
+    void Stamp(std::size_t idx) noexcept {
+        Region& region = regions_[idx / REGION_BUCKETS];
+        region.writers.fetch_add(1);
+        const uint64_t v = version_.fetch_add(1) + 1;
+        stamps_[idx].store(v);
+        uint64_t cur = region.version.load();
+        while (cur < v && !region.version.compare_exchange_weak(cur, v)) {}
+        region.writers.fetch_sub(1);
+    }
+
+    uint64_t Version() const noexcept {
+        return version_.load();
+    }
+
+    // The stamp follows a bucket moved from `from` to `to`, only used in none parallel scenarios
+    void Move(std::size_t from, std::size_t to) noexcept {
+        const uint64_t v = stamps_[from].exchange(0);
+        stamps_[to].store(v);
+        Region& region = regions_[to / REGION_BUCKETS];
+        region.version.store(std::max(region.version.load(), v));
+    }
+
+    uint64_t StampOf(std::size_t idx) const noexcept {
+        return stamps_[idx].load();
+    }
+
+    // May hold a bucket stamped after `since`
+    bool RegionChanged(std::size_t r, uint64_t since) const noexcept {
+        return regions_[r].writers.load() != 0 || regions_[r].version.load() > since;
+    }
+
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> version_{0};
+    std::array<Region, REGIONS> regions_{};
+    std::array<std::atomic<uint64_t>, CAPACITY> stamps_{};
+};
+
 /* -------------------------------------------------------------------------- */
 /*                     AccessMode – how to access the table                   */
 /* -------------------------------------------------------------------------- */
@@ -40,13 +109,27 @@ enum class AccessMode : uint8_t {
     CreateIfMiss,
 };
 
+/* -------------------------------------------------------------------------- */
+/*                     TableOptions – optional features of a table            */
+/* -------------------------------------------------------------------------- */
+// All off by default. Derive and redeclare only the ones to turn on:
+//   struct Counted : TableOptions { using Metrics = ShmTableMetrics; };
+struct TableOptions {
+    using Backoff   = shmap::Backoff;
+    using Metrics   = NoMetrics;   // ShmTableMetrics to count in shm
+    using ChangeLog = NoChangeLog; // ShmChangeLog<KEY> to publish mutations
+    using Filter    = NoFilter;    // ShmBloomFilter<N> to answer misses early
+    static constexpr bool VERSION_ENABLE = false; // stamp buckets for TravelChangedSince
+};
+
 /* -------------------------------------------------------------------------- */
 /*                     ShmHashTable  (lock-free closed hashing table)         */
 /* -------------------------------------------------------------------------- */
 template<typename KEY, typename VALUE, std::size_t CAPACITY,
     typename HASH  = std::hash<KEY>,
     typename EQUAL = std::equal_to<KEY>,
-    bool ROLLBACK_ENABLE = false
+    bool ROLLBACK_ENABLE = false,
+    typename OPTIONS = TableOptions
 >
 struct ShmHashTable {
     static_assert(CAPACITY > 0, "CAPACITY must be > 0");
@@ -59,18 +142,298 @@ struct ShmHashTable {
     using Bucket = ShmBucket<KEY,VALUE>;
     static_assert(sizeof(Bucket) % CACHE_LINE_SIZE == 0,  "Bucket must be cache-line multiple");
 
+    using KeyType   = KEY;
+    using ValueType = VALUE;
+    using Hasher    = HASH;
+    using Options   = OPTIONS;
+
+private:
+    using BACKOFF    = typename OPTIONS::Backoff;
+    using METRICS    = typename OPTIONS::Metrics;
+    using CHANGE_LOG = typename OPTIONS::ChangeLog;
+    using FILTER     = typename OPTIONS::Filter;
+    static constexpr bool VERSION_ENABLE = OPTIONS::VERSION_ENABLE;
+
+public:
     ShmHashTable() = default; // Only used for placement-new
 
+    static constexpr std::size_t Capacity() noexcept {
+        return CAPACITY;
+    }
+
+    // Byte offset of bucket 0 in the table, for tools reading a raw mapping
+    static constexpr std::size_t BucketsOffset() noexcept {
+        return offsetof(ShmHashTable, buckets_);
+    }
+
     // Visit by key, apply visitor to the bucket, using in sync scenarios
     template<typename Visitor /* Status (idx, Value&, bool isNew) */>
     Status Visit(const KEY& key, AccessMode mode, Visitor&& visitor,
         std::chrono::nanoseconds timeout = std::chrono::seconds(5)) noexcept {
-            
-        Backoff backoff(timeout);
-        const std::size_t idx = hasher_(key) % CAPACITY;
+
+        BACKOFF backoff(timeout);
+        TraceSpan trace(TraceOp::TableVisit);
+        Status status = DoVisit(key, mode, std::forward<Visitor>(visitor), backoff, trace);
+        trace.End(status);
+        CountVisit(status, backoff);
+        return status;
+    }
+
+    // Visit several keys as one atomic update: their buckets are locked in bucket
+    // index order, so concurrent VisitMulti calls cannot deadlock, and the visitor
+    // sees all values at once. Repeated keys share one bucket. On failure new
+    // buckets are dropped and, with ROLLBACK_ENABLE, old values are restored.
+    // Using in sync scenarios; the visitor must not visit this table again.
+    template<std::size_t N, typename Visitor /* Status (std::array<VALUE*, N>&, const std::array<bool, N>& isNew) */>
+    Status VisitMulti(const KEY (&keys)[N], AccessMode mode, Visitor&& visitor,
+        std::chrono::nanoseconds timeout = std::chrono::seconds(5)) noexcept {
+        static_assert(N > 0, "VisitMulti needs at least one key");
+
+        BACKOFF backoff(timeout);
+        TraceSpan trace(TraceOp::TableVisitMulti);
+        Status status = DoVisitMulti(keys, mode, std::forward<Visitor>(visitor), backoff, trace);
+        trace.End(status);
+        CountVisit(status, backoff);
+        return status;
+    }
+
+    // Travel all buckets, apply visitor to each bucket, using in sync scenarios
+    template<typename Visitor /* Status (idx, const Key&, Value&) */>
+    Status Travel(Visitor&& visitor,
+        std::chrono::nanoseconds timeout = std::chrono::seconds(5)) noexcept {
+
+        BACKOFF backoff(timeout);
+        TraceSpan trace(TraceOp::TableTravel);
+        Status status = DoTravel(std::forward<Visitor>(visitor), backoff, trace);
+        trace.End(status);
+        if constexpr (METRICS::ENABLED) {
+            metrics_.Add(TABLE_TRAVELS);
+            if (status == Status::TIMEOUT) {
+                metrics_.Add(TABLE_TIMEOUTS);
+            }
+            if (backoff.steps()) {
+                metrics_.Add(TABLE_BACKOFF_STEPS, backoff.steps());
+            }
+        }
+        return status;
+    }
+
+    // Visit every bucket written after version `since`, skipping regions with no
+    // such write: cost follows the churn, not the capacity. Take Version() before
+    // a pass and use it as `since` of the next one; a bucket written during the
+    // pass may be reported again then.
+    template<typename Visitor /* Status (idx, const Key&, const Value&, uint64_t version) */>
+    Status TravelChangedSince(uint64_t since, Visitor&& visitor,
+        std::chrono::nanoseconds timeout = std::chrono::seconds(5)) noexcept {
+        static_assert(VERSION_ENABLE, "TravelChangedSince needs Options::VERSION_ENABLE");
+
+        BACKOFF backoff(timeout);
+        TraceSpan trace(TraceOp::TableTravel);
+        Status status = DoTravelChangedSince(since, std::forward<Visitor>(visitor), backoff, trace);
+        trace.End(status);
+        if constexpr (METRICS::ENABLED) {
+            metrics_.Add(TABLE_TRAVELS);
+            if (status == Status::TIMEOUT) {
+                metrics_.Add(TABLE_TIMEOUTS);
+            }
+            if (backoff.steps()) {
+                metrics_.Add(TABLE_BACKOFF_STEPS, backoff.steps());
+            }
+        }
+        return status;
+    }
+
+    // Latest version stamped, 0 without VERSION_ENABLE
+    uint64_t Version() const noexcept {
+        if constexpr (VERSION_ENABLE) {
+            return versions_.Version();
+        } else {
+            return 0;
+        }
+    }
+
+    // Version of the last write to a bucket, 0 if never written since VERSION_ENABLE
+    uint64_t VersionOf(std::size_t bucketId) const noexcept {
+        if constexpr (VERSION_ENABLE) {
+            return bucketId < CAPACITY ? versions_.StampOf(bucketId) : 0;
+        } else {
+            return 0;
+        }
+    }
+
+    // Visit a specific bucket by ID, apply visitor to it
+    // Only used for accessing elements exclusive to oneself and no concurrent competition
+    template<typename Visitor /* Status (Bucket&) */>
+    Status VisitBucket(std::size_t bucketId, Visitor&& visitor) noexcept {
+        if (bucketId >= CAPACITY) {
+            return Status::INVALID_ARGUMENT;
+        }
+
+        Bucket& b = buckets_[bucketId];
+        if (b.state.load(std::memory_order_acquire) != Bucket::READY) {
+            return Status::NOT_FOUND;
+        }
+
+        VALUE oldVal{};
+        if constexpr (ROLLBACK_ENABLE || TRACK_CHANGES) {
+            oldVal = b.value;
+        }
+        Status status = ApplyVisitor(std::forward<Visitor>(visitor), b);
+        if constexpr (ROLLBACK_ENABLE) {
+            if (!status) {
+                b.value = oldVal;
+            }
+        }
+        ChangedIfDiffers(oldVal, bucketId, b, status);
+        return status;
+    }
+
+    // Const version of VisitBucket
+    template<typename Visitor /* Status (const Bucket&) */>
+    Status VisitBucket(std::size_t bucketId, Visitor&& visitor) const noexcept {
+        return const_cast<ShmHashTable*>(this)->VisitBucket(bucketId, std::forward<Visitor>(visitor));
+    }
+
+    // Travel all buckets, apply visitor to each bucket
+    // Only used in audit scenarios exclusive to oneself and no concurrent competition
+    template<typename Visitor /* Status (idx, Bucket&) */>
+    Status TravelBucket(Visitor&& visitor) noexcept {
+        for (std::size_t idx = 0; idx < CAPACITY; ++idx) {
+            Status status = ApplyVisitor(std::forward<Visitor>(visitor), idx, buckets_[idx]);
+            if (status != Status::SUCCESS) return status;
+        }
+        return Status::SUCCESS;
+    }
+
+    // Const version of TravelBucket
+    template<typename Visitor /* Status (idx, const Bucket&) */>
+    Status TravelBucket(Visitor&& visitor) const noexcept {
+        return const_cast<ShmHashTable*>(this)->TravelBucket(std::forward<Visitor>(visitor));
+    }
+
+    // Copies bytes [offset, offset + bytes) of the table, each bucket taken whole
+    // while nobody writes it and held only for its own memcpy. Buckets still being
+    // inserted come out empty. Used by ShmSnapshot to copy a live table; the copy
+    // needs RepairProbeChains before use.
+    Status CopyBytes(std::size_t offset, std::size_t bytes, void* dst,
+        std::chrono::nanoseconds timeout = std::chrono::seconds(5)) const noexcept {
+        const auto* self = reinterpret_cast<const uint8_t*>(this);
+        auto* out = static_cast<uint8_t*>(dst);
+        const std::size_t first = BucketsOffset();
+        const std::size_t last  = first + sizeof(buckets_);
+
+        while (bytes) {
+            std::size_t n = bytes;
+            if (offset < first || offset >= last) {
+                n = offset < first ? std::min(bytes, first - offset) : bytes;
+                std::memcpy(out, self + offset, n);
+            } else {
+                const std::size_t skip = (offset - first) % sizeof(Bucket);
+                n = std::min(bytes, sizeof(Bucket) - skip);
+                alignas(Bucket) uint8_t image[sizeof(Bucket)];
+                Status status = CopyBucket(buckets_[(offset - first) / sizeof(Bucket)], image, timeout);
+                if (!status) return status;
+                std::memcpy(out, image + skip, n);
+            }
+            offset += n;
+            out    += n;
+            bytes  -= n;
+        }
+        return Status::SUCCESS;
+    }
+
+    // Moves every key back within reach of its home bucket, only used in none parallel
+    // scenarios. CopyBytes takes buckets one at a time while inserts go on: a bucket
+    // copied EMPTY may be filled afterwards and push a colliding key past it, so the
+    // copy holds that key behind a hole. Each move brings a key closer to its home
+    // and never leaves another one further away, so the passes end.
+    void RepairProbeChains() noexcept {
+        for (bool moved = true; moved; ) {
+            moved = false;
+            for (std::size_t idx = 0; idx < CAPACITY; ++idx) {
+                Bucket& b = buckets_[idx];
+                if (b.state.load(std::memory_order_relaxed) != Bucket::READY) continue;
+
+                for (std::size_t pos = hasher_(b.key) % CAPACITY; pos != idx; pos = (pos + 1) % CAPACITY) {
+                    Bucket& hole = buckets_[pos];
+                    if (hole.state.load(std::memory_order_relaxed) == Bucket::EMPTY) {
+                        hole.key   = b.key;
+                        hole.value = b.value;
+                        hole.state.store(Bucket::READY, std::memory_order_relaxed);
+                        b.state.store(Bucket::EMPTY, std::memory_order_relaxed);
+                        versions_.Move(idx, pos);
+                        moved = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Counters kept in the table's own memory, NoMetrics unless enabled by Options::Metrics
+    const METRICS& Metrics() const noexcept {
+        return metrics_;
+    }
+
+    // Inserts and updates in mutation order, NoChangeLog unless enabled by Options::ChangeLog
+    const CHANGE_LOG& ChangeLog() const noexcept {
+        return changeLog_;
+    }
+
+    // Hashes of all inserted keys, NoFilter unless enabled by Options::Filter
+    const FILTER& Filter() const noexcept {
+        return filter_;
+    }
+
+private:
+    // Whether writes are logged or stamped, and old values kept to spot updates
+    static constexpr bool TRACK_CHANGES = CHANGE_LOG::ENABLED || VERSION_ENABLE;
+
+    // Called with the bucket held, so a key's records and stamps follow its writes
+    void Changed(ChangeOp op, std::size_t idx, const KEY& key) noexcept {
+        changeLog_.Append(op, idx, key);
+        versions_.Stamp(idx);
+    }
+
+    // Records an update when a successful visitor changed the value's bytes
+    void ChangedIfDiffers(const VALUE& before, std::size_t idx, const Bucket& b, Status status) noexcept {
+        if constexpr (TRACK_CHANGES) {
+            if (status && std::memcmp(&before, &b.value, sizeof(VALUE)) != 0) {
+                Changed(ChangeOp::Update, idx, b.key);
+            }
+        }
+    }
+
+    void CountVisit(Status status, const BACKOFF& backoff) noexcept {
+        if constexpr (METRICS::ENABLED) {
+            metrics_.Add(TABLE_VISITS);
+            if (status == Status::NOT_FOUND) {
+                metrics_.Add(TABLE_MISSES);
+            } else if (status == Status::TIMEOUT) {
+                metrics_.Add(TABLE_TIMEOUTS);
+            } else if (!status) {
+                metrics_.Add(TABLE_FAILURES);
+            }
+            if (backoff.steps()) {
+                metrics_.Add(TABLE_BACKOFF_STEPS, backoff.steps());
+            }
+        }
+    }
+
+    template<typename Visitor>
+    Status DoVisit(const KEY& key, AccessMode mode, Visitor&& visitor, BACKOFF& backoff, TraceSpan& trace) noexcept {
+        const std::size_t hash = hasher_(key);
+        if constexpr (FILTER::ENABLED) {
+            if (mode == AccessMode::AccessExist && !filter_.MayContain(hash)) {
+                metrics_.Add(TABLE_FILTERED);
+                return Status::NOT_FOUND;
+            }
+        }
+        const std::size_t idx = hash % CAPACITY;
 
         for (std::size_t probe = 0; probe < CAPACITY; ++probe) {
             Bucket& b = buckets_[(idx + probe) % CAPACITY];
+            trace.Probe((idx + probe) % CAPACITY);
 
             while (true) {
                 auto state = b.state.load(std::memory_order_acquire);
@@ -82,7 +445,8 @@ struct ShmHashTable {
                     auto expectState = Bucket::READY;
                     if (!b.state.compare_exchange_strong(expectState, Bucket::ACCESSING,
                             std::memory_order_acq_rel, std::memory_order_acquire)) {
-                        if (!backoff.next()) {
+                        trace.CasFailure();
+                        if (!trace.Wait(backoff)) {
                             SHMAP_DEBUG_LOG("ShmHashTable[%zd] backoff timeout!", idx);
                             return Status::TIMEOUT;
                         }
@@ -94,12 +458,15 @@ struct ShmHashTable {
                     // Maybe save old value
                     VALUE old{};
                     VALUE* oldPtr = nullptr;
-                    if constexpr (ROLLBACK_ENABLE) {
+                    if constexpr (ROLLBACK_ENABLE || TRACK_CHANGES) {
                         old = b.value;
+                    }
+                    if constexpr (ROLLBACK_ENABLE) {
                         oldPtr = &old;
                     }
 
                     Status status = ApplyVisitor(std::forward<Visitor>(visitor), oldPtr, (idx + probe) % CAPACITY, b.value, false);
+                    ChangedIfDiffers(old, (idx + probe) % CAPACITY, b, status);
 
                     SHMAP_DEBUG_LOG("ShmHashTable[%zd] from ACCESSING to READY!", idx);
                     b.state.store(Bucket::READY, std::memory_order_release);
@@ -111,7 +478,8 @@ struct ShmHashTable {
                     auto expectState = Bucket::EMPTY;
                     if (!b.state.compare_exchange_strong(expectState, Bucket::INSERTING,
                             std::memory_order_acq_rel, std::memory_order_acquire)) {
-                        if (!backoff.next()) {
+                        trace.CasFailure();
+                        if (!trace.Wait(backoff)) {
                             SHMAP_DEBUG_LOG("ShmHashTable[%zd] backoff timeout!", idx);
                             return Status::TIMEOUT;
                         }
@@ -137,9 +505,12 @@ struct ShmHashTable {
                     }
 
                     b.key = key;
+                    filter_.Add(hash); // before READY, so no reader misses the key
+                    Changed(ChangeOp::Insert, (idx + probe) % CAPACITY, key);
 
                     SHMAP_DEBUG_LOG("ShmHashTable[%zd] from INSERTING to READY!", idx);
                     b.state.store(Bucket::READY, std::memory_order_release);
+                    metrics_.Add(TABLE_INSERTS);
                     return Status::SUCCESS;
                 }
 
@@ -149,7 +520,7 @@ struct ShmHashTable {
                 }
 
                 // Otherwise waiting
-                if (!backoff.next()) {
+                if (!trace.Wait(backoff)) {
                     SHMAP_DEBUG_LOG("ShmHashTable[%zd] backoff timeout!", idx);
                     return Status::TIMEOUT;
                 }
@@ -158,12 +529,189 @@ struct ShmHashTable {
         return Status::NOT_FOUND;
     }
 
-    // Travel all buckets, apply visitor to each bucket, using in sync scenarios
-    template<typename Visitor /* Status (idx, const Key&, Value&) */>
-    Status Travel(Visitor&& visitor,
-        std::chrono::nanoseconds timeout = std::chrono::seconds(5)) noexcept {
+    // Finds the bucket of every key without locking: the READY/ACCESSING bucket
+    // holding it, or the EMPTY bucket it would be inserted into. Buckets picked for
+    // an earlier new key are skipped, so two new keys never share one. `order`
+    // gets the index of the first occurrence of every distinct key.
+    template<std::size_t N>
+    Status LocateMulti(const KEY (&keys)[N], AccessMode mode, std::array<std::size_t, N>& slot,
+        std::array<bool, N>& isNew, std::array<std::size_t, N>& order, std::size_t& distinct,
+        BACKOFF& backoff, TraceSpan& trace) noexcept {
+
+        auto reserved = [&](std::size_t idx) {
+            for (std::size_t d = 0; d < distinct; ++d) {
+                if (isNew[order[d]] && slot[order[d]] == idx) return true;
+            }
+            return false;
+        };
+
+        distinct = 0;
+        for (std::size_t i = 0; i < N; ++i) {
+            std::size_t same = 0;
+            while (same < distinct && !keyEq_(keys[order[same]], keys[i])) ++same;
+            if (same < distinct) {
+                slot[i]  = slot[order[same]];
+                isNew[i] = isNew[order[same]];
+                continue;
+            }
+
+            const std::size_t hash = hasher_(keys[i]);
+            if constexpr (FILTER::ENABLED) {
+                if (mode == AccessMode::AccessExist && !filter_.MayContain(hash)) {
+                    metrics_.Add(TABLE_FILTERED);
+                    return Status::NOT_FOUND;
+                }
+            }
+            const std::size_t home = hash % CAPACITY;
+            bool found = false;
+            for (std::size_t probe = 0; probe < CAPACITY && !found; ++probe) {
+                const std::size_t idx = (home + probe) % CAPACITY;
+                trace.Probe(idx);
+                if (reserved(idx)) continue;
+
+                Bucket& b = buckets_[idx];
+                while (true) {
+                    auto state = b.state.load(std::memory_order_acquire);
+                    if (state == Bucket::INSERTING) {
+                        // Its key is not written yet, it may be ours
+                        if (!trace.Wait(backoff)) return Status::TIMEOUT;
+                        continue;
+                    }
+                    if (state == Bucket::EMPTY) {
+                        if (mode == AccessMode::AccessExist) return Status::NOT_FOUND;
+                        slot[i]  = idx;
+                        isNew[i] = true;
+                        found    = true;
+                    } else if (keyEq_(b.key, keys[i])) {
+                        // The key of a READY or ACCESSING bucket never changes
+                        slot[i]  = idx;
+                        isNew[i] = false;
+                        found    = true;
+                    }
+                    break;
+                }
+            }
+            if (!found) return Status::NOT_FOUND;
+            order[distinct++] = i;
+        }
+        return Status::SUCCESS;
+    }
+
+    template<std::size_t N>
+    void ReleaseMulti(const std::array<std::size_t, N>& slot, const std::array<bool, N>& isNew,
+        const std::array<std::size_t, N>& order, std::size_t held) noexcept {
+        for (std::size_t d = 0; d < held; ++d) {
+            const std::size_t k = order[d];
+            buckets_[slot[k]].state.store(isNew[k] ? Bucket::EMPTY : Bucket::READY, std::memory_order_release);
+        }
+    }
+
+    template<std::size_t N, typename Visitor>
+    Status DoVisitMulti(const KEY (&keys)[N], AccessMode mode, Visitor&& visitor, BACKOFF& backoff, TraceSpan& trace) noexcept {
+        std::array<std::size_t, N> slot{};
+        std::array<bool, N> isNew{};
+        std::array<std::size_t, N> order{};
+        std::size_t distinct = 0;
+
+        while (true) {
+            Status status = LocateMulti(keys, mode, slot, isNew, order, distinct, backoff, trace);
+            if (!status) return status;
+
+            // Canonical order: every caller locks lower buckets first. Insertion sort over the
+            // few distinct keys, std::sort on the small array trips GCC 12's -Warray-bounds
+            for (std::size_t d = 1; d < distinct; ++d) {
+                const std::size_t k = order[d];
+                std::size_t e = d;
+                for (; e > 0 && slot[order[e - 1]] > slot[k]; --e) {
+                    order[e] = order[e - 1];
+                }
+                order[e] = k;
+            }
+
+            std::size_t held = 0;
+            bool relocate = false;
+            for (; held < distinct; ++held) {
+                const std::size_t k = order[held];
+                Bucket& b = buckets_[slot[k]];
+                if (isNew[k]) {
+                    auto expectState = Bucket::EMPTY;
+                    if (!b.state.compare_exchange_strong(expectState, Bucket::INSERTING,
+                            std::memory_order_acq_rel, std::memory_order_acquire)) {
+                        // Taken since located, maybe by our own key
+                        trace.CasFailure();
+                        relocate = true;
+                        break;
+                    }
+                    continue;
+                }
+                while (true) {
+                    auto expectState = Bucket::READY;
+                    if (b.state.compare_exchange_strong(expectState, Bucket::ACCESSING,
+                            std::memory_order_acq_rel, std::memory_order_acquire)) {
+                        break;
+                    }
+                    trace.CasFailure();
+                    if (!trace.Wait(backoff)) {
+                        SHMAP_DEBUG_LOG("ShmHashTable[%zd] backoff timeout!", slot[k]);
+                        status = Status::TIMEOUT;
+                        break;
+                    }
+                }
+                if (!status) break;
+            }
+            if (held == distinct) break;
+
+            ReleaseMulti(slot, isNew, order, held);
+            if (!relocate) return status;
+            if (!trace.Wait(backoff)) return Status::TIMEOUT;
+        }
+
+        std::array<VALUE*, N> values{};
+        for (std::size_t i = 0; i < N; ++i) {
+            values[i] = &buckets_[slot[i]].value;
+        }
+        // Maybe save old values, of distinct existing keys only
+        std::array<VALUE, ROLLBACK_ENABLE || TRACK_CHANGES ? N : 0> old{};
+        for (std::size_t d = 0; d < distinct; ++d) {
+            const std::size_t k = order[d];
+            if (isNew[k]) {
+                new (values[k]) VALUE{}; // default construct value
+            } else if constexpr (ROLLBACK_ENABLE || TRACK_CHANGES) {
+                old[d] = *values[k];
+            }
+        }
 
-        Backoff backoff(timeout);
+        const std::array<bool, N>& created = isNew;
+        Status status = ApplyVisitor(std::forward<Visitor>(visitor), values, created);
+
+        if (!status) {
+            if constexpr (ROLLBACK_ENABLE) {
+                for (std::size_t d = 0; d < distinct; ++d) {
+                    if (!isNew[order[d]]) *values[order[d]] = old[d];
+                }
+            }
+            ReleaseMulti(slot, isNew, order, distinct);
+            return status;
+        }
+
+        for (std::size_t d = 0; d < distinct; ++d) {
+            const std::size_t k = order[d];
+            Bucket& b = buckets_[slot[k]];
+            if (isNew[k]) {
+                b.key = keys[k];
+                filter_.Add(hasher_(keys[k]));
+                Changed(ChangeOp::Insert, slot[k], keys[k]);
+                metrics_.Add(TABLE_INSERTS);
+            } else if constexpr (TRACK_CHANGES) {
+                ChangedIfDiffers(old[d], slot[k], b, status);
+            }
+            b.state.store(Bucket::READY, std::memory_order_release);
+        }
+        return Status::SUCCESS;
+    }
+
+    template<typename Visitor>
+    Status DoTravel(Visitor&& visitor, BACKOFF& backoff, TraceSpan& trace) noexcept {
         for (std::size_t idx = 0; idx < CAPACITY; ++idx) {
             Bucket& b = buckets_[idx];
             while (true) {
@@ -175,19 +723,26 @@ struct ShmHashTable {
                     uint32_t expected = Bucket::READY;
                     if (!b.state.compare_exchange_strong(expected, Bucket::ACCESSING,
                             std::memory_order_acq_rel, std::memory_order_acquire)) {
-                        if (!backoff.next()) {
+                        trace.CasFailure();
+                        if (!trace.Wait(backoff)) {
                             return Status::TIMEOUT;
                         }
                         continue;
                     }
 
+                    trace.Probe(idx);
+                    VALUE old{};
+                    if constexpr (TRACK_CHANGES) {
+                        old = b.value;
+                    }
                     Status status = ApplyVisitor(std::forward<Visitor>(visitor), idx, b.key, b.value);
+                    ChangedIfDiffers(old, idx, b, status);
                     b.state.store(Bucket::READY, std::memory_order_release);
                     if (!status) return status;
 
                     break;
                 }
-                if (!backoff.next()) {
+                if (!trace.Wait(backoff)) {
                     return Status::TIMEOUT;
                 }
             }
@@ -195,55 +750,72 @@ struct ShmHashTable {
         return Status::SUCCESS;
     }
 
-    // Visit a specific bucket by ID, apply visitor to it
-    // Only used for accessing elements exclusive to oneself and no concurrent competition
-    template<typename Visitor /* Status (Bucket&) */>
-    Status VisitBucket(std::size_t bucketId, Visitor&& visitor) noexcept {
-        if (bucketId >= CAPACITY) {
-            return Status::INVALID_ARGUMENT;
-        }
-
-        Bucket& b = buckets_[bucketId];
-        if (b.state.load(std::memory_order_acquire) != Bucket::READY) {
-            return Status::NOT_FOUND;
-        }
-
-        if constexpr (ROLLBACK_ENABLE) {
-            VALUE oldVal = b.value;
-            Status status = ApplyVisitor(std::forward<Visitor>(visitor), b);
-            if (!status) { 
-                b.value = oldVal;
+    Status CopyBucket(const Bucket& bucket, uint8_t* image, std::chrono::nanoseconds timeout) const noexcept {
+        Bucket& b = const_cast<Bucket&>(bucket);
+        BACKOFF backoff(timeout);
+        while (true) {
+            uint32_t curState = b.state.load(std::memory_order_acquire);
+            if (curState == Bucket::EMPTY || curState == Bucket::INSERTING) {
+                std::memset(image, 0, sizeof(Bucket)); // EMPTY, nothing committed yet
+                return Status::SUCCESS;
             }
-            return status;
-        } else {
-            return ApplyVisitor(std::forward<Visitor>(visitor), b);
+            if (curState == Bucket::READY && b.state.compare_exchange_strong(curState, Bucket::ACCESSING,
+                    std::memory_order_acq_rel, std::memory_order_acquire)) {
+                std::memcpy(image, static_cast<const void*>(&b), sizeof(Bucket));
+                b.state.store(Bucket::READY, std::memory_order_release);
+                const uint32_t ready = Bucket::READY;
+                std::memcpy(image + offsetof(Bucket, state), &ready, sizeof(ready));
+                return Status::SUCCESS;
+            }
+            if (!backoff.next()) return Status::TIMEOUT;
         }
     }
 
-    // Const version of VisitBucket
-    template<typename Visitor /* Status (const Bucket&) */>
-    Status VisitBucket(std::size_t bucketId, Visitor&& visitor) const noexcept {
-        return const_cast<ShmHashTable*>(this)->VisitBucket(bucketId, std::forward<Visitor>(visitor));
-    }
-
-    // Travel all buckets, apply visitor to each bucket
-    // Only used in audit scenarios exclusive to oneself and no concurrent competition
-    template<typename Visitor /* Status (idx, Bucket&) */>
-    Status TravelBucket(Visitor&& visitor) noexcept {
-        for (std::size_t idx = 0; idx < CAPACITY; ++idx) {
-            Status status = ApplyVisitor(std::forward<Visitor>(visitor), idx, buckets_[idx]);
-            if (status != Status::SUCCESS) return status;
+    template<typename Visitor>
+    Status DoTravelChangedSince(uint64_t since, Visitor&& visitor, BACKOFF& backoff, TraceSpan& trace) noexcept {
+        using Versions = ShmBucketVersions<CAPACITY, true>;
+        for (std::size_t r = 0; r < Versions::REGIONS; ++r) {
+            if (!versions_.RegionChanged(r, since)) continue;
+
+            const std::size_t end = std::min(CAPACITY, (r + 1) * Versions::REGION_BUCKETS);
+            for (std::size_t idx = r * Versions::REGION_BUCKETS; idx < end; ++idx) {
+                Bucket& b = buckets_[idx];
+                // State first: a released bucket shows the stamp of the write that
+                // released it, a held one may be stamped any time before its release
+                const uint32_t state = b.state.load(std::memory_order_acquire);
+                if ((state == Bucket::READY || state == Bucket::EMPTY) && versions_.StampOf(idx) <= since) {
+                    continue;
+                }
+                while (true) {
+                    uint32_t curState = b.state.load(std::memory_order_acquire);
+                    if (curState == Bucket::EMPTY) break;
+
+                    if (curState == Bucket::READY) {
+                        uint32_t expected = Bucket::READY;
+                        if (!b.state.compare_exchange_strong(expected, Bucket::ACCESSING,
+                                std::memory_order_acq_rel, std::memory_order_acquire)) {
+                            trace.CasFailure();
+                            if (!trace.Wait(backoff)) return Status::TIMEOUT;
+                            continue;
+                        }
+                        Status status = Status::SUCCESS;
+                        const uint64_t version = versions_.StampOf(idx);
+                        if (version > since) {
+                            trace.Probe(idx);
+                            status = ApplyVisitor(std::forward<Visitor>(visitor), idx,
+                                static_cast<const KEY&>(b.key), static_cast<const VALUE&>(b.value), version);
+                        }
+                        b.state.store(Bucket::READY, std::memory_order_release);
+                        if (!status) return status;
+                        break;
+                    }
+                    if (!trace.Wait(backoff)) return Status::TIMEOUT;
+                }
+            }
         }
         return Status::SUCCESS;
     }
 
-    // Const version of TravelBucket
-    template<typename Visitor /* Status (idx, const Bucket&) */>
-    Status TravelBucket(Visitor&& visitor) const noexcept {
-        return const_cast<ShmHashTable*>(this)->TravelBucket(std::forward<Visitor>(visitor));
-    }
-
-private:
     template<typename Visitor, typename ...Args>
     Status ApplyVisitor(Visitor&& visitor, Args&&... args) noexcept {
         Status result = Status::SUCCESS;
@@ -278,6 +850,10 @@ private:
     alignas(CACHE_LINE_SIZE) Bucket buckets_[CAPACITY];
     HASH  hasher_{};
     EQUAL keyEq_{};
+    METRICS metrics_{};
+    CHANGE_LOG changeLog_{};
+    ShmBucketVersions<CAPACITY, VERSION_ENABLE> versions_{};
+    FILTER filter_{}; // after the buckets, so CopyBytes copies it after every key it holds
 };
 
 } // namespace shmap
@@ -0,0 +1,216 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef SHMAP_SHM_HISTOGRAM_H
+#define SHMAP_SHM_HISTOGRAM_H
+
+#include "shmap/shmap.h"
+#include "shmap/shm_metrics.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <sched.h>
+
+namespace shmap {
+
+/* -------------------------------------------------------------------------- */
+/*          LogLinearBuckets – 2^SUB_BITS linear buckets per power of two     */
+/* -------------------------------------------------------------------------- */
+// Values below 2^SUB_BITS get a bucket each; above, every [2^k, 2^(k+1)) range
+// is cut into 2^SUB_BITS equal buckets, so a bucket is within 1/2^SUB_BITS of
+// any value in it (12.5% for the default 3) over the whole uint64_t range.
+template<uint32_t SUB_BITS>
+struct LogLinearBuckets {
+    static_assert(SUB_BITS >= 1 && SUB_BITS <= 8, "SUB_BITS must be in [1, 8]");
+
+    static constexpr uint32_t SUB     = 1u << SUB_BITS;
+    static constexpr uint32_t BUCKETS = (64 - SUB_BITS + 1) * SUB;
+
+    static constexpr uint32_t IndexOf(uint64_t v) noexcept {
+        if (v < SUB) {
+            return static_cast<uint32_t>(v);
+        }
+        const uint32_t k = 63 - static_cast<uint32_t>(__builtin_clzll(v));
+        return (k - SUB_BITS + 1) * SUB + static_cast<uint32_t>((v >> (k - SUB_BITS)) & (SUB - 1));
+    }
+
+    static constexpr uint64_t LowerBound(uint32_t idx) noexcept {
+        if (idx < SUB) {
+            return idx;
+        }
+        const uint32_t k = idx / SUB + SUB_BITS - 1;
+        return (uint64_t(SUB) + idx % SUB) << (k - SUB_BITS);
+    }
+
+    // Inclusive
+    static constexpr uint64_t UpperBound(uint32_t idx) noexcept {
+        return idx + 1 < BUCKETS ? LowerBound(idx + 1) - 1 : UINT64_MAX;
+    }
+};
+
+/* -------------------------------------------------------------------------- */
+/*          HistogramSnapshot – plain histogram: record, merge, percentiles   */
+/* -------------------------------------------------------------------------- */
+// Trivially copyable, so it can also be kept per process in a shm block and
+// merged by whoever reads it. Not thread safe; see ShmHistogram for that.
+template<uint32_t SUB_BITS = 3>
+struct HistogramSnapshot {
+    using Buckets = LogLinearBuckets<SUB_BITS>;
+    static constexpr uint32_t BUCKETS = Buckets::BUCKETS;
+
+    void Record(uint64_t v, uint64_t n = 1) noexcept {
+        counts_[Buckets::IndexOf(v)] += n;
+        count_ += n;
+        sum_   += v * n;
+        min_ = v < min_ ? v : min_;
+        max_ = v > max_ ? v : max_;
+    }
+
+    void Merge(const HistogramSnapshot& other) noexcept {
+        for (uint32_t i = 0; i < BUCKETS; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        sum_   += other.sum_;
+        min_ = other.min_ < min_ ? other.min_ : min_;
+        max_ = other.max_ > max_ ? other.max_ : max_;
+    }
+
+    uint64_t Count() const noexcept { return count_; }
+    uint64_t Sum()   const noexcept { return sum_; }
+    uint64_t Min()   const noexcept { return count_ ? min_ : 0; }
+    uint64_t Max()   const noexcept { return max_; }
+
+    double Mean() const noexcept {
+        return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0;
+    }
+
+    uint64_t CountAt(uint32_t idx) const noexcept {
+        return idx < BUCKETS ? counts_[idx] : 0;
+    }
+
+    // Lower bound of the bucket holding the q-quantile, clamped to [Min, Max]
+    uint64_t Percentile(double q) const noexcept {
+        if (count_ == 0) {
+            return 0;
+        }
+        q = q < 0.0 ? 0.0 : (q > 1.0 ? 1.0 : q);
+        const uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count_ - 1)) + 1;
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < BUCKETS; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                const uint64_t v = Buckets::LowerBound(i);
+                return v < min_ ? min_ : (v > max_ ? max_ : v);
+            }
+        }
+        return max_;
+    }
+
+    void Reset() noexcept {
+        *this = HistogramSnapshot{};
+    }
+
+private:
+    template<uint32_t, std::size_t> friend struct ShmHistogram;
+
+    std::array<uint64_t, BUCKETS> counts_{};
+    uint64_t count_{0};
+    uint64_t sum_{0};
+    uint64_t min_{UINT64_MAX};
+    uint64_t max_{0};
+};
+
+/* -------------------------------------------------------------------------- */
+/*          ShmHistogram – concurrent histogram inside the shm segment        */
+/* -------------------------------------------------------------------------- */
+// Any process mapping it records with relaxed atomic increments, readers take a
+// HistogramSnapshot. With SHARDS > 1 each CPU records into its own shard (about
+// 4KB each for SUB_BITS 3), so recorders on different cores never share a line.
+template<uint32_t SUB_BITS = 3, std::size_t SHARDS = 1>
+struct alignas(CACHE_LINE_SIZE) ShmHistogram {
+    static_assert(SHARDS > 0, "SHARDS must be > 0");
+
+    using Buckets  = LogLinearBuckets<SUB_BITS>;
+    using Snapshot = HistogramSnapshot<SUB_BITS>;
+    static constexpr uint32_t BUCKETS = Buckets::BUCKETS;
+
+    ShmHistogram() = default; // Only used for placement-new
+
+    void Record(uint64_t v, uint64_t n = 1) noexcept {
+        Shard& s = shards_[ShardOf()];
+        s.counts[Buckets::IndexOf(v)].fetch_add(n, std::memory_order_relaxed);
+        s.count.fetch_add(n, std::memory_order_relaxed);
+        s.sum.fetch_add(v * n, std::memory_order_relaxed);
+        // The extremes rarely move, so the CAS loops rarely run
+        uint64_t cur = s.min.load(std::memory_order_relaxed);
+        while (v < cur && !s.min.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {}
+        cur = s.max.load(std::memory_order_relaxed);
+        while (v > cur && !s.max.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {}
+    }
+
+    // Counts recorded concurrently may show up in some fields and not yet in others
+    Snapshot Read() const noexcept {
+        Snapshot snap;
+        ReadInto(snap);
+        return snap;
+    }
+
+    // Adds this histogram to `snap`, for merging several of them
+    void ReadInto(Snapshot& snap) const noexcept {
+        for (const Shard& s : shards_) {
+            for (uint32_t i = 0; i < BUCKETS; ++i) {
+                snap.counts_[i] += s.counts[i].load(std::memory_order_relaxed);
+            }
+            snap.count_ += s.count.load(std::memory_order_relaxed);
+            snap.sum_   += s.sum.load(std::memory_order_relaxed);
+            const uint64_t min = s.min.load(std::memory_order_relaxed);
+            const uint64_t max = s.max.load(std::memory_order_relaxed);
+            snap.min_ = min < snap.min_ ? min : snap.min_;
+            snap.max_ = max > snap.max_ ? max : snap.max_;
+        }
+    }
+
+    // Only when no process is recording
+    void Reset() noexcept {
+        for (Shard& s : shards_) {
+            for (auto& c : s.counts) {
+                c.store(0, std::memory_order_relaxed);
+            }
+            s.count.store(0, std::memory_order_relaxed);
+            s.sum.store(0, std::memory_order_relaxed);
+            s.min.store(UINT64_MAX, std::memory_order_relaxed);
+            s.max.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> min{UINT64_MAX};
+        std::atomic<uint64_t> max{0};
+        std::array<std::atomic<uint64_t>, BUCKETS> counts{};
+    };
+
+    static std::size_t ShardOf() noexcept {
+        if constexpr (SHARDS == 1) {
+            return 0;
+        } else {
+            const int cpu = ::sched_getcpu();
+            return cpu >= 0 ? static_cast<std::size_t>(cpu) % SHARDS : detail::MetricsShardHint() % SHARDS;
+        }
+    }
+
+private:
+    std::array<Shard, SHARDS> shards_{};
+};
+
+}
+
+#endif
@@ -0,0 +1,274 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef SHMAP_SHM_METRICS_H
+#define SHMAP_SHM_METRICS_H
+
+#include "shmap/shmap.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <unistd.h>
+
+namespace shmap {
+
+/* -------------------------------------------------------------------------- */
+/*          Metric ids                                                        */
+/* -------------------------------------------------------------------------- */
+enum class MetricKind : uint32_t {
+    HashTable  = 1,
+    RingBuffer = 2,
+};
+
+// Counters of ShmHashTable, hits are VISITS - INSERTS - MISSES - TIMEOUTS - FAILURES
+enum TableMetric : uint32_t {
+    TABLE_VISITS,
+    TABLE_INSERTS,
+    TABLE_MISSES,
+    TABLE_TIMEOUTS,
+    TABLE_FAILURES,       // visitor returned an error
+    TABLE_BACKOFF_STEPS,
+    TABLE_TRAVELS,
+    TABLE_FILTERED,       // misses answered by the filter, also in MISSES
+};
+
+// Counters of the ring buffers
+enum RingMetric : uint32_t {
+    RING_PUSHES,
+    RING_PUSH_FULL,       // push rejected: full or timed out
+    RING_POPS,
+    RING_POP_EMPTY,
+    RING_BACKOFF_STEPS,
+};
+
+// High-water marks
+enum RingGauge : uint32_t {
+    RING_DEPTH_HIGH_WATER,
+};
+
+constexpr uint32_t METRIC_COUNTERS = 8;
+constexpr uint32_t METRIC_GAUGES   = 2;
+
+inline const char* MetricKindName(MetricKind kind) noexcept {
+    switch (kind) {
+    case MetricKind::HashTable:  return "HashTable";
+    case MetricKind::RingBuffer: return "RingBuffer";
+    }
+    return "Unknown";
+}
+
+// Counter name, nullptr for unused ids
+inline const char* MetricName(MetricKind kind, uint32_t id) noexcept {
+    static constexpr const char* TABLE[METRIC_COUNTERS] = {
+        "visits", "inserts", "misses", "timeouts", "failures", "backoff_steps", "travels", "filtered"
+    };
+    static constexpr const char* RING[METRIC_COUNTERS] = {
+        "pushes", "push_full", "pops", "pop_empty", "backoff_steps", nullptr, nullptr, nullptr
+    };
+    if (id >= METRIC_COUNTERS) return nullptr;
+    return kind == MetricKind::HashTable ? TABLE[id] : kind == MetricKind::RingBuffer ? RING[id] : nullptr;
+}
+
+inline const char* GaugeName(MetricKind kind, uint32_t id) noexcept {
+    if (kind == MetricKind::RingBuffer && id == RING_DEPTH_HIGH_WATER) return "depth_high_water";
+    return nullptr;
+}
+
+/* -------------------------------------------------------------------------- */
+/*          NoMetrics – default, compiles to nothing                          */
+/* -------------------------------------------------------------------------- */
+struct NoMetrics {
+    static constexpr bool ENABLED = false;
+
+    void Add(uint32_t, uint64_t = 1) noexcept {}
+    void UpdateMax(uint32_t, uint64_t) noexcept {}
+};
+
+namespace detail {
+
+// Stable per thread, different across processes and across the threads of one
+// process. Recomputed in a forked child, which would otherwise share its parent's.
+inline uint32_t MetricsShardHint() noexcept {
+    thread_local uint32_t epoch = UINT32_MAX;
+    thread_local uint32_t hint  = 0;
+    const uint32_t current = ForkEpoch().load(std::memory_order_relaxed);
+    if (epoch != current) {
+        WatchForks();
+        static std::atomic<uint32_t> threads{0};
+        uint64_t x = static_cast<uint64_t>(getpid()) * 0x9E3779B97F4A7C15ull;
+        hint  = static_cast<uint32_t>(x >> 32) + threads.fetch_add(1, std::memory_order_relaxed);
+        epoch = current;
+    }
+    return hint;
+}
+
+}
+
+/* -------------------------------------------------------------------------- */
+/*          ShmMetrics – sharded relaxed counters inside the shm segment      */
+/* -------------------------------------------------------------------------- */
+// Each process/thread adds to its own cache line shard with relaxed fetch_add, so
+// counting costs one uncontended atomic. Readers sum the shards. The header starts
+// with MAGIC so shmap-stat can find the block by scanning a mapped segment.
+template<MetricKind KIND, std::size_t SHARDS = 16>
+struct alignas(CACHE_LINE_SIZE) ShmMetrics {
+    static_assert(SHARDS > 0 && SHARDS <= 256, "SHARDS must be in [1, 256]");
+
+    static constexpr bool ENABLED = true;
+    static constexpr uint64_t MAGIC = 0x5352544D50414D53ull; // "SMAPMTRS"
+    static constexpr uint32_t VERSION = 1;
+
+    struct Header {
+        uint64_t magic{MAGIC};
+        uint32_t version{VERSION};
+        uint32_t kind{static_cast<uint32_t>(KIND)};
+        uint32_t shards{static_cast<uint32_t>(SHARDS)};
+        uint32_t counters{METRIC_COUNTERS};
+        uint32_t gauges{METRIC_GAUGES};
+        uint32_t check{CheckOf(static_cast<uint32_t>(KIND), SHARDS)};
+    };
+
+    struct Snapshot {
+        std::array<uint64_t, METRIC_COUNTERS> counters{};
+        std::array<uint64_t, METRIC_GAUGES> gauges{};
+    };
+
+    static constexpr uint32_t CheckOf(uint32_t kind, std::size_t shards) noexcept {
+        return static_cast<uint32_t>(MAGIC >> 32) ^ static_cast<uint32_t>(MAGIC)
+            ^ (kind << 24) ^ static_cast<uint32_t>(shards) ^ (METRIC_COUNTERS << 8) ^ (METRIC_GAUGES << 16);
+    }
+
+    void Add(uint32_t id, uint64_t n = 1) noexcept {
+        shards_[detail::MetricsShardHint() % SHARDS].counters[id].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    // Raise gauge `id` to `value` if it is higher, the common case is a single load
+    void UpdateMax(uint32_t id, uint64_t value) noexcept {
+        auto& gauge = gauges_[id];
+        uint64_t cur = gauge.load(std::memory_order_relaxed);
+        while (value > cur && !gauge.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {}
+    }
+
+    uint64_t Get(uint32_t id) const noexcept {
+        uint64_t sum = 0;
+        for (const auto& shard : shards_) {
+            sum += shard.counters[id].load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    uint64_t GetGauge(uint32_t id) const noexcept {
+        return gauges_[id].load(std::memory_order_relaxed);
+    }
+
+    Snapshot Read() const noexcept {
+        Snapshot snapshot;
+        for (uint32_t i = 0; i < METRIC_COUNTERS; ++i) snapshot.counters[i] = Get(i);
+        for (uint32_t i = 0; i < METRIC_GAUGES; ++i) snapshot.gauges[i] = GetGauge(i);
+        return snapshot;
+    }
+
+    // Only used when no process is updating
+    void Reset() noexcept {
+        for (auto& shard : shards_) {
+            for (auto& c : shard.counters) c.store(0, std::memory_order_relaxed);
+        }
+        for (auto& g : gauges_) g.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        std::atomic<uint64_t> counters[METRIC_COUNTERS]{};
+    };
+
+private:
+    Header header_{};
+    std::atomic<uint64_t> gauges_[METRIC_GAUGES]{};
+    Shard shards_[SHARDS];
+};
+
+using ShmTableMetrics = ShmMetrics<MetricKind::HashTable>;
+using ShmRingMetrics  = ShmMetrics<MetricKind::RingBuffer>;
+
+/* -------------------------------------------------------------------------- */
+/*          ShmMetricsView – read-only access for external tools              */
+/* -------------------------------------------------------------------------- */
+// Interprets a metrics block found in a mapping of unknown layout (e.g. PROT_READ
+// mapping in shmap-stat). Every ShmMetrics<KIND, SHARDS> shares this layout.
+struct ShmMetricsView {
+    using Layout = ShmMetrics<MetricKind::HashTable, 1>;
+
+    // nullopt-like: Valid() is false when `addr` does not hold a metrics block
+    static ShmMetricsView At(const void* addr, std::size_t bytes) noexcept {
+        ShmMetricsView view;
+        if (bytes < sizeof(Layout::Header)) return view;
+        const auto* header = static_cast<const Layout::Header*>(addr);
+        if (header->magic != Layout::MAGIC || header->version != Layout::VERSION
+            || header->counters != METRIC_COUNTERS || header->gauges != METRIC_GAUGES
+            || header->shards == 0 || header->shards > 256
+            || header->check != Layout::CheckOf(header->kind, header->shards)) {
+            return view;
+        }
+        if (bytes < SizeOf(header->shards)) return view;
+        view.base_ = static_cast<const uint8_t*>(addr);
+        view.header_ = header;
+        return view;
+    }
+
+    // Call f(offset, view) for every metrics block in [addr, addr + bytes).
+    // Blocks are cache line aligned inside their structure, `addr` must be too.
+    template<typename F /* void (std::size_t offset, const ShmMetricsView&) */>
+    static void Scan(const void* addr, std::size_t bytes, F&& f) {
+        const auto* base = static_cast<const uint8_t*>(addr);
+        for (std::size_t off = 0; off + sizeof(Layout::Header) <= bytes; ) {
+            ShmMetricsView view = At(base + off, bytes - off);
+            if (view.Valid()) {
+                f(off, view);
+                off += view.Size();
+            } else {
+                off += CACHE_LINE_SIZE;
+            }
+        }
+    }
+
+    static constexpr std::size_t SizeOf(uint32_t shards) noexcept {
+        return SHARD_OFFSET + std::size_t(shards) * CACHE_LINE_SIZE;
+    }
+
+    bool Valid() const noexcept { return header_ != nullptr; }
+    MetricKind Kind() const noexcept { return static_cast<MetricKind>(header_->kind); }
+    uint32_t Shards() const noexcept { return header_->shards; }
+    std::size_t Size() const noexcept { return SizeOf(header_->shards); }
+
+    uint64_t Get(uint32_t id) const noexcept {
+        uint64_t sum = 0;
+        for (uint32_t s = 0; s < header_->shards; ++s) {
+            sum += reinterpret_cast<const std::atomic<uint64_t>*>(
+                base_ + SHARD_OFFSET + s * CACHE_LINE_SIZE)[id].load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    uint64_t GetGauge(uint32_t id) const noexcept {
+        return reinterpret_cast<const std::atomic<uint64_t>*>(
+            base_ + sizeof(Layout::Header))[id].load(std::memory_order_relaxed);
+    }
+
+private:
+    // Header and gauges share the first cache line
+    static constexpr std::size_t SHARD_OFFSET = CACHE_LINE_SIZE;
+    static_assert(sizeof(Layout::Header) + METRIC_GAUGES * sizeof(uint64_t) <= CACHE_LINE_SIZE,
+        "Header and gauges must fit one cache line");
+    static_assert(sizeof(Layout) == SHARD_OFFSET + CACHE_LINE_SIZE, "Unexpected ShmMetrics layout");
+
+    const uint8_t* base_{nullptr};
+    const Layout::Header* header_{nullptr};
+};
+
+}
+
+#endif
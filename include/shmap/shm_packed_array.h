@@ -0,0 +1,186 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef SHMAP_SHM_PACKED_ARRAY_H
+#define SHMAP_SHM_PACKED_ARRAY_H
+
+#include "shmap/shmap.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #include <immintrin.h>
+    #define SHMAP_PACKED_ARRAY_BMI2 1
+#else
+    #define SHMAP_PACKED_ARRAY_BMI2 0
+#endif
+
+namespace shmap {
+
+namespace detail {
+#if SHMAP_PACKED_ARRAY_BMI2
+    inline bool HasBmi2() noexcept {
+        static const bool has = __builtin_cpu_supports("bmi2");
+        return has;
+    }
+#endif
+
+    // `mask` repeated in each of the 64 / LANE_BITS lanes of a word
+    constexpr uint64_t RepeatLaneMask(uint64_t mask, std::size_t laneBits) noexcept {
+        uint64_t result = 0;
+        for (std::size_t lane = 0; lane < 64; lane += laneBits) {
+            result |= mask << lane;
+        }
+        return result;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*            ShmPackedArray – dense array of BITS-wide unsigned values       */
+/* -------------------------------------------------------------------------- */
+// 64 / BITS values are packed per 64-bit word and never straddle two words,
+// so every single element update is one CAS on one word.
+template<std::size_t BITS, std::size_t N>
+struct ShmPackedArray {
+    static_assert(BITS > 0 && BITS <= 32, "BITS must be in [1, 32]");
+    static_assert(N > 0, "N must be > 0");
+
+    using Value = uint32_t;
+
+    static constexpr std::size_t PER_WORD = 64 / BITS;
+    static constexpr std::size_t WORDS    = (N + PER_WORD - 1) / PER_WORD;
+    static constexpr uint64_t    MASK     = (uint64_t(1) << BITS) - 1;
+
+    static constexpr std::size_t capacity() noexcept {
+        return N;
+    }
+
+    static constexpr Value max_value() noexcept {
+        return static_cast<Value>(MASK);
+    }
+
+    Value Get(std::size_t i, std::memory_order order = std::memory_order_acquire) const noexcept {
+        return static_cast<Value>((words_[i / PER_WORD].load(order) >> Shift(i)) & MASK);
+    }
+
+    // Values wider than BITS are truncated
+    void Set(std::size_t i, Value v) noexcept {
+        auto& word = words_[i / PER_WORD];
+        const uint64_t mask = MASK << Shift(i);
+        const uint64_t bits = (uint64_t(v) & MASK) << Shift(i);
+        uint64_t old = word.load(std::memory_order_relaxed);
+        while (!word.compare_exchange_weak(old, (old & ~mask) | bits,
+                std::memory_order_acq_rel, std::memory_order_relaxed)) {}
+    }
+
+    // On failure `expected` is updated with the current value of element i
+    bool CompareExchange(std::size_t i, Value& expected, Value desired) noexcept {
+        auto& word = words_[i / PER_WORD];
+        const uint64_t mask = MASK << Shift(i);
+        uint64_t old = word.load(std::memory_order_relaxed);
+        while (true) {
+            Value current = static_cast<Value>((old >> Shift(i)) & MASK);
+            if (current != expected) {
+                expected = current;
+                return false;
+            }
+            uint64_t next = (old & ~mask) | ((uint64_t(desired) & MASK) << Shift(i));
+            if (word.compare_exchange_weak(old, next,
+                    std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+
+    // Bulk decode `count` elements from `start` into `out`, one relaxed load per word.
+    // Uses BMI2 pdep to expand several elements at once when the CPU supports it.
+    // Returns the number of decoded elements.
+    template<typename OutT>
+    std::size_t Decode(std::size_t start, std::size_t count, OutT* out) const noexcept {
+        static_assert(std::is_unsigned_v<OutT> && sizeof(OutT) * 8 >= BITS, "OutT can not hold BITS");
+
+        if (start >= N) {
+            return 0;
+        }
+        count = std::min(count, N - start);
+
+        std::size_t i = start;
+        const std::size_t end = start + count;
+        while (i < end) {
+            const std::size_t k = i % PER_WORD;
+            const std::size_t n = std::min(PER_WORD - k, end - i);
+            const uint64_t word = words_[i / PER_WORD].load(std::memory_order_relaxed) >> (k * BITS);
+#if SHMAP_PACKED_ARRAY_BMI2
+            if (detail::HasBmi2()) {
+                DecodeWordBmi2(word, n, out);
+            } else {
+                DecodeWord(word, n, out);
+            }
+#else
+            DecodeWord(word, n, out);
+#endif
+            out += n;
+            i += n;
+        }
+        return count;
+    }
+
+    // Only used in none parallel scenarios
+    void clear() noexcept {
+        for (auto& word : words_) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    static constexpr std::size_t Shift(std::size_t i) noexcept {
+        return (i % PER_WORD) * BITS;
+    }
+
+    template<typename OutT>
+    static void DecodeWord(uint64_t word, std::size_t n, OutT* out) noexcept {
+        for (std::size_t j = 0; j < n; ++j) {
+            out[j] = static_cast<OutT>(word & MASK);
+            word >>= BITS;
+        }
+    }
+
+#if SHMAP_PACKED_ARRAY_BMI2
+    // Deposit LANES elements into byte/short/int lanes of one word per pdep
+    template<typename OutT>
+    __attribute__((target("bmi2")))
+    static void DecodeWordBmi2(uint64_t word, std::size_t n, OutT* out) noexcept {
+        using Lane = std::conditional_t<(BITS <= 8), uint8_t,
+                     std::conditional_t<(BITS <= 16), uint16_t, uint32_t>>;
+        constexpr std::size_t LANES = sizeof(uint64_t) / sizeof(Lane);
+        constexpr uint64_t LANE_MASK = detail::RepeatLaneMask(MASK, sizeof(Lane) * 8);
+
+        while (n >= LANES) {
+            uint64_t deposited = _pdep_u64(word, LANE_MASK);
+            Lane lanes[LANES];
+            std::memcpy(lanes, &deposited, sizeof(lanes));
+            for (std::size_t l = 0; l < LANES; ++l) {
+                out[l] = static_cast<OutT>(lanes[l]);
+            }
+            out += LANES;
+            n -= LANES;
+            word = (LANES * BITS < 64) ? (word >> (LANES * BITS)) : 0;
+        }
+        DecodeWord(word, n, out);
+    }
+#endif
+
+private:
+    std::array<std::atomic<uint64_t>, WORDS> words_{};
+};
+
+}
+
+#endif
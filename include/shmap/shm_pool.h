@@ -0,0 +1,92 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef SHMAP_SHM_POOL_H
+#define SHMAP_SHM_POOL_H
+
+#include "shmap/shmap.h"
+#include "shmap/tagged_index.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+namespace shmap {
+
+/* -------------------------------------------------------------------------- */
+/*          ShmPool – fixed capacity slot pool with a lock-free free list     */
+/* -------------------------------------------------------------------------- */
+// Slots are addressed by index so the pool works at any mapping address.
+// The free list head is a TaggedIndex: a slot popped, reused and pushed back
+// between another process' load and CAS changes the tag, so the CAS fails (no ABA).
+template<typename T, std::size_t CAPACITY>
+struct ShmPool {
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(std::is_standard_layout<T>::value, "T should be standard layout!");
+    static_assert(CAPACITY > 0 && CAPACITY < UINT32_MAX, "CAPACITY must fit in a 32-bit index");
+
+    using Head = TaggedIndex<32, 32>;
+
+    static constexpr uint32_t NIL = static_cast<uint32_t>(Head::NIL);
+
+    static constexpr std::size_t capacity() noexcept {
+        return CAPACITY;
+    }
+
+    ShmPool() noexcept {
+        for (std::size_t i = 0; i < CAPACITY; ++i) {
+            next_[i].store(i + 1 < CAPACITY ? static_cast<uint32_t>(i + 1) : NIL, std::memory_order_relaxed);
+        }
+        head_.Store(Head(0, 0), std::memory_order_relaxed);
+    }
+
+    // Take a free slot, nullopt when the pool is exhausted
+    std::optional<uint32_t> allocate() noexcept {
+        Head head = head_.Load();
+        while (!head.IsNil()) {
+            // May read a stale next when the slot is taken concurrently, the tag rejects the CAS then
+            uint32_t next = next_[head.Index()].load(std::memory_order_relaxed);
+            if (head_.CompareExchange(head, head.Next(next))) {
+                available_.fetch_sub(1, std::memory_order_relaxed);
+                return static_cast<uint32_t>(head.Index());
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Give back a slot obtained from allocate
+    void release(uint32_t idx) noexcept {
+        Head head = head_.Load(std::memory_order_relaxed);
+        do {
+            next_[idx].store(static_cast<uint32_t>(head.Index()), std::memory_order_relaxed);
+        } while (!head_.CompareExchange(head, head.Next(idx)));
+        available_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    T& operator[](uint32_t idx) noexcept {
+        return slots_[idx];
+    }
+
+    const T& operator[](uint32_t idx) const noexcept {
+        return slots_[idx];
+    }
+
+    // Approximate number of free slots under concurrency
+    std::size_t available() const noexcept {
+        return available_.load(std::memory_order_relaxed);
+    }
+
+private:
+    alignas(CACHE_LINE_SIZE) AtomicTaggedIndex<32, 32> head_;
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> available_{CAPACITY};
+    std::array<std::atomic<uint32_t>, CAPACITY> next_;
+    std::array<T, CAPACITY> slots_;
+};
+
+}
+
+#endif
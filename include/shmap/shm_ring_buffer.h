@@ -7,6 +7,8 @@
 
 #include "shmap/shmap.h"
 #include "shmap/backoff.h"
+#include "shmap/shm_metrics.h"
+#include "shmap/shm_trace.h"
 
 #include <array>
 #include <atomic>
@@ -21,7 +23,9 @@ namespace shmap {
 /* -------------------------------------------------------------------------- */
 /*                              ShmRingBugger - SPSC                          */
 /* -------------------------------------------------------------------------- */
-template <typename T, std::size_t N>
+template <typename T, std::size_t N,
+    typename METRICS = NoMetrics /* ShmRingMetrics to count in shm */
+>
 struct ShmRingBuffer {
     static_assert(std::is_trivially_copyable<T>::value,  "T must be trivially copyable");
     static_assert(std::is_standard_layout<T>::value, "T should be standard layout!");
@@ -53,10 +57,13 @@ struct ShmRingBuffer {
         auto h = head_.load(std::memory_order_acquire);
         auto t = tail_.load(std::memory_order_relaxed);
         if (t - h >= N) {
+            metrics_.Add(RING_PUSH_FULL);
             return false; // full
         }
         data_[t % N] = v;
         tail_.store(t + 1, std::memory_order_release);
+        metrics_.Add(RING_PUSHES);
+        metrics_.UpdateMax(RING_DEPTH_HIGH_WATER, t + 1 - h);
         return true;
     }
 
@@ -67,6 +74,7 @@ struct ShmRingBuffer {
             h = head_.load(std::memory_order_relaxed);
             t = tail_.load(std::memory_order_acquire);
             if (h >= t) {
+                metrics_.Add(RING_POP_EMPTY);
                 return std::nullopt; // empty
             }
         } while (!head_.compare_exchange_weak(
@@ -74,20 +82,28 @@ struct ShmRingBuffer {
                      std::memory_order_acq_rel,
                      std::memory_order_relaxed));
         // successfully claimed slot at h
+        metrics_.Add(RING_POPS);
         return data_[h % N];
     }
 
+    const METRICS& metrics() const noexcept {
+        return metrics_;
+    }
+
 private:
     alignas(alignof(T)) std::array<T, N> data_;
     alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_{0};
     alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_{0};
+    METRICS metrics_{};
 };
 
 
 /* -------------------------------------------------------------------------- */
 /*       ShmRingBugger - SPMC （only one consumer fetches data success）       */
 /* -------------------------------------------------------------------------- */
-template <typename T, std::size_t N>
+template <typename T, std::size_t N,
+    typename METRICS = NoMetrics /* ShmRingMetrics to count in shm */
+>
 struct ShmSpMcRingBuffer {
     static_assert(std::is_trivially_copyable_v<T>);
     static_assert(std::is_standard_layout<T>::value, "T should be standard layout!");
@@ -112,9 +128,14 @@ struct ShmSpMcRingBuffer {
                         std::memory_order_acq_rel, std::memory_order_acquire)) {
                     c.data = v;
                     c.seq.store(pos + 1, std::memory_order_release);
+                    metrics_.Add(RING_PUSHES);
+                    if constexpr (METRICS::ENABLED) {
+                        metrics_.UpdateMax(RING_DEPTH_HIGH_WATER, pos + 1 - head_.load(std::memory_order_relaxed));
+                    }
                     return true;
                 }
             } else if (diff < 0) {
+                metrics_.Add(RING_PUSH_FULL);
                 return false; // full
             } else {
                 pos = tail_.load(std::memory_order_relaxed);
@@ -135,9 +156,11 @@ struct ShmSpMcRingBuffer {
                         std::memory_order_acq_rel, std::memory_order_acquire)) {
                     T v = c.data;
                     c.seq.store(pos + N, std::memory_order_release); // mark empty
+                    metrics_.Add(RING_POPS);
                     return v;
                 }
             } else if (diff < 0) {
+                metrics_.Add(RING_POP_EMPTY);
                 return std::nullopt; // empty
             } else {
                 pos = head_.load(std::memory_order_relaxed);
@@ -156,6 +179,10 @@ struct ShmSpMcRingBuffer {
             buf_[i].seq.store(i, std::memory_order_relaxed);
     }
 
+    const METRICS& metrics() const noexcept {
+        return metrics_;
+    }
+
 private:
     struct Cell {
         std::atomic<std::size_t> seq;
@@ -166,12 +193,16 @@ private:
     alignas(CACHE_LINE_SIZE) std::array<Cell, N> buf_;
     alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_{0};
     alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_{0};
+    METRICS metrics_{};
 };
 
 /* -------------------------------------------------------------------------- */
 /*           ShmRingBugger - SPMC (all consumers fetch data success）         */
 /* -------------------------------------------------------------------------- */
-template<typename T, std::size_t N, std::size_t MAX_CONCUMER = 8>
+template<typename T, std::size_t N, std::size_t MAX_CONCUMER = 8,
+    typename BACKOFF = Backoff,
+    typename METRICS = NoMetrics /* ShmRingMetrics to count in shm */
+>
 struct BroadcastRingBuffer {
     static_assert(std::is_trivially_copyable_v<T>);
     static_assert(std::is_standard_layout<T>::value, "T should be standard layout!");
@@ -213,9 +244,14 @@ struct BroadcastRingBuffer {
         Slot& slot = slots_[pos & (N - 1)];
 
         // Use backoff to avoid busy-waiting
-        Backoff backoff(std::chrono::milliseconds(100));
+        BACKOFF backoff(std::chrono::milliseconds(100));
+        TraceSpan trace(TraceOp::RingPush);
+        trace.Probe(pos & (N - 1));
         while (slot.remain.load(std::memory_order_acquire) != 0) {
-            if (!backoff.next()) {
+            if (!trace.Wait(backoff)) {
+                metrics_.Add(RING_PUSH_FULL);
+                metrics_.Add(RING_BACKOFF_STEPS, backoff.steps());
+                trace.End(Status::TIMEOUT);
                 return false; // Timeout
             }
         }
@@ -224,6 +260,11 @@ struct BroadcastRingBuffer {
 
         slot.seq.store(pos, std::memory_order_release);
         slot.remain.store(consumer_cnt_.load(std::memory_order_relaxed), std::memory_order_release);
+        metrics_.Add(RING_PUSHES);
+        if (backoff.steps()) {
+            metrics_.Add(RING_BACKOFF_STEPS, backoff.steps());
+        }
+        trace.End(Status::SUCCESS);
         return true;
     }
 
@@ -235,11 +276,13 @@ struct BroadcastRingBuffer {
             Slot& slot = rb->slots_[cursor & (N - 1)];
             uint64_t seq = slot.seq.load(std::memory_order_acquire);
             if (seq != cursor) {
+                rb->metrics_.Add(RING_POP_EMPTY);
                 return std::nullopt;
             }
 
             uint32_t r = slot.remain.load(std::memory_order_acquire);
             if (r == 0) {
+                rb->metrics_.Add(RING_POP_EMPTY);
                 return std::nullopt;
             }
 
@@ -247,6 +290,7 @@ struct BroadcastRingBuffer {
 
             slot.remain.fetch_sub(1, std::memory_order_acq_rel);
             ++cursor;
+            rb->metrics_.Add(RING_POPS);
             return v;
         }
     };
@@ -255,6 +299,10 @@ struct BroadcastRingBuffer {
         return Consumer{this, 0}; 
     }
 
+    const METRICS& metrics() const noexcept {
+        return metrics_;
+    }
+
 private:
     struct Slot {
         alignas(64) std::atomic<uint64_t> seq{0};
@@ -266,6 +314,7 @@ private:
     alignas(64) std::array<Slot, N> slots_{};
     alignas(64) std::atomic<std::size_t> tail_{0};
     alignas(64) std::atomic<uint32_t> consumer_cnt_{0};
+    METRICS metrics_{};
 };
 
 }
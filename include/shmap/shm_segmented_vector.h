@@ -0,0 +1,398 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef SHMAP_SHM_SEGMENTED_VECTOR_H
+#define SHMAP_SHM_SEGMENTED_VECTOR_H
+
+#include "shmap/shmap.h"
+#include "shmap/backoff.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #include <cerrno>
+#else
+    #error "POSIX shared memory is required."
+#endif
+
+namespace shmap {
+
+/* -------------------------------------------------------------------------- */
+/*          ShmSegmentedVector – vector growing into shm chunks on demand     */
+/* -------------------------------------------------------------------------- */
+// The header object at SHM_PATH::value holds the sizes and the chunk directory,
+// chunk k lives in its own shm object "<SHM_PATH::value>.<k>" and is created by
+// the first writer reserving a slot in it. Other processes map chunks lazily.
+template<typename T, std::size_t CHUNK_CAPACITY, std::size_t MAX_CHUNKS,
+    typename SHM_PATH /* SHM_PATH::value is shm path str */>
+struct ShmSegmentedVector {
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+    static_assert(std::is_standard_layout<T>::value, "T should be standard layout!");
+    static_assert(CHUNK_CAPACITY && (CHUNK_CAPACITY & (CHUNK_CAPACITY - 1)) == 0,
+        "Chunk capacity must be power of two for cheap modulo");
+    static_assert(MAX_CHUNKS > 0, "MAX_CHUNKS must be > 0");
+
+    static ShmSegmentedVector& GetInstance() {
+        static ShmSegmentedVector instance;
+        return instance;
+    }
+
+    ShmSegmentedVector(const ShmSegmentedVector&)            = delete;
+    ShmSegmentedVector& operator=(const ShmSegmentedVector&) = delete;
+
+    ~ShmSegmentedVector() {
+        Close();
+    }
+
+    // Unlink the header and all created chunks
+    void Destroy() {
+        for (std::size_t k = 0; k < MAX_CHUNKS; ++k) {
+            if (header_ && header_->chunks[k].load(std::memory_order_acquire) != CHUNK_EMPTY) {
+                ::shm_unlink(ChunkPath(k).c_str());
+            }
+        }
+        Close();
+        ::shm_unlink(SHM_PATH::value);
+    }
+
+    static constexpr std::size_t capacity() noexcept {
+        return CHUNK_CAPACITY * MAX_CHUNKS;
+    }
+
+    static constexpr std::size_t chunk_capacity() noexcept {
+        return CHUNK_CAPACITY;
+    }
+
+    std::size_t size() const noexcept {
+        return header_->size.load(std::memory_order_acquire);
+    }
+
+    std::size_t committed() const noexcept {
+        return header_->committed.load(std::memory_order_acquire);
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    // Number of chunks created in shm by any process
+    std::size_t chunk_count() const noexcept {
+        std::size_t n = 0;
+        for (const auto& chunk : header_->chunks) {
+            n += chunk.load(std::memory_order_acquire) == CHUNK_READY;
+        }
+        return n;
+    }
+
+    // Bytes of shm backing the vector: header plus created chunks
+    std::size_t mem_usage() const noexcept {
+        return sizeof(Header) + chunk_count() * CHUNK_BYTES;
+    }
+
+    // Reserve `n` slots atomically, creating the chunks they fall into.
+    // Returns starting index or nullopt on overflow or chunk creation failure.
+    // Chunks are mapped before the slots are published, so a failure reserves
+    // nothing and never leaves a gap that commit() would wait on forever.
+    std::optional<std::size_t> allocate(std::size_t n) noexcept {
+        std::size_t old = header_->size.load(std::memory_order_relaxed);
+        do {
+            if (old + n > capacity()) {
+                return std::nullopt;
+            }
+            for (std::size_t k = old / CHUNK_CAPACITY; n && k <= (old + n - 1) / CHUNK_CAPACITY; ++k) {
+                if (!MapChunk(k, true)) {
+                    return std::nullopt;
+                }
+            }
+        } while (!header_->size.compare_exchange_weak(
+            old, old + n,
+            std::memory_order_acq_rel,
+            std::memory_order_acquire
+        ));
+        return old;
+    }
+
+    // Publish the `n` slots starting at `start` (as returned by allocate) after they are written.
+    // The committed watermark advances in order, so waits for all preceding slots to be committed.
+    // Returns false on timeout, which means a preceding writer stalled before committing. The slots
+    // are marked ready all the same: whoever commits the stalled slots carries the watermark past them.
+    bool commit(std::size_t start, std::size_t n,
+        std::chrono::nanoseconds timeout = std::chrono::seconds(5)) noexcept {
+        markReady(start, n);
+
+        Backoff backoff(timeout);
+        while (advance() < start + n) {
+            if (!backoff.next()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Convenience single-element push_back. Returns index or nullopt on overflow or chunk failure.
+    // Never waits for earlier writers: the element is published once the slots before it are,
+    // right away if they already are.
+    std::optional<std::size_t> push_back(const T& v) noexcept {
+        auto idx = allocate(1);
+        if (!idx) {
+            return std::nullopt;
+        }
+        *at(*idx) = v;
+        markReady(*idx, 1);
+        advance();
+        return idx;
+    }
+
+    // Returns nullptr if the chunk of `i` can not be mapped in this process
+    T* at(std::size_t i) noexcept {
+        assert(i < capacity() && "Index out of bounds");
+        assert(i < size());
+        Chunk* chunk = MapChunk(i / CHUNK_CAPACITY, false);
+        return chunk ? &chunk->data[i & (CHUNK_CAPACITY - 1)] : nullptr;
+    }
+
+    const T* at(std::size_t i) const noexcept {
+        return const_cast<ShmSegmentedVector*>(this)->at(i);
+    }
+
+    T& operator[](std::size_t i) noexcept {
+        return *at(i);
+    }
+
+    const T& operator[](std::size_t i) const noexcept {
+        return *at(i);
+    }
+
+    // Apply visitor to each committed element, chunk by chunk.
+    // Visitor returning bool stops the iteration on false. Returns the number of visited elements.
+    template<typename Visitor /* void|bool (idx, const T&) */>
+    std::size_t iterate_committed(Visitor&& visitor) const {
+        const std::size_t n = committed();
+        for (std::size_t i = 0; i < n; ) {
+            const Chunk* chunk = const_cast<ShmSegmentedVector*>(this)->MapChunk(i / CHUNK_CAPACITY, false);
+            if (!chunk) {
+                return i;
+            }
+            const std::size_t end = std::min(n, (i / CHUNK_CAPACITY + 1) * CHUNK_CAPACITY);
+            for (; i < end; ++i) {
+                if constexpr (std::is_same_v<std::invoke_result_t<Visitor, std::size_t, const T&>, bool>) {
+                    if (!visitor(i, chunk->data[i & (CHUNK_CAPACITY - 1)])) {
+                        return i + 1;
+                    }
+                } else {
+                    visitor(i, chunk->data[i & (CHUNK_CAPACITY - 1)]);
+                }
+            }
+        }
+        return n;
+    }
+
+private:
+    static constexpr uint32_t CHUNK_EMPTY    = 0;
+    static constexpr uint32_t CHUNK_BUILDING = 1;
+    static constexpr uint32_t CHUNK_READY    = 2;
+
+    // Zero-filled by ftruncate, so no slot of a new chunk is ready
+    struct Chunk {
+        T data[CHUNK_CAPACITY];
+        std::atomic<uint8_t> ready[CHUNK_CAPACITY]; // slot written, waits for the watermark
+    };
+
+    static constexpr std::size_t CHUNK_BYTES = sizeof(Chunk);
+
+    // Lives in shm, zero-filled by ftruncate is a valid empty state
+    struct Header {
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> size;
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> committed;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> chunks[MAX_CHUNKS];
+    };
+
+private:
+    ShmSegmentedVector() {
+        constexpr const char* path = SHM_PATH::value;
+
+        bool owner = false;
+        fd_ = ::shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0666);
+        if (fd_ >= 0) {
+            owner = true;
+            if (::ftruncate(fd_, static_cast<off_t>(sizeof(Header))) != 0) {
+                int e = errno;
+                ::close(fd_);
+                ::shm_unlink(path);
+                throw std::runtime_error("ftruncate failed: " + std::to_string(e));
+            }
+            SHMAP_DEBUG_LOG("ShmSegmentedVector construct %s!", path);
+        }
+        else if (errno == EEXIST) {
+            fd_ = ::shm_open(path, O_RDWR, 0666);
+            if (fd_ < 0) {
+                int e = errno;
+                throw std::runtime_error("shm_open O_RDWR failed: " + std::to_string(e));
+            }
+            SHMAP_DEBUG_LOG("ShmSegmentedVector open %s!", path);
+        }
+        else {
+            int e = errno;
+            throw std::runtime_error("shm_open failed: " + std::to_string(e));
+        }
+
+        void* addr = ::mmap(nullptr, sizeof(Header), PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (addr == MAP_FAILED) {
+            int e = errno;
+            ::close(fd_);
+            if (owner) ::shm_unlink(path);
+            throw std::runtime_error("mmap failed: " + std::to_string(e));
+        }
+        header_ = static_cast<Header*>(addr);
+    }
+
+    static std::string ChunkPath(std::size_t k) {
+        return std::string(SHM_PATH::value) + "." + std::to_string(k);
+    }
+
+    // Sequentially consistent with the loads in advance: of two writers marking neighbours
+    // at once, at least one sees both slots ready, so no slot is left behind unpublished
+    void markReady(std::size_t start, std::size_t n) noexcept {
+        assert(start + n <= size());
+        for (std::size_t i = start; i < start + n; ++i) {
+            auto& ready = MapChunk(i / CHUNK_CAPACITY, false)->ready[i & (CHUNK_CAPACITY - 1)];
+            assert(!ready.load(std::memory_order_relaxed) && "Slots committed twice");
+            ready.store(1, std::memory_order_seq_cst);
+        }
+    }
+
+    // Moves the watermark over the ready slots right after it, returns where it ends
+    std::size_t advance() noexcept {
+        std::size_t from = header_->committed.load(std::memory_order_acquire);
+        while (true) {
+            const std::size_t limit = header_->size.load(std::memory_order_acquire);
+            std::size_t to = from;
+            while (to < limit) {
+                const Chunk* chunk = MapChunk(to / CHUNK_CAPACITY, false);
+                if (!chunk || !chunk->ready[to & (CHUNK_CAPACITY - 1)].load(std::memory_order_seq_cst)) {
+                    break;
+                }
+                ++to;
+            }
+            if (to == from) {
+                return from;
+            }
+            if (header_->committed.compare_exchange_weak(from, to,
+                    std::memory_order_release, std::memory_order_acquire)) {
+                return to;
+            }
+        }
+    }
+
+    // Map chunk `k` into this process, creating it in shm first if `create` is set
+    Chunk* MapChunk(std::size_t k, bool create) noexcept {
+        Chunk* chunk = local_[k].load(std::memory_order_acquire);
+        if (chunk) {
+            return chunk;
+        }
+
+        uint32_t state = header_->chunks[k].load(std::memory_order_acquire);
+        if (state == CHUNK_EMPTY) {
+            if (!create) {
+                return nullptr;
+            }
+            if (header_->chunks[k].compare_exchange_strong(state, CHUNK_BUILDING,
+                    std::memory_order_acq_rel, std::memory_order_acquire)) {
+                if (!CreateChunk(k)) {
+                    header_->chunks[k].store(CHUNK_EMPTY, std::memory_order_release);
+                    return nullptr;
+                }
+                header_->chunks[k].store(CHUNK_READY, std::memory_order_release);
+                SHMAP_DEBUG_LOG("ShmSegmentedVector create chunk %zu!", k);
+            }
+        }
+
+        Backoff backoff(std::chrono::seconds(5));
+        while (header_->chunks[k].load(std::memory_order_acquire) != CHUNK_READY) {
+            if (!backoff.next()) {
+                return nullptr;
+            }
+        }
+
+        int fd = ::shm_open(ChunkPath(k).c_str(), O_RDWR, 0666);
+        if (fd < 0) {
+            return nullptr;
+        }
+        void* addr = ::mmap(nullptr, CHUNK_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            return nullptr;
+        }
+
+        // Another thread of this process may have mapped it concurrently
+        Chunk* expected = nullptr;
+        if (!local_[k].compare_exchange_strong(expected, static_cast<Chunk*>(addr),
+                std::memory_order_acq_rel, std::memory_order_acquire)) {
+            ::munmap(addr, CHUNK_BYTES);
+            return expected;
+        }
+        return static_cast<Chunk*>(addr);
+    }
+
+    // Only called by the process owning the BUILDING state of chunk `k`, so an
+    // object already at its path is left over from a crashed run: replace it
+    static bool CreateChunk(std::size_t k) noexcept {
+        const std::string path = ChunkPath(k);
+        int fd = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+        if (fd < 0 && errno == EEXIST) {
+            SHMAP_DEBUG_LOG("ShmSegmentedVector replace stale chunk %zu!", k);
+            ::shm_unlink(path.c_str());
+            fd = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+        }
+        if (fd < 0) {
+            return false;
+        }
+        bool ok = ::ftruncate(fd, static_cast<off_t>(CHUNK_BYTES)) == 0;
+        ::close(fd);
+        if (!ok) {
+            ::shm_unlink(path.c_str());
+        }
+        return ok;
+    }
+
+    void Close() {
+        for (auto& chunk : local_) {
+            Chunk* addr = chunk.exchange(nullptr, std::memory_order_acq_rel);
+            if (addr) {
+                ::munmap(addr, CHUNK_BYTES);
+            }
+        }
+        if (header_) {
+            ::munmap(header_, sizeof(Header));
+            header_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        SHMAP_DEBUG_LOG("ShmSegmentedVector close %s!", SHM_PATH::value);
+    }
+
+private:
+    int     fd_{-1};
+    Header* header_{nullptr};
+    std::array<std::atomic<Chunk*>, MAX_CHUNKS> local_{};
+};
+
+}
+
+#endif
@@ -0,0 +1,401 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef SHMAP_SHM_SNAPSHOT_H
+#define SHMAP_SHM_SNAPSHOT_H
+
+#include "shmap/shmap.h"
+#include "shmap/status.h"
+#include "shmap/backoff.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace shmap {
+
+/* -------------------------------------------------------------------------- */
+/*          SnapshotHeader – precedes the segment bytes in a snapshot file    */
+/* -------------------------------------------------------------------------- */
+// Every write stamped at or before the start versions is in the file, none stamped
+// after the end versions is. Replaying the changes in (start, end] from the change
+// log, or TravelChangedSince(versionStart), brings it to one point in time.
+struct SnapshotHeader {
+    static constexpr char     MAGIC[8] = {'S', 'H', 'M', 'S', 'N', 'A', 'P', '\0'};
+    static constexpr uint32_t VERSION  = 2;
+
+    char     magic[8];
+    uint32_t version;
+    uint32_t headerBytes;
+    uint64_t segmentBytes;
+    uint64_t versionStart;  // table Version(), 0 without VERSION_ENABLE
+    uint64_t versionEnd;
+    uint64_t logStart;      // change log Version(), 0 without a change log
+    uint64_t logEnd;
+};
+
+/* -------------------------------------------------------------------------- */
+/*          SnapshotVersions – where the table's writes were at one moment    */
+/* -------------------------------------------------------------------------- */
+struct SnapshotVersions {
+    uint64_t table{0};
+    uint64_t log{0};
+};
+
+struct NoSnapshotVersions {
+    SnapshotVersions operator()() const noexcept { return {}; }
+};
+
+/* -------------------------------------------------------------------------- */
+/*          SnapshotProgress – what the helper reports while it writes        */
+/* -------------------------------------------------------------------------- */
+struct SnapshotProgress {
+    uint64_t bytesTotal{0};
+    uint64_t bytesDone{0};
+    double   seconds{0.0};
+    bool     done{false};
+    Status   status{Status::NOT_READY};  // NOT_READY while running
+
+    double Fraction() const noexcept {
+        return bytesTotal ? static_cast<double>(bytesDone) / static_cast<double>(bytesTotal) : 0.0;
+    }
+
+    double MBps() const noexcept {
+        return seconds > 0.0 ? static_cast<double>(bytesDone) / seconds / (1 << 20) : 0.0;
+    }
+};
+
+namespace detail {
+    template<typename TABLE, typename = void>
+    struct HasCopyBytes : std::false_type {};
+
+    template<typename TABLE>
+    struct HasCopyBytes<TABLE, std::void_t<decltype(std::declval<const TABLE&>().CopyBytes(
+        std::size_t{}, std::size_t{}, std::declval<void*>()))>> : std::true_type {};
+
+    template<typename TABLE, typename = void>
+    struct HasVersion : std::false_type {};
+
+    template<typename TABLE>
+    struct HasVersion<TABLE, std::void_t<decltype(std::declval<const TABLE&>().Version())>> : std::true_type {};
+
+    template<typename TABLE, typename = void>
+    struct HasLogVersion : std::false_type {};
+
+    template<typename TABLE>
+    struct HasLogVersion<TABLE, std::void_t<decltype(std::declval<const TABLE&>().ChangeLog().Version())>>
+        : std::true_type {};
+
+    template<typename TABLE, typename = void>
+    struct HasRepairProbeChains : std::false_type {};
+
+    template<typename TABLE>
+    struct HasRepairProbeChains<TABLE, std::void_t<decltype(std::declval<TABLE&>().RepairProbeChains())>>
+        : std::true_type {};
+
+    template<typename TABLE>
+    SnapshotVersions VersionsOf(const TABLE& table) noexcept {
+        SnapshotVersions versions;
+        if constexpr (HasVersion<TABLE>::value) {
+            versions.table = table.Version();
+        }
+        if constexpr (HasLogVersion<TABLE>::value) {
+            versions.log = table.ChangeLog().Version();
+        }
+        return versions;
+    }
+
+    // Copies bytes [offset, offset + bytes) of a segment holding `table` at
+    // `tableOffset`. The table's part goes through TABLE::CopyBytes when it has
+    // one, so entries written concurrently are never copied half done.
+    template<typename TABLE>
+    Status CopySegment(const uint8_t* base, std::size_t tableOffset, const TABLE& table,
+        std::size_t offset, std::size_t bytes, uint8_t* dst) noexcept {
+        if constexpr (HasCopyBytes<TABLE>::value) {
+            const std::size_t end  = offset + bytes;
+            const std::size_t from = std::max(offset, tableOffset);
+            const std::size_t to   = std::min(end, tableOffset + sizeof(TABLE));
+            if (from < to) {
+                std::memcpy(dst, base + offset, from - offset);
+                Status status = table.CopyBytes(from - tableOffset, to - from, dst + (from - offset));
+                if (!status) return status;
+                std::memcpy(dst + (to - offset), base + to, end - to);
+                return Status::SUCCESS;
+            }
+        }
+        std::memcpy(dst, base + offset, bytes);
+        return Status::SUCCESS;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*          ShmSnapshot – a forked helper streaming a segment to disk         */
+/* -------------------------------------------------------------------------- */
+// The helper shares the segment with its parent, so it reads the live data in
+// chunks through a copy function, e.g. one holding each table bucket only for
+// its own memcpy, and the parent keeps serving meanwhile. Each entry is whole but
+// the file spans the copy: the header's versions tell which writes may be
+// missing. It is written to `<path>.tmp` and renamed once synced.
+class ShmSnapshot {
+public:
+    static constexpr std::size_t CHUNK_BYTES = 1 << 20;
+
+    // copy(offset, bytes, dst) -> Status fills dst with segment bytes [offset, offset + bytes),
+    // versions() -> SnapshotVersions is read before the first chunk and after the last one
+    template<typename COPY, typename VERSIONS = NoSnapshotVersions>
+    static ShmSnapshot Start(const std::string& path, std::size_t bytes, COPY&& copy,
+        std::size_t chunkBytes = CHUNK_BYTES, VERSIONS versions = VERSIONS{}) noexcept {
+        ShmSnapshot snap;
+        void* page = ::mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (page == MAP_FAILED) {
+            snap.result_ = Status::OUT_OF_MEMORY;
+            return snap;
+        }
+        snap.shared_ = new (page) Shared();
+        snap.shared_->bytesTotal.store(bytes, std::memory_order_relaxed);
+
+        // Allocate before fork what the helper needs. It runs the copy function, which may back
+        // off on held buckets: calibrate the clock here so the helper never runs the function
+        // static initializer, whose guard another parent thread may hold at fork time.
+        const std::string tmp = path + ".tmp";
+        chunkBytes = std::max<std::size_t>(chunkBytes, 1);
+        TscClock::Calibrate();
+
+        const pid_t pid = ::fork();
+        if (pid == 0) {
+            Status status = Write(path.c_str(), tmp.c_str(), bytes, copy, versions, chunkBytes, *snap.shared_);
+            snap.shared_->endNanos.store(NowNanos(), std::memory_order_relaxed);
+            snap.shared_->status.store(status.GetCode(), std::memory_order_release);
+            ::_exit(status ? 0 : 1);
+        }
+        if (pid < 0) {
+            snap.result_ = Status::ERROR;
+            snap.shared_->status.store(Status::ERROR, std::memory_order_release);
+            return snap;
+        }
+        snap.pid_ = pid;
+        return snap;
+    }
+
+    // Reads a snapshot file back into a segment of `bytes`, and its header into `header` if given
+    static Status Load(const std::string& path, void* segment, std::size_t bytes,
+        SnapshotHeader* header = nullptr) noexcept {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return errno == ENOENT ? Status::NOT_FOUND : Status::ERROR;
+        }
+        SnapshotHeader read{};
+        Status status = ReadAll(fd, &read, sizeof(read));
+        if (status && (std::memcmp(read.magic, SnapshotHeader::MAGIC, sizeof(read.magic)) != 0 ||
+                       read.version != SnapshotHeader::VERSION ||
+                       read.headerBytes != sizeof(SnapshotHeader) ||
+                       read.segmentBytes != bytes)) {
+            status = Status::INVALID_ARGUMENT;
+        }
+        if (status) {
+            status = ReadAll(fd, segment, bytes);
+        }
+        if (status && header) {
+            *header = read;
+        }
+        ::close(fd);
+        return status;
+    }
+
+    ShmSnapshot() = default;
+
+    ShmSnapshot(ShmSnapshot&& other) noexcept
+        : shared_{std::exchange(other.shared_, nullptr)},
+          pid_{std::exchange(other.pid_, -1)},
+          result_{other.result_} {}
+
+    ShmSnapshot& operator=(ShmSnapshot&& other) noexcept {
+        if (this != &other) {
+            Release();
+            shared_ = std::exchange(other.shared_, nullptr);
+            pid_    = std::exchange(other.pid_, -1);
+            result_ = other.result_;
+        }
+        return *this;
+    }
+
+    ShmSnapshot(const ShmSnapshot&)            = delete;
+    ShmSnapshot& operator=(const ShmSnapshot&) = delete;
+
+    // Waits for a helper still running
+    ~ShmSnapshot() {
+        Release();
+    }
+
+    pid_t Pid() const noexcept {
+        return pid_;
+    }
+
+    bool Running() const noexcept {
+        return pid_ > 0 && Progress().status == Status::NOT_READY;
+    }
+
+    SnapshotProgress Progress() const noexcept {
+        SnapshotProgress p;
+        if (!shared_) {
+            p.done   = true;
+            p.status = result_;
+            return p;
+        }
+        p.status     = Status(shared_->status.load(std::memory_order_acquire));
+        p.done       = p.status != Status::NOT_READY;
+        p.bytesTotal = shared_->bytesTotal.load(std::memory_order_relaxed);
+        p.bytesDone  = shared_->bytesDone.load(std::memory_order_relaxed);
+        const uint64_t start = shared_->startNanos.load(std::memory_order_relaxed);
+        const uint64_t end   = p.done ? shared_->endNanos.load(std::memory_order_relaxed) : NowNanos();
+        p.seconds = start && end > start ? static_cast<double>(end - start) / 1e9 : 0.0;
+        return p;
+    }
+
+    // Reaps the helper, CRASH if it died before finishing
+    Status Wait() noexcept {
+        if (pid_ > 0) {
+            int wstatus = 0;
+            while (::waitpid(pid_, &wstatus, 0) < 0 && errno == EINTR) {}
+            pid_ = -1;
+            result_ = Status(shared_->status.load(std::memory_order_acquire));
+            if (result_ == Status::NOT_READY) {
+                result_ = Status::CRASH;
+                shared_->status.store(result_.GetCode(), std::memory_order_release);
+            }
+        }
+        return result_;
+    }
+
+private:
+    struct Shared {
+        std::atomic<uint64_t> bytesTotal{0};
+        std::atomic<uint64_t> bytesDone{0};
+        std::atomic<uint64_t> startNanos{0};
+        std::atomic<uint64_t> endNanos{0};
+        std::atomic<uint32_t> status{Status::NOT_READY};
+    };
+
+    static uint64_t NowNanos() noexcept {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static Status WriteAll(int fd, const void* buf, std::size_t bytes) noexcept {
+        const auto* p = static_cast<const uint8_t*>(buf);
+        while (bytes) {
+            const ssize_t n = ::write(fd, p, bytes);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return Status::ERROR;
+            }
+            p += n;
+            bytes -= static_cast<std::size_t>(n);
+        }
+        return Status::SUCCESS;
+    }
+
+    static Status ReadAll(int fd, void* buf, std::size_t bytes) noexcept {
+        auto* p = static_cast<uint8_t*>(buf);
+        while (bytes) {
+            const ssize_t n = ::read(fd, p, bytes);
+            if (n < 0 && errno == EINTR) continue;
+            if (n == 0) return Status::INVALID_ARGUMENT; // truncated file
+            if (n < 0) return Status::ERROR;
+            p += n;
+            bytes -= static_cast<std::size_t>(n);
+        }
+        return Status::SUCCESS;
+    }
+
+    // Runs in the helper
+    template<typename COPY, typename VERSIONS>
+    static Status Write(const char* path, const char* tmp, std::size_t bytes, COPY& copy,
+        VERSIONS& versions, std::size_t chunkBytes, Shared& shared) noexcept {
+        shared.startNanos.store(NowNanos(), std::memory_order_relaxed);
+
+        const int fd = ::open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return Status::ERROR;
+        }
+        void* buf = ::mmap(nullptr, chunkBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buf == MAP_FAILED) {
+            ::close(fd);
+            ::unlink(tmp);
+            return Status::OUT_OF_MEMORY;
+        }
+
+        SnapshotHeader header{};
+        std::memcpy(header.magic, SnapshotHeader::MAGIC, sizeof(header.magic));
+        header.version      = SnapshotHeader::VERSION;
+        header.headerBytes  = sizeof(SnapshotHeader);
+        header.segmentBytes = bytes;
+        const SnapshotVersions start = versions();
+        header.versionStart = start.table;
+        header.logStart     = start.log;
+        Status status = WriteAll(fd, &header, sizeof(header));
+
+        for (std::size_t offset = 0; status && offset < bytes; ) {
+            const std::size_t n = std::min(chunkBytes, bytes - offset);
+            status = copy(offset, n, buf);
+            if (status) {
+                status = WriteAll(fd, buf, n);
+            }
+            offset += n;
+            shared.bytesDone.store(offset, std::memory_order_relaxed);
+        }
+        if (status) {
+            const SnapshotVersions end = versions();
+            header.versionEnd = end.table;
+            header.logEnd     = end.log;
+            if (::lseek(fd, 0, SEEK_SET) != 0) {
+                status = Status::ERROR;
+            } else {
+                status = WriteAll(fd, &header, sizeof(header));
+            }
+        }
+        if (status && ::fsync(fd) != 0) {
+            status = Status::ERROR;
+        }
+        ::munmap(buf, chunkBytes);
+        ::close(fd);
+        if (status && ::rename(tmp, path) != 0) {
+            status = Status::ERROR;
+        }
+        if (!status) {
+            ::unlink(tmp);
+        }
+        return status;
+    }
+
+    void Release() noexcept {
+        Wait();
+        if (shared_) {
+            ::munmap(shared_, sizeof(Shared));
+            shared_ = nullptr;
+        }
+    }
+
+private:
+    Shared* shared_{nullptr};
+    pid_t   pid_{-1};
+    Status  result_{Status::NOT_READY};
+};
+
+}
+
+#endif
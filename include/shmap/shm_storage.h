@@ -6,7 +6,10 @@
 #define SHMAP_SHM_STORAGE_H_
 
 #include "shmap/shmap.h"
+#include "shmap/backoff.h"
+#include "shmap/shm_snapshot.h"
 
+#include <cstring>
 #include <stdexcept>
 #include <string>
 #include <atomic>
@@ -35,6 +38,11 @@ struct ShmBlock {
         return sizeof(ShmBlock); 
     }
 
+    // Byte offset of the table in the block, i.e. in the shm segment
+    static constexpr std::size_t GetTableOffset() noexcept {
+        return offsetof(ShmBlock, table_);
+    }
+
     static ShmBlock* Create(void* mem) noexcept {
         auto* block = static_cast<ShmBlock*>(mem);
         uint32_t expectedState = UNINIT;
@@ -115,6 +123,34 @@ struct ShmStorage {
         }
     }
 
+    // Writes the segment to `path` from a forked helper while all processes keep
+    // using the table; poll the returned handle for progress, Wait() for the result
+    ShmSnapshot Snapshot(const std::string& path, std::size_t chunkBytes = ShmSnapshot::CHUNK_BYTES) const noexcept {
+        const auto* base  = static_cast<const uint8_t*>(addr_);
+        const TABLE* table = &**block_;
+        return ShmSnapshot::Start(path, memBytes_, [base, table](std::size_t offset, std::size_t bytes, void* dst) {
+            return detail::CopySegment(base, Block::GetTableOffset(), *table, offset, bytes, static_cast<uint8_t*>(dst));
+        }, chunkBytes, [table]() {
+            return detail::VersionsOf(*table);
+        });
+    }
+
+    // Loads a snapshot of this segment, only used in none parallel scenarios by owner.
+    // `header` receives the versions the snapshot spans, to replay the changes made meanwhile.
+    Status Restore(const std::string& path, SnapshotHeader* header = nullptr) noexcept {
+        if (!owner_) {
+            return Status::ERROR;
+        }
+        Status status = ShmSnapshot::Load(path, addr_, memBytes_, header);
+        if constexpr (detail::HasRepairProbeChains<TABLE>::value) {
+            // Buckets were copied one by one under inserts, relink the keys behind a hole
+            if (status) {
+                (**block_).RepairProbeChains();
+            }
+        }
+        return status;
+    }
+
 
     TABLE* operator->() noexcept  { return &(**block_); }
     TABLE& operator* () noexcept  { return  **block_; }
@@ -124,6 +160,8 @@ struct ShmStorage {
 private:
     ShmStorage() {
         constexpr const char* path = SHM_PATH::value;
+        // Calibrate the backoff clock here rather than in the first contended Visit
+        TscClock::Calibrate();
 
         fd_ = ::shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0666);
 
@@ -0,0 +1,106 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef SHMAP_SHM_STRING_INTERNER_H
+#define SHMAP_SHM_STRING_INTERNER_H
+
+#include "shmap/shmap.h"
+#include "shmap/status.h"
+#include "shmap/fixed_string.h"
+#include "shmap/shm_hash_table.h"
+#include "shmap/shm_vector.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string_view>
+
+namespace shmap {
+
+/* -------------------------------------------------------------------------- */
+/*          ShmStringInterner – stable 32-bit ids for strings in shm          */
+/* -------------------------------------------------------------------------- */
+// Ids are dense and assigned in interning order, the same string always gets the
+// same id in all processes. Other tables can then be keyed by the small id.
+template<std::size_t N, std::size_t CAPACITY,
+    typename HASH = std::hash<FixedString<N>>
+>
+struct ShmStringInterner {
+    static_assert(CAPACITY && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be power of two");
+    static_assert(CAPACITY <= std::numeric_limits<uint32_t>::max(), "Ids must fit in 32 bits");
+
+    using Key = FixedString<N>;
+
+    static constexpr uint32_t INVALID_ID = std::numeric_limits<uint32_t>::max();
+
+    static constexpr std::size_t capacity() noexcept {
+        return CAPACITY;
+    }
+
+    // Number of interned strings
+    std::size_t size() const noexcept {
+        return strings_.committed();
+    }
+
+    // Get the id of `str`, assigning the next one if it was never interned.
+    // Returns INVALID_ARGUMENT if `str` does not fit in N bytes, OUT_OF_MEMORY when full,
+    // TIMEOUT if an earlier id is still being written. A timed-out string gets no id:
+    // its slot is published once the earlier ones are, but no entry maps to it.
+    Status Intern(std::string_view str, uint32_t& id,
+        std::chrono::nanoseconds timeout = std::chrono::seconds(5)) noexcept {
+        if (str.size() > N) {
+            return Status::INVALID_ARGUMENT;
+        }
+        const Key key(str);
+        return ids_.Visit(key, AccessMode::CreateIfMiss,
+            [this, &key, &id, timeout](std::size_t, uint32_t& value, bool isNew) -> Status {
+                // Concurrent interning of the same string waits on the INSERTING bucket
+                if (isNew) {
+                    auto idx = strings_.allocate(1);
+                    if (!idx) {
+                        return Status::OUT_OF_MEMORY;
+                    }
+                    strings_[*idx] = key;
+                    // A failed visitor drops the new entry, so no id points at an unpublished slot
+                    if (!strings_.commit(*idx, 1, timeout)) {
+                        return Status::TIMEOUT;
+                    }
+                    value = static_cast<uint32_t>(*idx);
+                }
+                id = value;
+                return Status::SUCCESS;
+            }, timeout);
+    }
+
+    // Get the id of an already interned `str`, NOT_FOUND otherwise
+    Status Find(std::string_view str, uint32_t& id,
+        std::chrono::nanoseconds timeout = std::chrono::seconds(5)) noexcept {
+        if (str.size() > N) {
+            return Status::NOT_FOUND;
+        }
+        return ids_.Visit(Key(str), AccessMode::AccessExist,
+            [&id](std::size_t, uint32_t& value, bool) {
+                id = value;
+            }, timeout);
+    }
+
+    // Reverse lookup, nullptr if `id` was never assigned
+    const Key* Lookup(uint32_t id) const noexcept {
+        if (id >= strings_.committed()) {
+            return nullptr;
+        }
+        return strings_.begin() + id;
+    }
+
+private:
+    // Twice the buckets of ids keeps the probe chains short when full
+    ShmHashTable<Key, uint32_t, 2 * CAPACITY, HASH> ids_;
+    ShmVector<Key, CAPACITY> strings_;
+};
+
+}
+
+#endif
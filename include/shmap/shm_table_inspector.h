@@ -0,0 +1,493 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef SHMAP_SHM_TABLE_INSPECTOR_H
+#define SHMAP_SHM_TABLE_INSPECTOR_H
+
+#include "shmap/shmap.h"
+#include "shmap/fixed_string.h"
+#include "shmap/shm_hash_table.h"
+#include "shmap/shm_storage.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace shmap {
+
+/* -------------------------------------------------------------------------- */
+/*          ShmTableLayout – where a ShmHashTable lives in a segment          */
+/* -------------------------------------------------------------------------- */
+// How a key or value is printed, and hashed when the table uses std::hash
+enum class FieldFormat : uint8_t {
+    Unsigned,     // u: little endian unsigned integer of 1, 2, 4 or 8 bytes
+    Signed,       // i: signed integer
+    FixedString,  // s<N>: FixedString<N>, the length follows the N chars
+    Bytes,        // x: raw bytes, printed as hex
+};
+
+// The owner prints ShmTableLayout::OfStorage<TABLE>().ToString() once, and the tools
+// rebuild it with Parse():
+//   cap=65536,bucket=192,off=64,key=8+129:s128,value=144+8:u,hash=std
+struct ShmTableLayout {
+    using HashFn = std::size_t (*)(const void* key, const ShmTableLayout& layout);
+
+    std::size_t offset{0};      // bucket 0 in the mapping
+    std::size_t capacity{0};
+    uint32_t bucketSize{0};
+    uint32_t keyOffset{0};
+    uint32_t keySize{0};
+    uint32_t keyChars{0};       // N of a FixedString key
+    FieldFormat keyFormat{FieldFormat::Bytes};
+    uint32_t valueOffset{0};
+    uint32_t valueSize{0};
+    uint32_t valueChars{0};
+    FieldFormat valueFormat{FieldFormat::Bytes};
+    HashFn hash{nullptr};       // nullptr: home buckets, probe lengths and skew are unknown
+    bool stdHash{false};        // hash is std::hash, reproducible from the text form
+
+    // Layout of a table at `tableOffset` in the mapping
+    template<typename TABLE>
+    static ShmTableLayout Of(std::size_t tableOffset = 0) {
+        using KEY    = typename TABLE::KeyType;
+        using VALUE  = typename TABLE::ValueType;
+        using Bucket = typename TABLE::Bucket;
+
+        ShmTableLayout layout;
+        layout.offset      = tableOffset + TABLE::BucketsOffset();
+        layout.capacity    = TABLE::Capacity();
+        layout.bucketSize  = sizeof(Bucket);
+        layout.keyOffset   = offsetof(Bucket, key);
+        layout.keySize     = sizeof(KEY);
+        layout.valueOffset = offsetof(Bucket, value);
+        layout.valueSize   = sizeof(VALUE);
+        std::tie(layout.keyFormat, layout.keyChars)     = FormatOf<KEY>();
+        std::tie(layout.valueFormat, layout.valueChars) = FormatOf<VALUE>();
+
+        layout.stdHash = std::is_same_v<typename TABLE::Hasher, std::hash<KEY>>
+            && StdHashFor(layout.keyFormat, layout.keySize) != nullptr;
+        if (layout.stdHash) {
+            layout.hash = StdHashFor(layout.keyFormat, layout.keySize);
+        } else {
+            layout.hash = [](const void* key, const ShmTableLayout&) -> std::size_t {
+                return typename TABLE::Hasher{}(*static_cast<const KEY*>(key));
+            };
+        }
+        return layout;
+    }
+
+    // Layout of the table of a ShmStorage<TABLE, PATH> segment
+    template<typename TABLE>
+    static ShmTableLayout OfStorage() {
+        return Of<TABLE>(ShmBlock<TABLE>::GetTableOffset());
+    }
+
+    std::string ToString() const {
+        std::string s = "cap=" + std::to_string(capacity)
+            + ",bucket=" + std::to_string(bucketSize)
+            + ",off=" + std::to_string(offset)
+            + ",key=" + FieldToString(keyOffset, keySize, keyFormat, keyChars)
+            + ",value=" + FieldToString(valueOffset, valueSize, valueFormat, valueChars)
+            + ",hash=" + (stdHash ? "std" : "none");
+        return s;
+    }
+
+    static std::optional<ShmTableLayout> Parse(std::string_view text) {
+        ShmTableLayout layout;
+        bool hasCap = false, hasBucket = false, hasKey = false, hasValue = false;
+        while (!text.empty()) {
+            std::size_t comma = text.find(',');
+            std::string_view item = text.substr(0, comma);
+            text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+
+            std::size_t eq = item.find('=');
+            if (eq == std::string_view::npos) return std::nullopt;
+            std::string_view name = item.substr(0, eq);
+            std::string_view arg  = item.substr(eq + 1);
+
+            uint64_t n = 0;
+            if (name == "cap" && ParseNumber(arg, n) && n > 0) {
+                layout.capacity = n;
+                hasCap = true;
+            } else if (name == "bucket" && ParseNumber(arg, n) && n > 0) {
+                layout.bucketSize = static_cast<uint32_t>(n);
+                hasBucket = true;
+            } else if (name == "off" && ParseNumber(arg, n)) {
+                layout.offset = n;
+            } else if (name == "key" && ParseField(arg, layout.keyOffset, layout.keySize, layout.keyFormat, layout.keyChars)) {
+                hasKey = true;
+            } else if (name == "value" && ParseField(arg, layout.valueOffset, layout.valueSize, layout.valueFormat, layout.valueChars)) {
+                hasValue = true;
+            } else if (name == "hash" && (arg == "std" || arg == "none")) {
+                layout.stdHash = arg == "std";
+            } else {
+                return std::nullopt;
+            }
+        }
+        if (!hasCap || !hasBucket || !hasKey || !hasValue
+            || layout.keyOffset + layout.keySize > layout.bucketSize
+            || layout.valueOffset + layout.valueSize > layout.bucketSize) {
+            return std::nullopt;
+        }
+        if (layout.stdHash) {
+            layout.hash = StdHashFor(layout.keyFormat, layout.keySize);
+            if (!layout.hash) return std::nullopt;
+        }
+        return layout;
+    }
+
+    // Bytes the mapping must hold past `offset`
+    std::size_t Span() const noexcept {
+        return capacity * bucketSize;
+    }
+
+private:
+    template<typename T>
+    static std::pair<FieldFormat, uint32_t> FormatOf() {
+        if constexpr (detail::IsFixedString<T>::value) {
+            return {FieldFormat::FixedString, static_cast<uint32_t>(T::capacity())};
+        } else if constexpr (std::is_integral_v<T> && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)) {
+            return {std::is_signed_v<T> ? FieldFormat::Signed : FieldFormat::Unsigned, 0};
+        } else {
+            return {FieldFormat::Bytes, 0};
+        }
+    }
+
+    template<typename INT>
+    static std::size_t HashInteger(const void* key, const ShmTableLayout&) {
+        INT v;
+        std::memcpy(&v, key, sizeof(v));
+        return std::hash<INT>{}(v);
+    }
+
+    static std::size_t HashFixedString(const void* key, const ShmTableLayout& layout) {
+        return std::hash<std::string_view>{}(StringOf(key, layout.keyChars));
+    }
+
+    static HashFn StdHashFor(FieldFormat format, uint32_t size) {
+        switch (format) {
+        case FieldFormat::Unsigned:
+            return size == 1 ? HashInteger<uint8_t> : size == 2 ? HashInteger<uint16_t>
+                 : size == 4 ? HashInteger<uint32_t> : size == 8 ? HashInteger<uint64_t> : nullptr;
+        case FieldFormat::Signed:
+            return size == 1 ? HashInteger<int8_t> : size == 2 ? HashInteger<int16_t>
+                 : size == 4 ? HashInteger<int32_t> : size == 8 ? HashInteger<int64_t> : nullptr;
+        case FieldFormat::FixedString:
+            return HashFixedString;
+        default:
+            return nullptr;
+        }
+    }
+
+    static std::string FieldToString(uint32_t off, uint32_t size, FieldFormat format, uint32_t chars) {
+        std::string s = std::to_string(off) + "+" + std::to_string(size) + ":";
+        switch (format) {
+        case FieldFormat::Unsigned:    return s + "u";
+        case FieldFormat::Signed:      return s + "i";
+        case FieldFormat::FixedString: return s + "s" + std::to_string(chars);
+        default:                       return s + "x";
+        }
+    }
+
+    static bool ParseNumber(std::string_view s, uint64_t& out) {
+        if (s.empty()) return false;
+        out = 0;
+        for (char c : s) {
+            if (c < '0' || c > '9') return false;
+            out = out * 10 + static_cast<uint64_t>(c - '0');
+        }
+        return true;
+    }
+
+    // "<offset>+<size>:<u|i|x|sN>"
+    static bool ParseField(std::string_view s, uint32_t& off, uint32_t& size, FieldFormat& format, uint32_t& chars) {
+        std::size_t plus = s.find('+'), colon = s.find(':');
+        if (plus == std::string_view::npos || colon == std::string_view::npos || colon < plus) return false;
+        uint64_t o = 0, n = 0, c = 0;
+        if (!ParseNumber(s.substr(0, plus), o) || !ParseNumber(s.substr(plus + 1, colon - plus - 1), n) || n == 0) {
+            return false;
+        }
+        std::string_view f = s.substr(colon + 1);
+        if (f == "u" || f == "i") {
+            if (n != 1 && n != 2 && n != 4 && n != 8) return false;
+            format = f == "u" ? FieldFormat::Unsigned : FieldFormat::Signed;
+        } else if (f == "x") {
+            format = FieldFormat::Bytes;
+        } else if (f.size() > 1 && f[0] == 's' && ParseNumber(f.substr(1), c) && c > 0 && c + LengthBytes(c) <= n) {
+            format = FieldFormat::FixedString;
+        } else {
+            return false;
+        }
+        off = static_cast<uint32_t>(o);
+        size = static_cast<uint32_t>(n);
+        chars = static_cast<uint32_t>(c);
+        return true;
+    }
+
+public:
+    // Size of the FixedString<N> length field, see detail::FixedStringLength
+    static constexpr std::size_t LengthBytes(uint64_t chars) noexcept {
+        return chars <= UINT8_MAX ? 1 : chars <= UINT16_MAX ? 2 : 4;
+    }
+
+    // Used part of a FixedString<chars> stored at `field`
+    static std::string_view StringOf(const void* field, uint32_t chars) noexcept {
+        const auto* p = static_cast<const uint8_t*>(field);
+        uint32_t len = 0;
+        std::memcpy(&len, p + chars, LengthBytes(chars)); // little endian
+        return std::string_view(reinterpret_cast<const char*>(p), std::min(len, chars));
+    }
+};
+
+/* -------------------------------------------------------------------------- */
+/*          ShmTableReport – result of one inspection                         */
+/* -------------------------------------------------------------------------- */
+struct ShmTableReport {
+    std::size_t capacity{0};
+    std::size_t empty{0};
+    std::size_t ready{0};
+    std::size_t inserting{0};
+    std::size_t accessing{0};
+    std::size_t invalid{0};                 // unknown state value, likely a wrong layout
+
+    std::vector<uint64_t> clusters;         // [n]: runs of n consecutive non-empty buckets
+    std::vector<uint64_t> probes;           // [d]: keys stored d buckets after their home, needs a hash
+    std::vector<std::pair<std::size_t, uint32_t>> busy; // INSERTING/ACCESSING (bucket, state)
+    std::vector<uint64_t> regions;          // occupied buckets per equal slice of the table
+    std::vector<uint64_t> homes;            // keys hashed into each slice, needs a hash
+
+    double LoadFactor() const noexcept {
+        return capacity ? static_cast<double>(capacity - empty) / static_cast<double>(capacity) : 0;
+    }
+
+    double MeanProbe() const noexcept {
+        uint64_t n = 0, sum = 0;
+        for (std::size_t d = 0; d < probes.size(); ++d) {
+            n += probes[d];
+            sum += probes[d] * d;
+        }
+        return n ? static_cast<double>(sum) / static_cast<double>(n) : 0;
+    }
+
+    std::size_t MaxProbe() const noexcept {
+        return probes.empty() ? 0 : probes.size() - 1;
+    }
+
+    std::size_t MaxCluster() const noexcept {
+        return clusters.empty() ? 0 : clusters.size() - 1;
+    }
+
+    // Fullest slice over the average one, 1.0 is perfectly even
+    static double Skew(const std::vector<uint64_t>& slices) noexcept {
+        uint64_t total = 0, most = 0;
+        for (uint64_t v : slices) {
+            total += v;
+            most = std::max(most, v);
+        }
+        return total ? static_cast<double>(most) * slices.size() / static_cast<double>(total) : 0;
+    }
+};
+
+/* -------------------------------------------------------------------------- */
+/*          ShmTableInspector – read-only analysis of a mapped table          */
+/* -------------------------------------------------------------------------- */
+// Works on any mapping of the table (e.g. PROT_READ in shmap-inspect) while other
+// processes keep using it. Only READY buckets are decoded, values may still change
+// under the reader.
+struct ShmTableInspector {
+    ShmTableInspector(const void* mapping, std::size_t bytes, const ShmTableLayout& layout) noexcept
+        : base_(static_cast<const uint8_t*>(mapping)), layout_(layout) {
+        valid_ = layout.capacity > 0 && layout.bucketSize >= sizeof(uint32_t)
+            && layout.offset <= bytes && layout.Span() <= bytes - layout.offset;
+    }
+
+    // Inspect a table of this process
+    template<typename TABLE>
+    static ShmTableInspector Of(const TABLE& table) noexcept {
+        return ShmTableInspector(&table, sizeof(TABLE), ShmTableLayout::Of<TABLE>());
+    }
+
+    // False when the layout does not fit in the mapping
+    bool Valid() const noexcept {
+        return valid_;
+    }
+
+    const ShmTableLayout& Layout() const noexcept {
+        return layout_;
+    }
+
+    uint32_t StateOf(std::size_t idx) const noexcept {
+        return reinterpret_cast<const std::atomic<uint32_t>*>(BucketAt(idx))->load(std::memory_order_acquire);
+    }
+
+    const void* KeyOf(std::size_t idx) const noexcept {
+        return BucketAt(idx) + layout_.keyOffset;
+    }
+
+    const void* ValueOf(std::size_t idx) const noexcept {
+        return BucketAt(idx) + layout_.valueOffset;
+    }
+
+    ShmTableReport Inspect(std::size_t regionCount = 64) const {
+        ShmTableReport report;
+        if (!valid_) {
+            return report;
+        }
+        const std::size_t cap = layout_.capacity;
+        regionCount = std::max<std::size_t>(1, std::min(regionCount, cap));
+        report.capacity = cap;
+        report.regions.assign(regionCount, 0);
+        if (layout_.hash) {
+            report.homes.assign(regionCount, 0);
+        }
+
+        // States are read once, so clusters and counts agree with each other
+        std::vector<uint32_t> states(cap);
+        for (std::size_t i = 0; i < cap; ++i) {
+            states[i] = StateOf(i);
+            switch (states[i]) {
+            case States::EMPTY:     ++report.empty; continue;
+            case States::READY:     ++report.ready; break;
+            case States::INSERTING: ++report.inserting; report.busy.emplace_back(i, states[i]); break;
+            case States::ACCESSING: ++report.accessing; report.busy.emplace_back(i, states[i]); break;
+            default:                ++report.invalid; break;
+            }
+            ++report.regions[i * regionCount / cap];
+
+            // Keys of ACCESSING buckets are stable, INSERTING ones are not written yet
+            if (layout_.hash && (states[i] == States::READY || states[i] == States::ACCESSING)) {
+                const std::size_t home = layout_.hash(KeyOf(i), layout_) % cap;
+                const std::size_t distance = (i + cap - home) % cap;
+                if (report.probes.size() <= distance) report.probes.resize(distance + 1, 0);
+                ++report.probes[distance];
+                ++report.homes[home * regionCount / cap];
+            }
+        }
+
+        // Clusters wrap around the end, start right after an empty bucket
+        std::size_t start = 0;
+        while (start < cap && states[start] != States::EMPTY) ++start;
+        if (start == cap) {
+            report.clusters.assign(cap + 1, 0);
+            report.clusters[cap] = 1;
+            return report;
+        }
+        std::size_t run = 0;
+        for (std::size_t step = 1; step <= cap; ++step) {
+            const std::size_t i = (start + step) % cap;
+            if (states[i] != States::EMPTY) {
+                ++run;
+                continue;
+            }
+            if (run) {
+                if (report.clusters.size() <= run) report.clusters.resize(run + 1, 0);
+                ++report.clusters[run];
+                run = 0;
+            }
+        }
+        return report;
+    }
+
+    // Buckets busy in both reports with the same state, i.e. held for the whole interval
+    static std::vector<std::pair<std::size_t, uint32_t>> Stuck(const ShmTableReport& before, const ShmTableReport& after) {
+        std::vector<std::pair<std::size_t, uint32_t>> stuck;
+        std::set_intersection(before.busy.begin(), before.busy.end(),
+            after.busy.begin(), after.busy.end(), std::back_inserter(stuck));
+        return stuck;
+    }
+
+    // Call f(idx, key, value) for up to `limit` READY buckets
+    template<typename F /* void (std::size_t, const void* key, const void* value) */>
+    std::size_t Dump(F&& f, std::size_t limit = SIZE_MAX) const {
+        std::size_t n = 0;
+        for (std::size_t i = 0; valid_ && i < layout_.capacity && n < limit; ++i) {
+            if (StateOf(i) == States::READY) {
+                f(i, KeyOf(i), ValueOf(i));
+                ++n;
+            }
+        }
+        return n;
+    }
+
+    std::string FormatKey(std::size_t idx) const {
+        return Format(KeyOf(idx), layout_.keySize, layout_.keyFormat, layout_.keyChars);
+    }
+
+    std::string FormatValue(std::size_t idx) const {
+        return Format(ValueOf(idx), layout_.valueSize, layout_.valueFormat, layout_.valueChars);
+    }
+
+    static std::string Format(const void* field, uint32_t size, FieldFormat format, uint32_t chars,
+        std::size_t maxBytes = 32) {
+        const auto* p = static_cast<const uint8_t*>(field);
+        char buf[32];
+        switch (format) {
+        case FieldFormat::Unsigned: {
+            uint64_t v = 0;
+            std::memcpy(&v, p, size);
+            std::snprintf(buf, sizeof(buf), "%llu", static_cast<unsigned long long>(v));
+            return buf;
+        }
+        case FieldFormat::Signed: {
+            uint64_t raw = 0;
+            std::memcpy(&raw, p, size);
+            const unsigned shift = 64 - 8 * size;
+            const int64_t v = static_cast<int64_t>(raw << shift) >> shift;
+            std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(v));
+            return buf;
+        }
+        case FieldFormat::FixedString: {
+            std::string out = "\"";
+            for (char c : ShmTableLayout::StringOf(p, chars)) {
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                    out += c;
+                } else if (static_cast<unsigned char>(c) < 0x20 || static_cast<unsigned char>(c) >= 0x7f) {
+                    std::snprintf(buf, sizeof(buf), "\\x%02x", static_cast<unsigned char>(c));
+                    out += buf;
+                } else {
+                    out += c;
+                }
+            }
+            return out + "\"";
+        }
+        default: {
+            std::string out;
+            for (std::size_t i = 0; i < size && i < maxBytes; ++i) {
+                std::snprintf(buf, sizeof(buf), "%02x", p[i]);
+                out += buf;
+            }
+            return size > maxBytes ? out + "..." : out;
+        }
+        }
+    }
+
+private:
+    // State values are the same for every ShmBucket<KEY, VALUE>
+    using States = ShmBucket<char, char>;
+
+    const uint8_t* BucketAt(std::size_t idx) const noexcept {
+        return base_ + layout_.offset + idx * layout_.bucketSize;
+    }
+
+private:
+    const uint8_t* base_;
+    ShmTableLayout layout_;
+    bool valid_{false};
+};
+
+}
+
+#endif
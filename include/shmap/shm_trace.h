@@ -0,0 +1,492 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef SHMAP_SHM_TRACE_H
+#define SHMAP_SHM_TRACE_H
+
+#include "shmap/shmap.h"
+#include "shmap/backoff.h"
+#include "shmap/status.h"
+#include "shmap/tagged_index.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Compile the hot-path trace points in. When 0 the tables and rings use
+// NoTraceSpan, whose methods are empty and inline to nothing.
+#ifndef SHMAP_TRACE_ENABLE
+#define SHMAP_TRACE_ENABLE 0
+#endif
+
+// Every process writes to its own segment, `<prefix><pid>`
+#ifndef SHMAP_TRACE_PATH_PREFIX
+#define SHMAP_TRACE_PATH_PREFIX "/shmap_trace."
+#endif
+
+namespace shmap {
+
+/* -------------------------------------------------------------------------- */
+/*          TraceEvent – one sampled operation, 48 bytes                      */
+/* -------------------------------------------------------------------------- */
+enum class TraceOp : uint8_t {
+    None = 0,
+    TableVisit,
+    TableTravel,
+    RingPush,
+    TableVisitMulti,
+};
+
+inline const char* TraceOpName(TraceOp op) noexcept {
+    switch (op) {
+    case TraceOp::TableVisit:  return "TableVisit";
+    case TraceOp::TableTravel: return "TableTravel";
+    case TraceOp::RingPush:    return "RingPush";
+    case TraceOp::TableVisitMulti: return "TableVisitMulti";
+    default:                   return "None";
+    }
+}
+
+struct TraceEvent {
+    uint64_t start{0};        // TscClock ticks
+    uint64_t end{0};
+    uint64_t waitTicks{0};    // spent inside BACKOFF::next()
+    uint32_t tid{0};
+    uint32_t bucket{0};       // last bucket touched
+    uint32_t probes{0};       // buckets examined
+    uint32_t backoffSteps{0};
+    uint16_t casFailures{0};
+    TraceOp  op{TraceOp::None};
+    uint8_t  status{0};       // Status::Code
+    uint32_t reserved{0};
+};
+static_assert(sizeof(TraceEvent) == 48, "TraceEvent layout is read by shmap-trace");
+static_assert(std::is_trivially_copyable_v<TraceEvent>, "TraceEvent is copied in and out of shm");
+
+/* -------------------------------------------------------------------------- */
+/*          ShmTraceRing – lossy multi-writer event ring inside shm           */
+/* -------------------------------------------------------------------------- */
+// Writers claim a position with one fetch_add and overwrite the oldest event,
+// so tracing never blocks or fails. Each slot carries a SlotSequence that its
+// writer claims and readers check before and after copying the event.
+struct ShmTraceRing {
+    static constexpr uint64_t MAGIC   = 0x45434152544D4853ull; // "SHMTRACE"
+    static constexpr uint32_t VERSION = 2;
+    // Spins waiting for a writer a lap behind before dropping the event
+    static constexpr uint32_t CLAIM_SPINS = 64;
+
+    struct Header {
+        std::atomic<uint64_t> magic{0}; // stored last, a reader seeing it sees the rest
+        uint32_t version{0};
+        uint32_t capacity{0};     // power of two
+        uint32_t eventSize{0};
+        uint32_t pid{0};
+        uint32_t sampleEvery{0};  // at creation, for scaling counts back up
+        uint32_t reserved{0};
+        double   ticksPerNano{1.0};
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head{0};
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        SlotSequence seq;
+        SlotPayload<TraceEvent> event;
+    };
+
+    static constexpr std::size_t SizeOf(uint32_t capacity) noexcept {
+        return sizeof(Header) + static_cast<std::size_t>(capacity) * sizeof(Slot);
+    }
+
+    // `mem` holds SizeOf(capacity) zeroed bytes
+    static ShmTraceRing* Create(void* mem, uint32_t capacity, uint32_t pid, uint32_t sampleEvery) noexcept {
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+            return nullptr;
+        }
+        auto* ring = static_cast<ShmTraceRing*>(mem);
+        auto* h = new (&ring->header_) Header();
+        for (uint32_t i = 0; i < capacity; ++i) {
+            new (&ring->Slots()[i]) Slot();
+        }
+        h->capacity     = capacity;
+        h->eventSize    = sizeof(TraceEvent);
+        h->pid          = pid;
+        h->sampleEvery  = sampleEvery;
+        h->ticksPerNano = static_cast<double>(TscClock::FromNanos(std::chrono::seconds(1))) / 1e9;
+        h->version      = VERSION;
+        h->magic.store(MAGIC, std::memory_order_release);
+        return ring;
+    }
+
+    // A ring written by another process, null unless `bytes` covers a valid one
+    static const ShmTraceRing* At(const void* addr, std::size_t bytes) noexcept {
+        if (!addr || bytes < sizeof(Header)) {
+            return nullptr;
+        }
+        auto* ring = static_cast<const ShmTraceRing*>(addr);
+        const Header& h = ring->header_;
+        if (h.magic.load(std::memory_order_acquire) != MAGIC || h.version != VERSION || h.eventSize != sizeof(TraceEvent)) {
+            return nullptr;
+        }
+        if (h.capacity == 0 || (h.capacity & (h.capacity - 1)) != 0 || SizeOf(h.capacity) > bytes) {
+            return nullptr;
+        }
+        return ring;
+    }
+
+    void Append(const TraceEvent& e) noexcept {
+        const uint64_t pos = header_.head.fetch_add(1, std::memory_order_relaxed);
+        Slot& s = Slots()[pos & (header_.capacity - 1)];
+        if (!s.seq.Claim(pos, CLAIM_SPINS)) {
+            return;
+        }
+        s.event.Store(e);
+        s.seq.Publish(pos);
+    }
+
+    // The retained events, oldest first. Slots being rewritten are skipped.
+    std::vector<TraceEvent> Read() const {
+        const uint64_t head  = header_.head.load(std::memory_order_acquire);
+        const uint64_t first = head > header_.capacity ? head - header_.capacity : 0;
+        std::vector<TraceEvent> events;
+        events.reserve(static_cast<std::size_t>(head - first));
+        for (uint64_t pos = first; pos < head; ++pos) {
+            const Slot& s = Slots()[pos & (header_.capacity - 1)];
+            if (s.seq.Load() != SlotSequence::Published(pos)) {
+                continue;
+            }
+            TraceEvent e;
+            s.event.Load(e);
+            if (s.seq.Load(std::memory_order_relaxed) == SlotSequence::Published(pos)) {
+                events.push_back(e);
+            }
+        }
+        return events;
+    }
+
+    // Events appended since creation, including overwritten ones
+    uint64_t Written() const noexcept {
+        return header_.head.load(std::memory_order_acquire);
+    }
+
+    uint64_t Overwritten() const noexcept {
+        const uint64_t head = Written();
+        return head > header_.capacity ? head - header_.capacity : 0;
+    }
+
+    uint32_t Capacity()    const noexcept { return header_.capacity; }
+    uint32_t Pid()         const noexcept { return header_.pid; }
+    uint32_t SampleEvery() const noexcept { return header_.sampleEvery; }
+
+    double ToNanos(uint64_t ticks) const noexcept {
+        return static_cast<double>(ticks) / header_.ticksPerNano;
+    }
+
+private:
+    Slot* Slots() noexcept {
+        return reinterpret_cast<Slot*>(reinterpret_cast<uint8_t*>(this) + sizeof(Header));
+    }
+
+    const Slot* Slots() const noexcept {
+        return reinterpret_cast<const Slot*>(reinterpret_cast<const uint8_t*>(this) + sizeof(Header));
+    }
+
+    Header header_;
+};
+
+inline std::string TracePath(uint32_t pid) {
+    return SHMAP_TRACE_PATH_PREFIX + std::to_string(pid);
+}
+
+/* -------------------------------------------------------------------------- */
+/*          ShmTracer – the calling process's trace segment                   */
+/* -------------------------------------------------------------------------- */
+// Created on the first sampled event at TracePath(getpid()). A normal exit()
+// unlinks it; a crashed process, or one leaving by _exit(), keeps it so its
+// trace can still be exported. A forked child switches to a segment of its own
+// on its first event.
+//   SHMAP_TRACE_SAMPLE  record one operation in N per thread (default 64, 0 = off)
+//   SHMAP_TRACE_EVENTS  ring capacity, rounded up to a power of two (default 65536)
+//   SHMAP_TRACE_KEEP    1 keeps the segment after a normal exit too
+class ShmTracer {
+public:
+    static ShmTracer& Instance() noexcept {
+        static ShmTracer tracer;
+        return tracer;
+    }
+
+    // Adjustable at run time, threads pick a new value up within their current period
+    static std::atomic<uint32_t>& SampleEvery() noexcept {
+        static std::atomic<uint32_t> every{EnvOr("SHMAP_TRACE_SAMPLE", 64)};
+        return every;
+    }
+
+    void Record(const TraceEvent& e) noexcept {
+        if (epoch_.load(std::memory_order_acquire) != detail::ForkEpoch().load(std::memory_order_relaxed)) {
+            Reopen();
+        }
+        if (auto* ring = ring_.load(std::memory_order_acquire)) {
+            ring->Append(e);
+        }
+    }
+
+    // Null until the first event, or if the segment could not be created
+    const ShmTraceRing* Ring() const noexcept {
+        return ring_.load(std::memory_order_acquire);
+    }
+
+    // Remove this process's segment, events recorded later go to a new one. Like
+    // UnlinkAtExit only the name is removed: a thread inside Record may still append
+    // to the old ring, so its mapping is left until the process is gone.
+    void Unlink() noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ring_.exchange(nullptr, std::memory_order_acq_rel)) {
+            ::shm_unlink(TracePath(pid_).c_str());
+            epoch_.store(UINT32_MAX, std::memory_order_release);
+        }
+    }
+
+private:
+    ShmTracer() = default;
+
+    static uint32_t EnvOr(const char* name, uint32_t fallback) noexcept {
+        const char* v = std::getenv(name);
+        return v && *v ? static_cast<uint32_t>(std::strtoul(v, nullptr, 10)) : fallback;
+    }
+
+    // Only removes the name: threads still tracing keep a valid mapping until the
+    // process is gone. A child that never traced holds its parent's ring, not its own.
+    static void UnlinkAtExit() noexcept {
+        ShmTracer& tracer = Instance();
+        std::lock_guard<std::mutex> lock(tracer.mutex_);
+        if (tracer.ring_.load(std::memory_order_relaxed) && tracer.pid_ == static_cast<uint32_t>(::getpid())) {
+            ::shm_unlink(TracePath(tracer.pid_).c_str());
+        }
+    }
+
+    void Unmap() noexcept {
+        if (auto* ring = ring_.exchange(nullptr, std::memory_order_acq_rel)) {
+            ::munmap(ring, bytes_);
+        }
+        epoch_.store(UINT32_MAX, std::memory_order_release);
+    }
+
+    void Reopen() noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        detail::WatchForks();
+        const uint32_t epoch = detail::ForkEpoch().load(std::memory_order_relaxed);
+        if (epoch_.load(std::memory_order_relaxed) == epoch) {
+            return;
+        }
+        // Inherited from the parent: drop our copy of its mapping, keep its segment
+        Unmap();
+
+        uint32_t capacity = 1;
+        const uint32_t wanted = std::max<uint32_t>(EnvOr("SHMAP_TRACE_EVENTS", 65536), 1);
+        while (capacity < wanted && capacity < (1u << 30)) {
+            capacity <<= 1;
+        }
+        pid_   = static_cast<uint32_t>(::getpid());
+        bytes_ = ShmTraceRing::SizeOf(capacity);
+
+        const std::string path = TracePath(pid_);
+        int fd = ::shm_open(path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+        if (fd >= 0) {
+            void* mem = MAP_FAILED;
+            if (::ftruncate(fd, static_cast<off_t>(bytes_)) == 0) {
+                mem = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            ::close(fd);
+            if (mem != MAP_FAILED) {
+                ring_.store(ShmTraceRing::Create(mem, capacity, pid_, SampleEvery().load(std::memory_order_relaxed)),
+                    std::memory_order_release);
+                // Registered once, inherited by forked children
+                if (!atExit_ && EnvOr("SHMAP_TRACE_KEEP", 0) == 0) {
+                    atExit_ = std::atexit(&ShmTracer::UnlinkAtExit) == 0;
+                }
+            } else {
+                ::shm_unlink(path.c_str());
+            }
+        }
+        if (!ring_.load(std::memory_order_relaxed)) {
+            SHMAP_DEBUG_LOG("ShmTracer cannot create %s, events are dropped", path.c_str());
+        }
+        epoch_.store(epoch, std::memory_order_release);
+    }
+
+private:
+    std::mutex mutex_;
+    std::atomic<ShmTraceRing*> ring_{nullptr};
+    std::atomic<uint32_t> epoch_{UINT32_MAX};
+    std::size_t bytes_{0};
+    uint32_t pid_{0};
+    bool atExit_{false};
+};
+
+namespace detail {
+
+// One operation in SampleEvery() per thread, a decrement and a branch otherwise
+inline bool TraceSampled() noexcept {
+    thread_local uint32_t countdown = 1;
+    if (--countdown != 0) {
+        return false;
+    }
+    const uint32_t every = ShmTracer::SampleEvery().load(std::memory_order_relaxed);
+    countdown = every ? every : 4096; // re-check a disabled tracer now and then
+    return every != 0;
+}
+
+inline uint32_t TraceThreadId() noexcept {
+    thread_local uint32_t epoch = UINT32_MAX;
+    thread_local uint32_t tid   = 0;
+    const uint32_t current = ForkEpoch().load(std::memory_order_relaxed);
+    if (epoch != current) {
+        tid   = static_cast<uint32_t>(::syscall(SYS_gettid));
+        epoch = current;
+    }
+    return tid;
+}
+
+}
+
+/* -------------------------------------------------------------------------- */
+/*          Trace spans – the hooks placed in the hot paths                   */
+/* -------------------------------------------------------------------------- */
+// Default when SHMAP_TRACE_ENABLE is 0
+struct NoTraceSpan {
+    explicit NoTraceSpan(TraceOp) noexcept {}
+
+    void Probe(std::size_t) noexcept {}
+    void CasFailure() noexcept {}
+
+    template<typename BACKOFF>
+    bool Wait(BACKOFF& backoff) noexcept {
+        return backoff.next();
+    }
+
+    void End(uint32_t) noexcept {}
+};
+
+// Decides at construction whether this operation is sampled; unsampled spans
+// cost one branch per hook. Sampled ones read the clock around every wait.
+struct SampledTraceSpan {
+    explicit SampledTraceSpan(TraceOp op) noexcept
+        : sampled_(detail::TraceSampled()) {
+        if (sampled_) {
+            event_.op    = op;
+            event_.start = TscClock::Now();
+        }
+    }
+
+    bool Sampled() const noexcept {
+        return sampled_;
+    }
+
+    void Probe(std::size_t idx) noexcept {
+        if (sampled_) {
+            ++event_.probes;
+            event_.bucket = static_cast<uint32_t>(idx);
+        }
+    }
+
+    void CasFailure() noexcept {
+        if (sampled_ && event_.casFailures != UINT16_MAX) {
+            ++event_.casFailures;
+        }
+    }
+
+    template<typename BACKOFF>
+    bool Wait(BACKOFF& backoff) noexcept {
+        if (!sampled_) {
+            return backoff.next();
+        }
+        const uint64_t t0 = TscClock::Now();
+        const bool ok = backoff.next();
+        const uint64_t t1 = TscClock::Now();
+        event_.waitTicks += t1 > t0 ? t1 - t0 : 0; // a migration may read an earlier TSC
+        ++event_.backoffSteps;
+        return ok;
+    }
+
+    void End(uint32_t status) noexcept {
+        if (sampled_) {
+            event_.end    = TscClock::Now();
+            event_.status = static_cast<uint8_t>(status);
+            event_.tid    = detail::TraceThreadId();
+            ShmTracer::Instance().Record(event_);
+        }
+    }
+
+private:
+    bool sampled_;
+    TraceEvent event_{};
+};
+
+#if SHMAP_TRACE_ENABLE
+using TraceSpan = SampledTraceSpan;
+#else
+using TraceSpan = NoTraceSpan;
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*          Chrome trace export                                               */
+/* -------------------------------------------------------------------------- */
+// Writes the events of all rings as complete ("X") events in the Chrome trace
+// JSON format, which chrome://tracing and ui.perfetto.dev both load. Times are
+// in microseconds from the earliest event; TSC ticks are comparable across
+// processes on one host.
+inline void WriteChromeTrace(std::ostream& os, const std::vector<const ShmTraceRing*>& rings) {
+    std::vector<std::vector<TraceEvent>> events;
+    uint64_t origin = UINT64_MAX;
+    for (const auto* ring : rings) {
+        events.push_back(ring->Read());
+        for (const auto& e : events.back()) {
+            origin = std::min(origin, e.start);
+        }
+    }
+
+    char buf[512];
+    bool first = true;
+    auto emit = [&os, &first](const char* text) {
+        os << (first ? "\n" : ",\n") << text;
+        first = false;
+    };
+
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (std::size_t r = 0; r < rings.size(); ++r) {
+        const ShmTraceRing& ring = *rings[r];
+        std::snprintf(buf, sizeof(buf),
+            "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"shmap %u (1 in %u sampled)\"}}",
+            ring.Pid(), ring.Pid(), ring.SampleEvery());
+        emit(buf);
+        for (const auto& e : events[r]) {
+            const double ts   = ring.ToNanos(e.start - origin) / 1000.0;
+            const double dur  = ring.ToNanos(e.end >= e.start ? e.end - e.start : 0) / 1000.0;
+            const double wait = ring.ToNanos(e.waitTicks);
+            std::snprintf(buf, sizeof(buf),
+                "{\"name\":\"%s\",\"cat\":\"shmap\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%u,"
+                "\"args\":{\"status\":\"%s\",\"bucket\":%u,\"probes\":%u,\"cas_failures\":%u,"
+                "\"backoff_steps\":%u,\"wait_ns\":%.0f}}",
+                TraceOpName(e.op), ts, dur, ring.Pid(), e.tid, Status(static_cast<uint32_t>(e.status)).ToString().c_str(),
+                e.bucket, e.probes, e.casFailures, e.backoffSteps, wait);
+            emit(buf);
+        }
+    }
+    os << "\n]}\n";
+}
+
+}
+
+#endif
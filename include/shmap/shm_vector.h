@@ -6,11 +6,14 @@
 #define SHMAP_SHM_VECTOR_H
 
 #include "shmap/shmap.h"
+#include "shmap/backoff.h"
 
 #include <array>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <type_traits>
 
@@ -34,8 +37,24 @@ struct ShmVector {
         return size() == 0; 
     }
 
+    // Number of leading elements whose writes are complete and published.
+    std::size_t committed() const noexcept {
+        return committed_.load(std::memory_order_acquire);
+    }
+
     void clear() noexcept {
-        size_.store(0, std::memory_order_release);
+        truncate(0);
+    }
+
+    // Shrink to the first `n` elements.
+    // Only used in none parallel scenarios, e.g. after in-place dedup of a frozen vector
+    void truncate(std::size_t n) noexcept {
+        assert(n <= committed() && "Can not truncate beyond committed elements");
+        for (std::size_t i = n, end = size_.load(std::memory_order_relaxed); i < end; ++i) {
+            ready_[i].store(0, std::memory_order_relaxed);
+        }
+        committed_.store(n, std::memory_order_release);
+        size_.store(n, std::memory_order_release);
     }
 
     // Reserve `n` slots atomically. Returns starting index or nullopt on overflow.
@@ -53,16 +72,54 @@ struct ShmVector {
         return old;        
     }
 
+    // Publish the `n` slots starting at `start` (as returned by allocate) after they are written.
+    // The committed watermark advances in order, so waits for all preceding slots to be committed.
+    // Returns false on timeout, which means a preceding writer stalled before committing. The slots
+    // are marked ready all the same: whoever commits the stalled slots carries the watermark past them.
+    bool commit(std::size_t start, std::size_t n,
+        std::chrono::nanoseconds timeout = std::chrono::seconds(5)) noexcept {
+        markReady(start, n);
+
+        Backoff backoff(timeout);
+        while (advance() < start + n) {
+            if (!backoff.next()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     // Convenience single‐element push_back. Returns index or nullopt on overflow.
+    // Never waits for earlier writers: the element is published once the slots before it are,
+    // right away if they already are.
     std::optional<std::size_t> push_back(const T& v) noexcept {
         auto idx = allocate(1);
         if (!idx) {
             return std::nullopt;
         }
         data_[*idx] = v;
+        markReady(*idx, 1);
+        advance();
         return idx;
     }
 
+    // Apply visitor to each committed element, safe against concurrent push_back.
+    // Visitor returning bool stops the iteration on false. Returns the number of visited elements.
+    template<typename Visitor /* void|bool (idx, const T&) */>
+    std::size_t iterate_committed(Visitor&& visitor) const {
+        const std::size_t n = committed();
+        for (std::size_t i = 0; i < n; ++i) {
+            if constexpr (std::is_same_v<std::invoke_result_t<Visitor, std::size_t, const T&>, bool>) {
+                if (!visitor(i, data_[i])) {
+                    return i + 1;
+                }
+            } else {
+                visitor(i, data_[i]);
+            }
+        }
+        return n;
+    }
+
     T* at(std::size_t i) noexcept {
         assert(i < N && "Index out of bounds");
         assert(i < size_.load(std::memory_order_acquire));
@@ -83,15 +140,47 @@ struct ShmVector {
         return *at(i); 
     }
 
-    // Iterators
+    // Iterators over all allocated slots, including the ones not committed yet whose
+    // writes may be in flight. Use iterate_committed to see only published elements.
     T* begin() noexcept { return data_.begin(); }
     T* end() noexcept { return data_.begin() + size(); }
     const T* begin() const noexcept { return data_.begin(); }
     const T* end() const noexcept { return data_.begin() + size(); }
 
+private:
+    // Sequentially consistent with the loads in advance: of two writers marking neighbours
+    // at once, at least one sees both slots ready, so no slot is left behind unpublished
+    void markReady(std::size_t start, std::size_t n) noexcept {
+        assert(start + n <= size_.load(std::memory_order_acquire));
+        for (std::size_t i = start; i < start + n; ++i) {
+            assert(!ready_[i].load(std::memory_order_relaxed) && "Slots committed twice");
+            ready_[i].store(1, std::memory_order_seq_cst);
+        }
+    }
+
+    // Moves the watermark over the ready slots right after it, returns where it ends
+    std::size_t advance() noexcept {
+        std::size_t from = committed_.load(std::memory_order_acquire);
+        while (true) {
+            const std::size_t limit = size_.load(std::memory_order_acquire);
+            std::size_t to = from;
+            while (to < limit && ready_[to].load(std::memory_order_seq_cst)) {
+                ++to;
+            }
+            if (to == from) {
+                return from;
+            }
+            if (committed_.compare_exchange_weak(from, to, std::memory_order_release, std::memory_order_acquire)) {
+                return to;
+            }
+        }
+    }
+
 private:
     alignas(alignof(T)) std::array<T, N> data_;
+    std::array<std::atomic<uint8_t>, N> ready_{};  // slot written, waits for the watermark
     std::atomic<std::size_t> size_{0};
+    std::atomic<std::size_t> committed_{0};
 };
 
 }
@@ -0,0 +1,152 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef SHMAP_SHM_VECTOR_ALGORITHM_H
+#define SHMAP_SHM_VECTOR_ALGORITHM_H
+
+#include "shmap/shm_vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// In-place algorithms over the committed elements of a ShmVector.
+// All of them are only used on frozen vectors: no concurrent writers during the call.
+
+namespace shmap {
+
+namespace detail {
+    // Below this many elements per worker, threads cost more than they save
+    constexpr std::size_t PARALLEL_SORT_GRAIN = 1 << 14;
+
+    template<typename Fn>
+    void RunParallel(std::size_t tasks, Fn&& fn) {
+        if (tasks == 1) {
+            fn(0);
+            return;
+        }
+        std::vector<std::thread> workers;
+        workers.reserve(tasks - 1);
+        for (std::size_t t = 1; t < tasks; ++t) {
+            workers.emplace_back([&fn, t] { fn(t); });
+        }
+        fn(0);
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                     ParallelSort – chunked sort + parallel merge           */
+/* -------------------------------------------------------------------------- */
+template<typename T, std::size_t N, typename Compare = std::less<T>>
+void ParallelSort(ShmVector<T, N>& vec, std::size_t threads = std::thread::hardware_concurrency(),
+    Compare comp = Compare{}) {
+
+    T* data = vec.begin();
+    const std::size_t n = vec.committed();
+
+    std::size_t runs = std::max<std::size_t>(1, std::min(threads, n / detail::PARALLEL_SORT_GRAIN));
+    std::vector<std::size_t> bounds(runs + 1);
+    for (std::size_t r = 0; r <= runs; ++r) {
+        bounds[r] = n * r / runs;
+    }
+
+    detail::RunParallel(runs, [&](std::size_t r) {
+        std::sort(data + bounds[r], data + bounds[r + 1], comp);
+    });
+
+    // Merge neighbour runs pairwise, each level in parallel
+    for (std::size_t width = 1; width < runs; width *= 2) {
+        const std::size_t merges = (runs + 2 * width - 1) / (2 * width);
+        detail::RunParallel(merges, [&](std::size_t m) {
+            std::size_t lo  = 2 * width * m;
+            std::size_t mid = std::min(lo + width, runs);
+            std::size_t hi  = std::min(lo + 2 * width, runs);
+            if (mid < hi) {
+                std::inplace_merge(data + bounds[lo], data + bounds[mid], data + bounds[hi], comp);
+            }
+        });
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                     Unique – dedup sorted vector and shrink it             */
+/* -------------------------------------------------------------------------- */
+// Returns the number of remaining elements
+template<typename T, std::size_t N, typename Equal = std::equal_to<T>>
+std::size_t Unique(ShmVector<T, N>& vec, Equal eq = Equal{}) {
+    T* data = vec.begin();
+    T* last = std::unique(data, data + vec.committed(), eq);
+    vec.truncate(static_cast<std::size_t>(last - data));
+    return vec.size();
+}
+
+/* -------------------------------------------------------------------------- */
+/*                     LowerBound – binary search on sorted vector            */
+/* -------------------------------------------------------------------------- */
+// Returns index of the first element not less than key, or committed() if none
+template<typename T, std::size_t N, typename Compare = std::less<T>>
+std::size_t LowerBound(const ShmVector<T, N>& vec, const T& key, Compare comp = Compare{}) {
+    const T* data = vec.begin();
+    return static_cast<std::size_t>(std::lower_bound(data, data + vec.committed(), key, comp) - data);
+}
+
+/* -------------------------------------------------------------------------- */
+/*             Eytzinger layout – cache friendly search on frozen data        */
+/* -------------------------------------------------------------------------- */
+// Lay out sorted `src` in BFS order into empty `dst`; node k (1-based) lives in dst[k - 1].
+// Returns false if `dst` is not empty.
+template<typename T, std::size_t N, std::size_t M>
+bool BuildEytzinger(const ShmVector<T, N>& src, ShmVector<T, M>& dst) {
+    static_assert(M >= N, "Destination must hold all source elements");
+
+    const std::size_t n = src.committed();
+    if (!dst.empty()) {
+        return false;
+    }
+    auto off = dst.allocate(n);
+    if (!off) {
+        return false;
+    }
+
+    const T* in = src.begin();
+    T* out = dst.begin();
+    std::size_t i = 0;
+
+    // Iterative in-order walk of the implicit tree
+    std::size_t k = 1;
+    while (i < n) {
+        while (k <= n) {
+            k = 2 * k;
+        }
+        k >>= __builtin_ffsll(~k);
+        out[k - 1] = in[i++];
+        k = 2 * k + 1;
+    }
+    return dst.commit(*off, n);
+}
+
+// Returns dst index of the first element not less than key, or committed() if none.
+template<typename T, std::size_t N, typename Compare = std::less<T>>
+std::size_t EytzingerLowerBound(const ShmVector<T, N>& layout, const T& key, Compare comp = Compare{}) {
+    const T* data = layout.begin();
+    const std::size_t n = layout.committed();
+
+    std::size_t k = 1;
+    while (k <= n) {
+        // Prefetch the 16 descendants four levels down, one cache line for small T
+        __builtin_prefetch(data + std::min(16 * k, n) - 1);
+        k = 2 * k + comp(data[k - 1], key);
+    }
+    k >>= __builtin_ffsll(~k);
+    return k == 0 ? n : k - 1;
+}
+
+}
+
+#endif
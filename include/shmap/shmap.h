@@ -5,11 +5,14 @@
 #ifndef SHMAP_SHMAP_H
 #define SHMAP_SHMAP_H
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <new>
 
+#include <pthread.h>
+
 namespace shmap {
 
 #if __cpp_lib_hardware_interference_size >= 201603
@@ -29,6 +32,24 @@ namespace shmap {
     #define SHMAP_DEBUG_LOG(FMT, ...)
 #endif
 
+namespace detail {
+
+// Bumped in the child after every fork, so per-process caches (shard hints,
+// trace segments, thread ids) notice they were inherited from the parent.
+inline std::atomic<uint32_t>& ForkEpoch() noexcept {
+    static std::atomic<uint32_t> epoch{0};
+    return epoch;
+}
+
+// Call once from the slow path of anything keyed on ForkEpoch()
+inline void WatchForks() noexcept {
+    static const bool registered = pthread_atfork(nullptr, nullptr,
+        [] { ForkEpoch().fetch_add(1, std::memory_order_relaxed); }) == 0;
+    (void)registered;
+}
+
+}
+
 }
 
 #endif
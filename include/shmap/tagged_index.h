@@ -0,0 +1,304 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+#ifndef SHMAP_TAGGED_INDEX_H
+#define SHMAP_TAGGED_INDEX_H
+
+#include "shmap/bits_integer.h"
+#include "shmap/atomic_bits_integer.h"
+#include "shmap/backoff.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Generation-tagged indices for ABA-safe lock-free structures in shm.
+// Pointers differ between processes mapping the same segment, indices do not;
+// the tag is bumped on every successful CAS so a recycled index never compares
+// equal to a stale snapshot of the same slot.
+// Rings addressed by a 64-bit position that only grows need no separate tag:
+// the position never wraps, so it is the generation. Their slots carry it in a
+// SlotSequence.
+
+namespace shmap {
+
+enum class TaggedIndexField {
+    Index,
+    Tag,
+};
+
+/* -------------------------------------------------------------------------- */
+/*          TaggedIndex – index + generation tag packed in one word           */
+/* -------------------------------------------------------------------------- */
+template<std::size_t INDEX_BITS, std::size_t TAG_BITS>
+struct TaggedIndex {
+    static_assert(INDEX_BITS > 0 && TAG_BITS > 0, "Index and tag must not be empty");
+    static_assert(INDEX_BITS + TAG_BITS <= 64, "Use WideTaggedIndex beyond 64 bits");
+
+    using UnderlyingType = std::conditional_t<(INDEX_BITS + TAG_BITS <= 32), uint32_t, uint64_t>;
+    using Bits = BitsInteger<UnderlyingType,
+        BitField<TaggedIndexField::Index, 0, INDEX_BITS>,
+        BitField<TaggedIndexField::Tag, INDEX_BITS, TAG_BITS>
+    >;
+    using Atomic = AtomicBitsInteger<UnderlyingType,
+        BitField<TaggedIndexField::Index, 0, INDEX_BITS>,
+        BitField<TaggedIndexField::Tag, INDEX_BITS, TAG_BITS>
+    >;
+
+    // Largest index is reserved as "no index", e.g. the end of a list
+    static constexpr UnderlyingType NIL = BitField<TaggedIndexField::Index, 0, INDEX_BITS>
+        ::template MaxValue<UnderlyingType>();
+    static constexpr UnderlyingType MAX_TAG = BitField<TaggedIndexField::Tag, INDEX_BITS, TAG_BITS>
+        ::template MaxValue<UnderlyingType>();
+
+    static constexpr TaggedIndex Nil(UnderlyingType tag = 0) noexcept {
+        return TaggedIndex(NIL, tag);
+    }
+
+    constexpr TaggedIndex() noexcept = default;
+
+    constexpr TaggedIndex(UnderlyingType index, UnderlyingType tag) noexcept
+    : bits_(BitsOf(index, tag)) {}
+
+    constexpr TaggedIndex(Bits bits) noexcept
+    : bits_(bits) {}
+
+    constexpr UnderlyingType Index() const noexcept {
+        return bits_.template Get<TaggedIndexField::Index>();
+    }
+
+    constexpr UnderlyingType Tag() const noexcept {
+        return bits_.template Get<TaggedIndexField::Tag>();
+    }
+
+    constexpr bool IsNil() const noexcept {
+        return Index() == NIL;
+    }
+
+    // Same slot of the next generation, or another slot with the tag bumped
+    constexpr TaggedIndex Next(UnderlyingType index) const noexcept {
+        return TaggedIndex(index, (Tag() + 1) & MAX_TAG);
+    }
+
+    constexpr Bits GetBits() const noexcept {
+        return bits_;
+    }
+
+    friend constexpr bool operator==(const TaggedIndex& lhs, const TaggedIndex& rhs) noexcept {
+        return lhs.bits_ == rhs.bits_;
+    }
+
+    friend constexpr bool operator!=(const TaggedIndex& lhs, const TaggedIndex& rhs) noexcept {
+        return lhs.bits_ != rhs.bits_;
+    }
+
+private:
+    static constexpr Bits BitsOf(UnderlyingType index, UnderlyingType tag) noexcept {
+        return Bits(((tag & MAX_TAG) << INDEX_BITS) | (index & NIL));
+    }
+
+private:
+    Bits bits_{};
+};
+
+/* -------------------------------------------------------------------------- */
+/*          AtomicTaggedIndex – single word CAS on a TaggedIndex              */
+/* -------------------------------------------------------------------------- */
+template<std::size_t INDEX_BITS, std::size_t TAG_BITS>
+struct AtomicTaggedIndex {
+    using Value = TaggedIndex<INDEX_BITS, TAG_BITS>;
+
+    constexpr AtomicTaggedIndex() noexcept = default;
+
+    explicit constexpr AtomicTaggedIndex(Value value) noexcept
+    : word_(value.GetBits()) {}
+
+    Value Load(std::memory_order order = std::memory_order_acquire) const noexcept {
+        return Value(word_.Load(order));
+    }
+
+    void Store(Value value, std::memory_order order = std::memory_order_release) noexcept {
+        word_.Store(value.GetBits(), order);
+    }
+
+    // On failure `expected` is updated with the current value
+    bool CompareExchange(Value& expected, Value desired) noexcept {
+        auto bits = expected.GetBits();
+        bool ok = word_.CompareExchange(bits, desired.GetBits());
+        expected = Value(bits);
+        return ok;
+    }
+
+private:
+    typename Value::Atomic word_;
+};
+
+/* -------------------------------------------------------------------------- */
+/*          WideTaggedIndex – 64-bit index + 64-bit tag, double-width CAS     */
+/* -------------------------------------------------------------------------- */
+struct alignas(16) WideTaggedIndex {
+    uint64_t index{0};
+    uint64_t tag{0};
+
+    constexpr WideTaggedIndex Next(uint64_t newIndex) const noexcept {
+        return WideTaggedIndex{newIndex, tag + 1};
+    }
+
+    friend constexpr bool operator==(const WideTaggedIndex& lhs, const WideTaggedIndex& rhs) noexcept {
+        return lhs.index == rhs.index && lhs.tag == rhs.tag;
+    }
+
+    friend constexpr bool operator!=(const WideTaggedIndex& lhs, const WideTaggedIndex& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+};
+
+// 128-bit compare-and-swap, `expected` is updated with the current value on failure.
+// Uses cmpxchg16b on x86-64; other targets rely on the compiler's 16-byte atomics,
+// which may call into libatomic: link it (-latomic) there, as the CMake build does.
+// Either way the target is written even when the compare fails, so it must sit in
+// writable memory.
+inline bool DoubleWordCompareExchange(WideTaggedIndex* target, WideTaggedIndex& expected,
+    WideTaggedIndex desired) noexcept {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    bool ok;
+    __asm__ __volatile__(
+        "lock cmpxchg16b %1"
+        : "=@ccz"(ok), "+m"(*target), "+a"(expected.index), "+d"(expected.tag)
+        : "b"(desired.index), "c"(desired.tag)
+        : "memory");
+    return ok;
+#else
+    return __atomic_compare_exchange(target, &expected, &desired, false,
+        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+}
+
+struct AtomicWideTaggedIndex {
+    constexpr AtomicWideTaggedIndex() noexcept = default;
+
+    explicit constexpr AtomicWideTaggedIndex(WideTaggedIndex value) noexcept
+    : value_(value) {}
+
+    AtomicWideTaggedIndex(const AtomicWideTaggedIndex&) = delete;
+    AtomicWideTaggedIndex& operator=(const AtomicWideTaggedIndex&) = delete;
+
+    // Atomic 16-byte read done by a CAS which never changes the value. The CAS still
+    // writes the line, so it is not const and faults on a PROT_READ mapping.
+    WideTaggedIndex Load() noexcept {
+        WideTaggedIndex current{};
+        DoubleWordCompareExchange(&value_, current, current);
+        return current;
+    }
+
+    void Store(WideTaggedIndex value) noexcept {
+        WideTaggedIndex current = Load();
+        while (!DoubleWordCompareExchange(&value_, current, value)) {}
+    }
+
+    bool CompareExchange(WideTaggedIndex& expected, WideTaggedIndex desired) noexcept {
+        return DoubleWordCompareExchange(&value_, expected, desired);
+    }
+
+private:
+    WideTaggedIndex value_{};
+};
+
+/* -------------------------------------------------------------------------- */
+/*          SlotSequence – generation of a ring slot written by position      */
+/* -------------------------------------------------------------------------- */
+// Odd while the writer of one position fills the slot, even once published.
+// Writers claim it with a CAS, so two of them a lap apart never fill it at once,
+// and readers check it before and after copying the slot, seqlock style.
+struct SlotSequence {
+    static constexpr uint64_t Writing(uint64_t pos) noexcept {
+        return 2 * pos + 1;
+    }
+
+    static constexpr uint64_t Published(uint64_t pos) noexcept {
+        return 2 * pos + 2;
+    }
+
+    uint64_t Load(std::memory_order order = std::memory_order_acquire) const noexcept {
+        return seq_.load(order);
+    }
+
+    // Takes the slot for the writer of `pos`. A payload stored through SlotPayload
+    // is ordered after the claim, so a reader seeing any of it sees the slot taken.
+    // Fails if a writer a lap ahead took it, the slot is overwritten anyway, or if
+    // one a lap behind is still filling it after `spins`.
+    bool Claim(uint64_t pos, uint32_t spins) noexcept {
+        const uint64_t writing = Writing(pos);
+        uint64_t seq = seq_.load(std::memory_order_relaxed);
+        while (true) {
+            if (seq >= writing) {
+                return false;
+            }
+            if (seq & 1) {
+                if (spins-- == 0) {
+                    return false;
+                }
+                detail::CpuRelax();
+                seq = seq_.load(std::memory_order_relaxed);
+                continue;
+            }
+            // Acquire the previous writer's slot before overwriting it
+            if (seq_.compare_exchange_weak(seq, writing, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+
+    void Publish(uint64_t pos) noexcept {
+        seq_.store(Published(pos), std::memory_order_release);
+    }
+
+    // Only used in none parallel scenarios
+    void Reset() noexcept {
+        seq_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> seq_{0};
+};
+
+/* -------------------------------------------------------------------------- */
+/*          SlotPayload – the value of a SlotSequence slot, as atomic words   */
+/* -------------------------------------------------------------------------- */
+// Stored word by word with release, so no word is seen before the writer's claim,
+// and loaded with acquire, so the reader's second sequence check comes after all
+// of them. The seqlock then needs no standalone fence, and a copy racing a writer
+// reads atomics only: torn, but caught by the sequence check.
+template<typename T>
+struct SlotPayload {
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+    static constexpr std::size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    void Store(const T& value) noexcept {
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &value, sizeof(T));
+        for (std::size_t i = 0; i < WORDS; ++i) {
+            words_[i].store(words[i], std::memory_order_release);
+        }
+    }
+
+    void Load(T& value) const noexcept {
+        uint64_t words[WORDS];
+        for (std::size_t i = 0; i < WORDS; ++i) {
+            words[i] = words_[i].load(std::memory_order_acquire);
+        }
+        std::memcpy(&value, words, sizeof(T));
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, WORDS> words_{};
+};
+
+}
+
+#endif
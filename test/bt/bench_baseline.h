@@ -0,0 +1,239 @@
+#ifndef SHMAP_BENCH_BASELINE_H
+#define SHMAP_BENCH_BASELINE_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+#include <pthread.h>
+
+#include <benchmark/benchmark.h>
+
+#include "shmap/shm_hash_table.h"
+#include "shmap/status.h"
+
+// Lock based structures the shmap ones are compared against. Both use
+// PTHREAD_PROCESS_SHARED primitives so they work in shm across processes too.
+
+namespace bench {
+
+// RAII lock of a process shared mutex
+struct PthreadLock {
+    explicit PthreadLock(pthread_mutex_t& mutex) : mutex_(mutex) {
+        pthread_mutex_lock(&mutex_);
+    }
+    ~PthreadLock() {
+        pthread_mutex_unlock(&mutex_);
+    }
+    PthreadLock(const PthreadLock&) = delete;
+    PthreadLock& operator=(const PthreadLock&) = delete;
+
+private:
+    pthread_mutex_t& mutex_;
+};
+
+inline void InitSharedMutex(pthread_mutex_t& mutex) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+/* -------------------------------------------------------------------------- */
+/*          MutexHashMap – open addressing map behind one shared mutex        */
+/* -------------------------------------------------------------------------- */
+// Same Visit/Travel shape as ShmHashTable so the benchmarks run unchanged.
+template<typename KEY, typename VALUE, std::size_t CAPACITY,
+    typename HASH  = std::hash<KEY>,
+    typename EQUAL = std::equal_to<KEY>
+>
+struct MutexHashMap {
+    MutexHashMap() {
+        InitSharedMutex(mutex_);
+    }
+
+    template<typename Visitor /* void|Status (idx, VALUE&, bool isNew) */>
+    shmap::Status Visit(const KEY& key, shmap::AccessMode mode, Visitor&& visitor,
+        std::chrono::nanoseconds = std::chrono::seconds(5)) noexcept {
+        PthreadLock lock(mutex_);
+        const std::size_t idx = HASH{}(key) % CAPACITY;
+        for (std::size_t probe = 0; probe < CAPACITY; ++probe) {
+            const std::size_t i = (idx + probe) % CAPACITY;
+            Slot& slot = slots_[i];
+            if (slot.used) {
+                if (!EQUAL{}(slot.key, key)) continue;
+                return Apply(visitor, i, slot.value, false);
+            }
+            if (mode == shmap::AccessMode::AccessExist) {
+                return shmap::Status::NOT_FOUND;
+            }
+            shmap::Status status = Apply(visitor, i, slot.value, true);
+            if (status) {
+                slot.key = key;
+                slot.used = true;
+            }
+            return status;
+        }
+        return shmap::Status::NOT_FOUND;
+    }
+
+    template<typename Visitor /* void (idx, const KEY&, VALUE&) */>
+    shmap::Status Travel(Visitor&& visitor,
+        std::chrono::nanoseconds = std::chrono::seconds(5)) noexcept {
+        PthreadLock lock(mutex_);
+        for (std::size_t i = 0; i < CAPACITY; ++i) {
+            if (slots_[i].used) {
+                visitor(i, static_cast<const KEY&>(slots_[i].key), slots_[i].value);
+            }
+        }
+        return shmap::Status::SUCCESS;
+    }
+
+private:
+    template<typename Visitor>
+    static shmap::Status Apply(Visitor& visitor, std::size_t idx, VALUE& value, bool isNew) {
+        if constexpr (std::is_void_v<std::invoke_result_t<Visitor&, std::size_t, VALUE&, bool>>) {
+            visitor(idx, value, isNew);
+            return shmap::Status::SUCCESS;
+        } else {
+            return visitor(idx, value, isNew);
+        }
+    }
+
+    struct Slot {
+        bool  used{false};
+        KEY   key;
+        VALUE value;
+    };
+
+private:
+    pthread_mutex_t mutex_;
+    std::array<Slot, CAPACITY> slots_{};
+};
+
+/* -------------------------------------------------------------------------- */
+/*          MutexCondQueue – bounded queue with mutex and condition variables */
+/* -------------------------------------------------------------------------- */
+template<typename T, std::size_t N>
+struct MutexCondQueue {
+    MutexCondQueue() {
+        InitSharedMutex(mutex_);
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&notEmpty_, &attr);
+        pthread_condattr_destroy(&attr);
+    }
+
+    bool push(const T& v) noexcept {
+        PthreadLock lock(mutex_);
+        if (tail_ - head_ >= N) {
+            return false;
+        }
+        data_[tail_++ % N] = v;
+        pthread_cond_signal(&notEmpty_);
+        return true;
+    }
+
+    std::optional<T> pop() noexcept {
+        PthreadLock lock(mutex_);
+        return PopLocked();
+    }
+
+    // Block on the condition variable until an element arrives or `timeout` passes
+    std::optional<T> pop_wait(std::chrono::nanoseconds timeout) noexcept {
+        timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        int64_t ns = deadline.tv_nsec + timeout.count();
+        deadline.tv_sec += ns / 1'000'000'000;
+        deadline.tv_nsec = ns % 1'000'000'000;
+
+        PthreadLock lock(mutex_);
+        while (head_ == tail_) {
+            if (pthread_cond_timedwait(&notEmpty_, &mutex_, &deadline) != 0) {
+                break;
+            }
+        }
+        return PopLocked();
+    }
+
+private:
+    std::optional<T> PopLocked() noexcept {
+        if (head_ == tail_) {
+            return std::nullopt;
+        }
+        return data_[head_++ % N];
+    }
+
+private:
+    pthread_mutex_t mutex_;
+    pthread_cond_t notEmpty_;
+    std::size_t head_{0};
+    std::size_t tail_{0};
+    std::array<T, N> data_;
+};
+
+template<typename T>
+struct IsBaseline : std::false_type {};
+
+template<typename KEY, typename VALUE, std::size_t CAPACITY, typename HASH, typename EQUAL>
+struct IsBaseline<MutexHashMap<KEY, VALUE, CAPACITY, HASH, EQUAL>> : std::true_type {};
+
+template<typename T, std::size_t N>
+struct IsBaseline<MutexCondQueue<T, N>> : std::true_type {};
+
+/* -------------------------------------------------------------------------- */
+/*          ReportVsBaseline – shmap throughput over the baseline's           */
+/* -------------------------------------------------------------------------- */
+// The baselines are registered before the shmap structures, so a shmap case
+// finds the rate of the baseline case with the same key and reports the ratio
+// as `vs_baseline`: below 1 the lock wins. `rate` is per thread, the framework
+// averages the ratios over the threads. Each thread keeps the rate of its last
+// run, the one reported after the framework's trial runs. Without the baseline
+// run, e.g. filtered out, there is no counter.
+inline void ReportVsBaseline(benchmark::State& state, const std::string& key, bool baseline, double rate) {
+    static std::mutex mutex;
+    static std::map<std::string, std::map<int, double>> rates;  // by thread index
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (baseline) {
+        rates[key][state.thread_index()] = rate;
+        return;
+    }
+    auto it = rates.find(key);
+    if (it == rates.end()) {
+        return;
+    }
+    double sum = 0;
+    for (const auto& [thread, r] : it->second) {
+        sum += r;
+    }
+    const double base = sum / static_cast<double>(it->second.size());
+    if (base > 0) {
+        state.counters["vs_baseline"] = benchmark::Counter(rate / base, benchmark::Counter::kAvgThreads);
+    }
+}
+
+// `name` plus the first `args` arguments and the thread count, the same for a
+// shmap case and its baseline
+inline std::string CaseKey(const std::string& name, const benchmark::State& state, int args) {
+    std::string key = name;
+    for (int i = 0; i < args; ++i) {
+        key += "/" + std::to_string(state.range(i));
+    }
+    return key + "/threads:" + std::to_string(state.threads());
+}
+
+}
+
+#endif
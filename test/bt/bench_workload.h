@@ -0,0 +1,157 @@
+#ifndef SHMAP_BENCH_WORKLOAD_H
+#define SHMAP_BENCH_WORKLOAD_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include <benchmark/benchmark.h>
+
+#include "shmap/shm_histogram.h"
+
+namespace bench {
+
+/* -------------------------------------------------------------------------- */
+/*                     Rng – xorshift64*, cheap per-thread random             */
+/* -------------------------------------------------------------------------- */
+struct Rng {
+    explicit Rng(uint64_t seed) : state_(seed * 0x9E3779B97F4A7C15ull + 1) {}
+
+    uint64_t Next() noexcept {
+        state_ ^= state_ >> 12;
+        state_ ^= state_ << 25;
+        state_ ^= state_ >> 27;
+        return state_ * 0x2545F4914F6CDD1Dull;
+    }
+
+    // Uniform in [0, n)
+    uint64_t Uniform(uint64_t n) noexcept {
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(Next()) * n) >> 64);
+    }
+
+    // Uniform in [0, 1)
+    double NextDouble() noexcept {
+        return static_cast<double>(Next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    uint64_t state_;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                     Zipf – YCSB style zipfian ranks in [0, n)              */
+/* -------------------------------------------------------------------------- */
+// Gray et al. "Quickly generating billion-record synthetic databases".
+// Rank 0 is the hottest; ranks are scrambled so hot keys spread over the table.
+struct Zipf {
+    explicit Zipf(uint64_t n, double theta = 0.99) : n_(n), theta_(theta) {
+        zetan_ = Zeta(n, theta);
+        alpha_ = 1.0 / (1.0 - theta);
+        eta_   = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - Zeta(2, theta) / zetan_);
+    }
+
+    uint64_t Next(Rng& rng) const noexcept {
+        double u  = rng.NextDouble();
+        double uz = u * zetan_;
+        uint64_t rank;
+        if (uz < 1.0) {
+            rank = 0;
+        } else if (uz < 1.0 + std::pow(0.5, theta_)) {
+            rank = 1;
+        } else {
+            rank = static_cast<uint64_t>(n_ * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+        }
+        return Scramble(std::min(rank, n_ - 1));
+    }
+
+private:
+    static double Zeta(uint64_t n, double theta) {
+        double sum = 0;
+        for (uint64_t i = 1; i <= n; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i), theta);
+        }
+        return sum;
+    }
+
+    uint64_t Scramble(uint64_t rank) const noexcept {
+        uint64_t h = rank * 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return h % n_;
+    }
+
+private:
+    uint64_t n_;
+    double theta_;
+    double zetan_;
+    double alpha_;
+    double eta_;
+};
+
+enum class Distribution : int64_t {
+    Uniform = 0,
+    Zipfian = 1,
+};
+
+/* -------------------------------------------------------------------------- */
+/*                     LatencyRecorder – sampled per-thread latencies         */
+/* -------------------------------------------------------------------------- */
+// Times one op in SAMPLE_EVERY to keep the clock reads out of the throughput.
+// Samples go into a fixed size histogram, so recording never allocates.
+struct LatencyRecorder {
+    static constexpr uint64_t SAMPLE_EVERY = 16;
+
+    bool ShouldSample(uint64_t op) const noexcept {
+        return op % SAMPLE_EVERY == 0;
+    }
+
+    void Record(std::chrono::nanoseconds ns) noexcept {
+        histogram_.Record(ns.count() > 0 ? static_cast<uint64_t>(ns.count()) : 0);
+    }
+
+    // Percentiles of the samples of all threads: each thread merges its histogram,
+    // the last one to arrive reports. Only that thread sets the counters, so the
+    // framework's sum over threads is the merged value itself.
+    void Report(benchmark::State& state) {
+        std::lock_guard<std::mutex> lock(Merged::mutex);
+        Merged::histogram.Merge(histogram_);
+        if (++Merged::arrived < state.threads()) {
+            return;
+        }
+        const shmap::HistogramSnapshot<> merged = Merged::histogram;
+        Merged::histogram = shmap::HistogramSnapshot<>{};
+        Merged::arrived = 0;
+
+        if (merged.Count() == 0) {
+            return;
+        }
+        auto at = [&merged](double q) {
+            return static_cast<double>(merged.Percentile(q));
+        };
+        state.counters["p50_ns"]  = at(0.50);
+        state.counters["p99_ns"]  = at(0.99);
+        state.counters["p999_ns"] = at(0.999);
+        state.counters["max_ns"]  = static_cast<double>(merged.Max());
+    }
+
+private:
+    // Benchmarks run one at a time, so one merge area serves them all
+    struct Merged {
+        inline static std::mutex mutex;
+        inline static shmap::HistogramSnapshot<> histogram;
+        inline static int arrived = 0;
+    };
+
+    shmap::HistogramSnapshot<> histogram_;
+};
+
+// Total ops/s over all threads
+inline void ReportThroughput(benchmark::State& state, uint64_t ops) {
+    state.counters["ops/s"] = benchmark::Counter(static_cast<double>(ops), benchmark::Counter::kIsRate);
+}
+
+}
+
+#endif
@@ -0,0 +1,336 @@
+#ifndef SHMAP_BENCH_MP_HARNESS_H
+#define SHMAP_BENCH_MP_HARNESS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "shmap/backoff.h"
+#include "shmap/shm_histogram.h"
+#include "process_launcher.h"
+#include "perf_counters.h"
+
+namespace bench {
+
+// Pin the calling process to the `n`-th CPU it is allowed to run on
+inline bool PinToCpu(uint32_t n) {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return false;
+    }
+    const int count = CPU_COUNT(&allowed);
+    if (count == 0) {
+        return false;
+    }
+    int target = static_cast<int>(n % count);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed) && target-- == 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            return sched_setaffinity(0, sizeof(set), &set) == 0;
+        }
+    }
+    return false;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                     ShmBarrier – process shared generation barrier         */
+/* -------------------------------------------------------------------------- */
+// A party that gives up breaks the barrier, so the others return false too
+// instead of waiting for it until their own deadline
+struct ShmBarrier {
+    void Init(uint32_t parties) noexcept {
+        parties_ = parties;
+        arrived_.store(0, std::memory_order_relaxed);
+        broken_.store(false, std::memory_order_relaxed);
+        generation_.store(0, std::memory_order_release);
+    }
+
+    // False once `timeout` expires, alive() turns false or another party gave up
+    template<typename ALIVE /* bool () */>
+    bool Wait(std::chrono::nanoseconds timeout, ALIVE&& alive) noexcept {
+        const uint32_t gen = generation_.load(std::memory_order_acquire);
+        if (arrived_.fetch_add(1, std::memory_order_acq_rel) + 1 == parties_) {
+            arrived_.store(0, std::memory_order_relaxed);
+            generation_.fetch_add(1, std::memory_order_release);
+            return true;
+        }
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        uint32_t spins = 0;
+        while (generation_.load(std::memory_order_acquire) == gen) {
+            if (++spins < 1024) {
+                shmap::detail::CpuRelax();
+                continue;
+            }
+            std::this_thread::yield();
+            if (broken_.load(std::memory_order_acquire) ||
+                ((spins & 255) == 0 && (std::chrono::steady_clock::now() >= deadline || !alive()))) {
+                broken_.store(true, std::memory_order_release);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Wait(std::chrono::nanoseconds timeout) noexcept {
+        return Wait(timeout, [] { return true; });
+    }
+
+private:
+    uint32_t parties_{0};
+    std::atomic<uint32_t> arrived_{0};
+    std::atomic<bool> broken_{false};
+    std::atomic<uint32_t> generation_{0};
+};
+
+// Per process, trivially copyable so it can live in the shm results block
+using LatencyHistogram = shmap::HistogramSnapshot<>;
+
+/* -------------------------------------------------------------------------- */
+/*                     MpHarness – N pinned worker processes on one workload  */
+/* -------------------------------------------------------------------------- */
+struct MpProcessResult {
+    uint64_t ops{0};
+    uint64_t elapsedNs{0};
+    LatencyHistogram latency;
+    PerfValues perf;
+};
+
+// Workload parameters copied to every worker, meaning is up to the workload
+struct MpArgs {
+    uint32_t procs{1};
+    std::array<int64_t, 6> values{};
+};
+
+struct MpControl;
+
+// Handle a worker process gets on its share of the results block
+struct MpWorker {
+    uint32_t Index() const noexcept { return index_; }
+    const MpArgs& Args() const noexcept;
+
+    // Wait until every worker is attached, then start measuring.
+    // Stops the run if a process never shows up.
+    void Ready() noexcept;
+
+    bool Running() const noexcept;
+
+    void Record(std::chrono::nanoseconds ns) noexcept {
+        result_->latency.Record(static_cast<uint64_t>(ns.count()));
+    }
+
+    void AddOps(uint64_t ops) noexcept {
+        result_->ops += ops;
+    }
+
+private:
+    friend struct MpHarness;
+    MpWorker(MpControl* control, uint32_t index, MpProcessResult* result)
+    : control_(control), index_(index), result_(result) {}
+
+    MpControl* control_;
+    uint32_t index_;
+    MpProcessResult* result_;
+    std::chrono::steady_clock::time_point start_{};
+    PerfCounters perf_;
+};
+
+// Worker 0 runs `setup` alone (e.g. create and prefill the storage), then every
+// worker runs `run`, which attaches its own resources, calls Ready() and loops
+// while Running()
+struct MpWorkload {
+    void (*setup)(const MpArgs&) = nullptr;
+    void (*run)(MpWorker&) = nullptr;
+};
+
+struct MpControl {
+    static constexpr uint32_t MAX_PROCS = 64;
+    // Covers the setup of worker 0, e.g. prefilling a large table
+    static constexpr std::chrono::seconds BARRIER_TIMEOUT{120};
+
+    ShmBarrier setupDone;
+    ShmBarrier start;
+    std::atomic<bool> stop{false};
+    bool pin{true};
+    MpArgs args;
+    MpWorkload workload;
+    MpProcessResult results[MAX_PROCS];
+};
+
+inline const MpArgs& MpWorker::Args() const noexcept {
+    return control_->args;
+}
+
+inline void MpWorker::Ready() noexcept {
+    if (!control_->start.Wait(MpControl::BARRIER_TIMEOUT)) {
+        control_->stop.store(true, std::memory_order_relaxed);
+    }
+    start_ = std::chrono::steady_clock::now();
+    perf_.Start();
+}
+
+inline bool MpWorker::Running() const noexcept {
+    return !control_->stop.load(std::memory_order_relaxed);
+}
+
+struct MpHarness {
+    MpHarness() {
+        void* mem = mmap(nullptr, sizeof(MpControl), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0);
+        if (mem == MAP_FAILED) {
+            perror("mmap");
+            std::exit(1);
+        }
+        control_ = new (mem) MpControl();
+    }
+
+    ~MpHarness() {
+        munmap(control_, sizeof(MpControl));
+    }
+
+    MpHarness(const MpHarness&) = delete;
+    MpHarness& operator=(const MpHarness&) = delete;
+
+    // Fork args.procs workers, let them run for `duration` and collect their results.
+    // Returns false if a worker crashed, timed out or never reached the start.
+    bool Run(const MpWorkload& workload, const MpArgs& args, std::chrono::milliseconds duration, bool pin = true) {
+        const uint32_t procs = std::min(args.procs, MpControl::MAX_PROCS);
+        control_->args = args;
+        control_->args.procs = procs;
+        control_->workload = workload;
+        control_->pin = pin;
+        control_->stop.store(false, std::memory_order_relaxed);
+        control_->setupDone.Init(procs + 1);
+        control_->start.Init(procs + 1);
+        for (auto& result : control_->results) {
+            result = MpProcessResult{};
+        }
+
+        // Talking to a crashed worker must fail with EPIPE, not kill the benchmark
+        signal(SIGPIPE, SIG_IGN);
+
+        // Launched after the control block is filled, tasks only capture its address
+        ProcessLauncher launcher;
+        std::vector<Processor> workers;
+        for (uint32_t i = 0; i < procs; ++i) {
+            MpControl* control = control_;
+            workers.push_back(launcher.Launch("mp_worker_" + std::to_string(i),
+                [control, i] { RunWorker(control, i); }));
+        }
+
+        // A worker that died can never arrive, check without reaping it
+        auto alive = [&workers] {
+            for (auto& w : workers) {
+                siginfo_t info{};
+                if (waitid(P_PID, static_cast<id_t>(w.GetPid()), &info, WEXITED | WNOHANG | WNOWAIT) != 0 ||
+                    info.si_pid != 0) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        const bool started = control_->setupDone.Wait(MpControl::BARRIER_TIMEOUT, alive) &&
+                             control_->start.Wait(MpControl::BARRIER_TIMEOUT, alive);
+        if (started) {
+            std::this_thread::sleep_for(duration);
+        } else {
+            fprintf(stderr, "MpHarness: a worker never reached the start\n");
+        }
+        control_->stop.store(true, std::memory_order_relaxed);
+
+        auto results = launcher.Wait(workers, started ? duration + std::chrono::seconds(30) : std::chrono::seconds(5));
+        launcher.Stop(workers);
+        for (auto& w : workers) {
+            waitpid(w.GetPid(), nullptr, 0);
+        }
+
+        bool ok = started;
+        for (auto& r : results) {
+            ok &= r.status == shmap::Status::SUCCESS;
+        }
+        procs_ = procs;
+        return ok;
+    }
+
+    uint32_t Procs() const noexcept { return procs_; }
+
+    const MpProcessResult& Result(uint32_t i) const noexcept {
+        return control_->results[i];
+    }
+
+    uint64_t TotalOps() const noexcept {
+        uint64_t ops = 0;
+        for (uint32_t i = 0; i < procs_; ++i) ops += control_->results[i].ops;
+        return ops;
+    }
+
+    // Longest worker measuring window
+    double Seconds() const noexcept {
+        uint64_t ns = 0;
+        for (uint32_t i = 0; i < procs_; ++i) ns = std::max(ns, control_->results[i].elapsedNs);
+        return static_cast<double>(ns) / 1e9;
+    }
+
+    LatencyHistogram MergedLatency() const noexcept {
+        LatencyHistogram merged;
+        for (uint32_t i = 0; i < procs_; ++i) merged.Merge(control_->results[i].latency);
+        return merged;
+    }
+
+    // Counters of all workers summed, empty unless SHMAP_PERF_COUNTERS=1
+    PerfValues MergedPerf() const noexcept {
+        if (procs_ == 0) {
+            return {};
+        }
+        PerfValues merged = control_->results[0].perf;
+        for (uint32_t i = 1; i < procs_; ++i) merged.Merge(control_->results[i].perf);
+        return merged;
+    }
+
+private:
+    static void RunWorker(MpControl* control, uint32_t index) {
+        if (control->pin) {
+            PinToCpu(index);
+        }
+        if (index == 0 && control->workload.setup) {
+            control->workload.setup(control->args);
+        }
+        if (!control->setupDone.Wait(MpControl::BARRIER_TIMEOUT)) {
+            control->stop.store(true, std::memory_order_relaxed);
+            return;
+        }
+
+        MpWorker worker(control, index, &control->results[index]);
+        control->workload.run(worker);
+        control->results[index].perf = worker.perf_.Stop();
+        control->results[index].elapsedNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - worker.start_).count());
+    }
+
+private:
+    MpControl* control_{nullptr};
+    uint32_t procs_{0};
+};
+
+// Measuring window of the multi-process benchmarks, SHMAP_MP_BENCH_MS overrides it
+inline std::chrono::milliseconds MpDuration() {
+    const char* env = std::getenv("SHMAP_MP_BENCH_MS");
+    return std::chrono::milliseconds(env ? std::atoll(env) : 1000);
+}
+
+}
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef SHMAP_BENCH_PERF_COUNTERS_H
+#define SHMAP_BENCH_PERF_COUNTERS_H
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+namespace bench {
+
+/* -------------------------------------------------------------------------- */
+/*                     PerfCounters – perf_event_open on the calling thread   */
+/* -------------------------------------------------------------------------- */
+// Off unless SHMAP_PERF_COUNTERS=1. Every event is opened on its own, so a PMU
+// lacking one of them (common in VMs) still reports the rest; events that could
+// not be opened are left out of the report instead of showing up as zeros.
+enum class PerfEvent : uint32_t {
+    Cycles,
+    Instructions,
+    LlcMisses,
+    DtlbMisses,
+    BranchMisses,
+    COUNT
+};
+
+constexpr std::size_t PERF_EVENT_COUNT = static_cast<std::size_t>(PerfEvent::COUNT);
+
+// Counts of one measuring window, trivially copyable for the shm results block
+struct PerfValues {
+    std::array<uint64_t, PERF_EVENT_COUNT> counts{};
+    uint32_t validMask{0};
+
+    bool Valid(PerfEvent e) const noexcept {
+        return validMask & (1u << static_cast<uint32_t>(e));
+    }
+
+    uint64_t operator[](PerfEvent e) const noexcept {
+        return counts[static_cast<std::size_t>(e)];
+    }
+
+    // Events missing on either side are dropped from the sum
+    void Merge(const PerfValues& other) noexcept {
+        validMask &= other.validMask;
+        for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            counts[i] += other.counts[i];
+        }
+    }
+};
+
+struct PerfCounters {
+    static bool Enabled() noexcept {
+        static const bool enabled = [] {
+            const char* env = std::getenv("SHMAP_PERF_COUNTERS");
+            return env && std::atoi(env) != 0;
+        }();
+        return enabled;
+    }
+
+    PerfCounters() {
+        fds_.fill(-1);
+        if (!Enabled()) {
+            return;
+        }
+        for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            fds_[i] = Open(static_cast<PerfEvent>(i));
+        }
+        static bool warned = false;
+        if (!Valid() && !warned) {
+            warned = true;
+            std::fprintf(stderr, "SHMAP_PERF_COUNTERS: perf_event_open failed (%s), "
+                "counters are not reported\n", std::strerror(errno));
+        }
+    }
+
+    ~PerfCounters() {
+        for (int fd : fds_) {
+            if (fd >= 0) close(fd);
+        }
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool Valid() const noexcept {
+        for (int fd : fds_) {
+            if (fd >= 0) return true;
+        }
+        return false;
+    }
+
+    void Start() noexcept {
+        for (int fd : fds_) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    // Counts since Start(), scaled up when the kernel multiplexed the counters
+    PerfValues Stop() noexcept {
+        PerfValues values;
+        for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            const int fd = fds_[i];
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t data[3] = {}; // value, time enabled, time running
+            if (read(fd, data, sizeof(data)) != sizeof(data) || data[2] == 0) {
+                continue;
+            }
+            values.counts[i] = data[2] < data[1]
+                ? static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2])
+                : data[0];
+            values.validMask |= 1u << i;
+        }
+        return values;
+    }
+
+private:
+    static int Open(PerfEvent event) noexcept {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        switch (event) {
+        case PerfEvent::Cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfEvent::Instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfEvent::LlcMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case PerfEvent::DtlbMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB
+                | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case PerfEvent::BranchMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        default:
+            return -1;
+        }
+        // This thread on any CPU
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+private:
+    std::array<int, PERF_EVENT_COUNT> fds_;
+};
+
+// Per op counters, averaged over threads when every thread reports its own share.
+// Adds nothing if no event could be counted.
+inline void ReportPerf(benchmark::State& state, const PerfValues& values, uint64_t ops,
+    benchmark::Counter::Flags flags = benchmark::Counter::kAvgThreads) {
+    if (values.validMask == 0 || ops == 0) {
+        return;
+    }
+    static constexpr const char* NAMES[PERF_EVENT_COUNT] = {
+        "cycles/op", "instrs/op", "llc_miss/op", "dtlb_miss/op", "br_miss/op"
+    };
+    for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        const auto e = static_cast<PerfEvent>(i);
+        if (values.Valid(e)) {
+            state.counters[NAMES[i]] = benchmark::Counter(
+                static_cast<double>(values[e]) / static_cast<double>(ops), flags);
+        }
+    }
+    if (values.Valid(PerfEvent::Cycles) && values.Valid(PerfEvent::Instructions) && values[PerfEvent::Cycles]) {
+        state.counters["ipc"] = benchmark::Counter(
+            static_cast<double>(values[PerfEvent::Instructions]) / values[PerfEvent::Cycles], flags);
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,230 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "shmap/shm_hash_table.h"
+#include "shmap/fixed_string.h"
+#include "bench_workload.h"
+#include "bench_baseline.h"
+#include "perf_counters.h"
+
+using namespace shmap;
+
+namespace {
+
+/* -------------------------------------------------------------------------- */
+/*                     Keys                                                   */
+/* -------------------------------------------------------------------------- */
+// Spread the sequence numbers so identity hashed integers do not fill
+// consecutive buckets
+inline uint64_t Mix64(uint64_t x) noexcept {
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27; x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+template<typename KEY>
+KEY MakeKey(uint64_t i);
+
+template<>
+uint64_t MakeKey<uint64_t>(uint64_t i) {
+    return Mix64(i);
+}
+
+template<>
+FixedString<> MakeKey<FixedString<>>(uint64_t i) {
+    return FixedString<>::Format("user:{}:session", Mix64(i));
+}
+
+/* -------------------------------------------------------------------------- */
+/*                     Tables under test                                      */
+/* -------------------------------------------------------------------------- */
+constexpr std::size_t TABLE_CAPACITY = 1 << 16;
+
+template<typename KEY>
+struct ShmTable {
+    using Key   = KEY;
+    using Table = ShmHashTable<KEY, uint64_t, TABLE_CAPACITY>;
+};
+
+// Baseline: same workload on one process shared mutex
+template<typename KEY>
+struct MutexTable {
+    using Key   = KEY;
+    using Table = bench::MutexHashMap<KEY, uint64_t, TABLE_CAPACITY>;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                     TableFixture – one table shared by all threads         */
+/* -------------------------------------------------------------------------- */
+// Args: load factor %, read %, distribution, hit
+//  - the first `filled` keys are inserted, reads of a miss use keys never inserted
+//  - writes always update an existing key, so the load factor stays constant
+template<typename KIND>
+struct TableFixture {
+    static constexpr std::size_t CAPACITY = TABLE_CAPACITY;
+    using KEY   = typename KIND::Key;
+    using Table = typename KIND::Table;
+
+    static inline Table* table = nullptr;
+    static inline std::vector<KEY> keys;
+    static inline std::size_t filled = 0;
+    static inline bench::Zipf* zipf = nullptr;
+
+    static void Setup(const benchmark::State& state) {
+        filled = std::max<std::size_t>(1, CAPACITY * state.range(0) / 100);
+        table  = new Table();
+        keys.clear();
+        keys.reserve(2 * filled);
+        for (std::size_t i = 0; i < 2 * filled; ++i) {
+            keys.push_back(MakeKey<KEY>(i));
+        }
+        for (std::size_t i = 0; i < filled; ++i) {
+            table->Visit(keys[i], AccessMode::CreateIfMiss,
+                [i](std::size_t, uint64_t& v, bool) { v = i; });
+        }
+        zipf = new bench::Zipf(filled);
+    }
+
+    static void Teardown(const benchmark::State&) {
+        delete table;
+        delete zipf;
+        table = nullptr;
+        zipf  = nullptr;
+        keys.clear();
+    }
+};
+
+template<typename KIND>
+void BM_TableVisit(benchmark::State& state) {
+    using Fixture = TableFixture<KIND>;
+    using KEY = typename Fixture::KEY;
+    const int64_t readPct = state.range(1);
+    const auto dist = static_cast<bench::Distribution>(state.range(2));
+    const bool hit  = state.range(3) != 0;
+
+    bench::Rng rng(state.thread_index() + 1);
+    bench::LatencyRecorder latency;
+    auto* table = Fixture::table;
+    const auto& keys = Fixture::keys;
+    const std::size_t filled = Fixture::filled;
+
+    uint64_t ops = 0;
+    uint64_t found = 0;
+    bench::PerfCounters perf;
+    perf.Start();
+    const auto start = std::chrono::steady_clock::now();
+    for (auto _ : state) {
+        std::size_t rank = dist == bench::Distribution::Zipfian
+            ? Fixture::zipf->Next(rng) : rng.Uniform(filled);
+        bool read = static_cast<int64_t>(rng.Uniform(100)) < readPct;
+        const KEY& key = (read && !hit) ? keys[filled + rank] : keys[rank];
+
+        bool sample = latency.ShouldSample(ops);
+        auto t0 = sample ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+        Status status = Status::SUCCESS;
+        if (read) {
+            uint64_t value = 0;
+            status = table->Visit(key, AccessMode::AccessExist,
+                [&value](std::size_t, uint64_t& v, bool) { value = v; });
+            benchmark::DoNotOptimize(value);
+        } else {
+            status = table->Visit(key, AccessMode::CreateIfMiss,
+                [](std::size_t, uint64_t& v, bool) { ++v; });
+        }
+        if (sample) {
+            latency.Record(std::chrono::steady_clock::now() - t0);
+        }
+        found += status == Status::SUCCESS;
+        ++ops;
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const auto counts = perf.Stop();
+
+    bench::ReportThroughput(state, ops);
+    bench::ReportVsBaseline(state, bench::CaseKey("TableVisit/" + std::to_string(sizeof(KEY)), state, 4),
+        bench::IsBaseline<typename Fixture::Table>::value, elapsed.count() > 0 ? ops / elapsed.count() : 0);
+    state.counters["hit_ratio"] = benchmark::Counter(ops ? double(found) / ops : 0, benchmark::Counter::kAvgThreads);
+    latency.Report(state);
+    bench::ReportPerf(state, counts, ops);
+}
+
+template<typename KIND>
+void BM_TableTravel(benchmark::State& state) {
+    using Fixture = TableFixture<KIND>;
+    using KEY = typename Fixture::KEY;
+    auto* table = Fixture::table;
+
+    uint64_t visited = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        table->Travel([&sum](std::size_t, const KEY&, uint64_t& v) { sum += v; });
+        benchmark::DoNotOptimize(sum);
+        visited += Fixture::filled;
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    bench::ReportVsBaseline(state, bench::CaseKey("TableTravel/" + std::to_string(sizeof(KEY)), state, 1),
+        bench::IsBaseline<typename Fixture::Table>::value, elapsed.count() > 0 ? visited / elapsed.count() : 0);
+    state.counters["buckets/s"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * Fixture::CAPACITY), benchmark::Counter::kIsRate);
+    state.counters["items/s"] = benchmark::Counter(static_cast<double>(visited), benchmark::Counter::kIsRate);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                     Registration                                           */
+/* -------------------------------------------------------------------------- */
+void VisitArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"load", "read", "zipf", "hit"});
+    // Load factor sweep: read-mostly uniform hits
+    for (int64_t load : {10, 50, 75, 90, 95}) {
+        b->Args({load, 95, 0, 1});
+    }
+    // Mix sweep at a typical load factor, both distributions, hits and misses
+    for (int64_t read : {100, 95, 50, 0}) {
+        for (int64_t zipf : {0, 1}) {
+            b->Args({75, read, zipf, 1});
+        }
+    }
+    for (int64_t load : {50, 90}) {
+        b->Args({load, 100, 0, 0});
+    }
+    b->ThreadRange(1, static_cast<int>(std::thread::hardware_concurrency()));
+    b->UseRealTime();
+}
+
+void TravelArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"load"});
+    for (int64_t load : {10, 50, 95}) {
+        b->Args({load});
+    }
+    b->UseRealTime();
+}
+
+}
+
+#define SHMAP_TABLE_BENCHMARKS(KIND)                    \
+    BENCHMARK_TEMPLATE(BM_TableVisit, KIND)             \
+        ->Apply(VisitArgs)                              \
+        ->Setup(TableFixture<KIND>::Setup)              \
+        ->Teardown(TableFixture<KIND>::Teardown);       \
+    BENCHMARK_TEMPLATE(BM_TableTravel, KIND)            \
+        ->Apply(TravelArgs)                             \
+        ->Setup(TableFixture<KIND>::Setup)              \
+        ->Teardown(TableFixture<KIND>::Teardown)
+
+using ShmU64    = ShmTable<uint64_t>;
+using ShmStr    = ShmTable<FixedString<>>;
+using MutexU64  = MutexTable<uint64_t>;
+using MutexStr  = MutexTable<FixedString<>>;
+
+// Baselines first, so the shmap cases can report vs_baseline
+SHMAP_TABLE_BENCHMARKS(MutexU64);
+SHMAP_TABLE_BENCHMARKS(ShmU64);
+SHMAP_TABLE_BENCHMARKS(MutexStr);
+SHMAP_TABLE_BENCHMARKS(ShmStr);
@@ -0,0 +1,307 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <thread>
+
+#include "shmap/backoff.h"
+#include "shmap/shm_ring_buffer.h"
+#include "shmap/shm_storage.h"
+#include "mp_harness.h"
+#include "bench_baseline.h"
+
+using namespace shmap;
+
+namespace {
+
+/* -------------------------------------------------------------------------- */
+/*                     Messages                                               */
+/* -------------------------------------------------------------------------- */
+// `stamp` carries the TscClock ticks at push time for the one-way mode
+template<std::size_t SIZE>
+struct Message {
+    static_assert(SIZE > 16, "SIZE must hold the header");
+    uint64_t stamp;
+    uint64_t seq;
+    char payload[SIZE - 16];
+};
+
+template<>
+struct Message<16> {
+    uint64_t stamp;
+    uint64_t seq;
+};
+
+inline double TicksPerNano() {
+    static const double ratio = static_cast<double>(TscClock::FromNanos(std::chrono::seconds(1))) / 1e9;
+    return ratio;
+}
+
+inline std::chrono::nanoseconds TicksToNanos(uint64_t ticks) {
+    return std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(ticks) / TicksPerNano()));
+}
+
+// Busy wait on pause, yielding only when the peer seems descheduled
+// (e.g. both processes share one CPU)
+struct Spinner {
+    void Wait() noexcept {
+        if (++spins_ < 1u << 14) {
+            detail::CpuRelax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    uint32_t spins_{0};
+};
+
+/* -------------------------------------------------------------------------- */
+/*                     Ring kinds – same push/pop shape for every ring        */
+/* -------------------------------------------------------------------------- */
+constexpr std::size_t RING_CAPACITY = 1024;
+
+struct Spsc {
+    template<typename T>
+    using Ring = ShmRingBuffer<T, RING_CAPACITY>;
+
+    template<typename T>
+    struct Endpoint {
+        static void Init(Ring<T>&) {}
+        explicit Endpoint(Ring<T>& ring) : ring_(&ring) {}
+        bool Push(const T& v) { return ring_->push(v); }
+        std::optional<T> Pop() { return ring_->pop(); }
+        Ring<T>* ring_;
+    };
+};
+
+struct SpMc {
+    template<typename T>
+    using Ring = ShmSpMcRingBuffer<T, RING_CAPACITY>;
+
+    template<typename T>
+    struct Endpoint {
+        static void Init(Ring<T>&) {}
+        explicit Endpoint(Ring<T>& ring) : ring_(&ring) {}
+        bool Push(const T& v) { return ring_->push(v); }
+        std::optional<T> Pop() { return ring_->pop(); }
+        Ring<T>* ring_;
+    };
+};
+
+struct Broadcast {
+    template<typename T>
+    using Ring = BroadcastRingBuffer<T, RING_CAPACITY>;
+
+    // One consumer, its cursor lives in the consuming process
+    template<typename T>
+    struct Endpoint {
+        static void Init(Ring<T>& ring) { ring.init(1); }
+        explicit Endpoint(Ring<T>& ring) : ring_(&ring), consumer_(ring.make_consumer()) {}
+        bool Push(const T& v) { return ring_->push(v); }
+        std::optional<T> Pop() { return consumer_.pop(); }
+        Ring<T>* ring_;
+        typename Ring<T>::Consumer consumer_;
+    };
+};
+
+// Baseline: mutex + condition variable queue, the consumer blocks in the kernel
+struct MutexQueue {
+    template<typename T>
+    using Ring = bench::MutexCondQueue<T, RING_CAPACITY>;
+
+    template<typename T>
+    struct Endpoint {
+        static void Init(Ring<T>&) {}
+        explicit Endpoint(Ring<T>& ring) : ring_(&ring) {}
+        bool Push(const T& v) { return ring_->push(v); }
+        std::optional<T> Pop() { return ring_->pop_wait(std::chrono::milliseconds(1)); }
+        Ring<T>* ring_;
+    };
+};
+
+/* -------------------------------------------------------------------------- */
+/*                     Channel – two rings and a counter in one ShmStorage    */
+/* -------------------------------------------------------------------------- */
+struct RingPath { static constexpr const char* value = "/shmap_bench_ring_mp"; };
+
+template<typename KIND, std::size_t SIZE>
+struct Channel {
+    using Msg  = Message<SIZE>;
+    using Ring = typename KIND::template Ring<Msg>;
+    using End  = typename KIND::template Endpoint<Msg>;
+    using Storage = ShmStorage<Channel, RingPath>;
+
+    Ring forward;
+    Ring backward;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> received{0};
+
+    static void Setup(const bench::MpArgs&) {
+        auto& storage = Storage::GetInstance();
+        End::Init(storage->forward);
+        End::Init(storage->backward);
+    }
+};
+
+// Args: values[0] batch size
+template<typename KIND, std::size_t SIZE>
+struct PingPong {
+    using Ch = Channel<KIND, SIZE>;
+
+    // Worker 0 sends a batch and waits for all echoes, one round trip per batch.
+    // Worker 1 echoes every message back.
+    static void Run(bench::MpWorker& worker) {
+        auto& ch = *Ch::Storage::GetInstance();
+        const int64_t batch = worker.Args().values[0];
+        typename Ch::End out(worker.Index() == 0 ? ch.forward : ch.backward);
+        typename Ch::End in(worker.Index() == 0 ? ch.backward : ch.forward);
+
+        worker.Ready();
+        if (worker.Index() == 0) {
+            typename Ch::Msg msg{};
+            uint64_t rounds = 0;
+            while (worker.Running()) {
+                const uint64_t t0 = TscClock::Now();
+                for (int64_t i = 0; i < batch; ++i) {
+                    msg.seq = rounds * batch + i;
+                    for (Spinner spin; !out.Push(msg); spin.Wait()) {
+                        if (!worker.Running()) goto done;
+                    }
+                }
+                for (int64_t i = 0; i < batch; ++i) {
+                    for (Spinner spin; !in.Pop(); spin.Wait()) {
+                        if (!worker.Running()) goto done;
+                    }
+                }
+                worker.Record(TicksToNanos(TscClock::Now() - t0));
+                ++rounds;
+            }
+        done:
+            worker.AddOps(rounds * batch);
+        } else {
+            Spinner idle;
+            while (worker.Running()) {
+                auto msg = in.Pop();
+                if (!msg) {
+                    idle.Wait();
+                    continue;
+                }
+                idle = Spinner{};
+                for (Spinner spin; !out.Push(*msg) && worker.Running(); spin.Wait()) {}
+            }
+        }
+    }
+};
+
+template<typename KIND, std::size_t SIZE>
+struct OneWay {
+    using Ch = Channel<KIND, SIZE>;
+
+    // Worker 0 stamps and pushes a batch, then waits until it is consumed.
+    // Worker 1 pops and records push-to-pop latency from the TSC stamps.
+    static void Run(bench::MpWorker& worker) {
+        auto& ch = *Ch::Storage::GetInstance();
+        const int64_t batch = worker.Args().values[0];
+        typename Ch::End end(ch.forward);
+
+        worker.Ready();
+        if (worker.Index() == 0) {
+            typename Ch::Msg msg{};
+            uint64_t sent = 0;
+            while (worker.Running()) {
+                for (int64_t i = 0; i < batch; ++i) {
+                    msg.seq = sent;
+                    msg.stamp = TscClock::Now();
+                    for (Spinner spin; !end.Push(msg); spin.Wait()) {
+                        if (!worker.Running()) return;
+                    }
+                    ++sent;
+                }
+                for (Spinner spin; ch.received.load(std::memory_order_acquire) < sent; spin.Wait()) {
+                    if (!worker.Running()) return;
+                }
+            }
+        } else {
+            uint64_t received = 0;
+            Spinner idle;
+            while (worker.Running()) {
+                auto msg = end.Pop();
+                if (!msg) {
+                    idle.Wait();
+                    continue;
+                }
+                idle = Spinner{};
+                worker.Record(TicksToNanos(TscClock::Now() - msg->stamp));
+                ch.received.store(++received, std::memory_order_release);
+            }
+            worker.AddOps(received);
+        }
+    }
+};
+
+template<typename WORKLOAD, typename CHANNEL>
+void RunTwoProcesses(benchmark::State& state, const std::string& name) {
+    bench::MpArgs args;
+    args.procs = 2;
+    args.values[0] = state.range(0);
+
+    bench::MpHarness harness;
+    for (auto _ : state) {
+        shm_unlink(RingPath::value);
+        if (!harness.Run({CHANNEL::Setup, WORKLOAD::Run}, args, bench::MpDuration())) {
+            state.SkipWithError("worker process failed");
+            break;
+        }
+        shm_unlink(RingPath::value);
+        state.SetIterationTime(harness.Seconds());
+    }
+
+    auto latency = harness.MergedLatency();
+    state.counters["msgs/s"]  = benchmark::Counter(static_cast<double>(harness.TotalOps()), benchmark::Counter::kIsRate);
+    state.counters["min_ns"]  = latency.Min();
+    state.counters["p50_ns"]  = latency.Percentile(0.50);
+    state.counters["p99_ns"]  = latency.Percentile(0.99);
+    state.counters["p999_ns"] = latency.Percentile(0.999);
+    state.counters["max_ns"]  = latency.Max();
+    bench::ReportVsBaseline(state, bench::CaseKey(name, state, 1), bench::IsBaseline<typename CHANNEL::Ring>::value,
+        harness.Seconds() > 0 ? harness.TotalOps() / harness.Seconds() : 0);
+    // Both processes summed, per message
+    bench::ReportPerf(state, harness.MergedPerf(), harness.TotalOps(), benchmark::Counter::kDefaults);
+}
+
+template<typename KIND, std::size_t SIZE>
+void BM_RingPingPong(benchmark::State& state) {
+    RunTwoProcesses<PingPong<KIND, SIZE>, Channel<KIND, SIZE>>(state, "RingPingPong/" + std::to_string(SIZE));
+}
+
+template<typename KIND, std::size_t SIZE>
+void BM_RingOneWay(benchmark::State& state) {
+    RunTwoProcesses<OneWay<KIND, SIZE>, Channel<KIND, SIZE>>(state, "RingOneWay/" + std::to_string(SIZE));
+}
+
+void RingArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"batch"});
+    for (int64_t batch : {1, 16, 256}) {
+        b->Args({batch});
+    }
+    b->Iterations(1);
+    b->UseManualTime();
+}
+
+}
+
+#define SHMAP_RING_BENCHMARKS(KIND)                                 \
+    BENCHMARK_TEMPLATE(BM_RingPingPong, KIND, 16)->Apply(RingArgs);   \
+    BENCHMARK_TEMPLATE(BM_RingPingPong, KIND, 64)->Apply(RingArgs);   \
+    BENCHMARK_TEMPLATE(BM_RingPingPong, KIND, 256)->Apply(RingArgs);  \
+    BENCHMARK_TEMPLATE(BM_RingPingPong, KIND, 1024)->Apply(RingArgs); \
+    BENCHMARK_TEMPLATE(BM_RingOneWay, KIND, 16)->Apply(RingArgs);     \
+    BENCHMARK_TEMPLATE(BM_RingOneWay, KIND, 64)->Apply(RingArgs);     \
+    BENCHMARK_TEMPLATE(BM_RingOneWay, KIND, 256)->Apply(RingArgs);    \
+    BENCHMARK_TEMPLATE(BM_RingOneWay, KIND, 1024)->Apply(RingArgs)
+
+// Baseline first, so the shmap rings can report vs_baseline
+SHMAP_RING_BENCHMARKS(MutexQueue);
+SHMAP_RING_BENCHMARKS(Spsc);
+SHMAP_RING_BENCHMARKS(SpMc);
+SHMAP_RING_BENCHMARKS(Broadcast);
@@ -0,0 +1,128 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#include "shmap/shm_storage.h"
+#include "shmap/shm_hash_table.h"
+#include "bench_workload.h"
+#include "mp_harness.h"
+#include "bench_baseline.h"
+
+using namespace shmap;
+
+namespace {
+
+/* -------------------------------------------------------------------------- */
+/*                     ShmStorage workload                                    */
+/* -------------------------------------------------------------------------- */
+// Args: values[0] read %, values[1] zipfian, values[2] keys.
+// Worker 0 creates and prefills the storage, every worker maps it on its own,
+// so the table sits at a different address in each process.
+struct MpPath { static constexpr const char* value = "/shmap_bench_storage_mp"; };
+
+using ShmMpTable   = ShmHashTable<uint64_t, uint64_t, 1 << 16>;
+// Baseline: process shared pthread mutex around an open addressing map
+using MutexMpTable = bench::MutexHashMap<uint64_t, uint64_t, 1 << 16>;
+
+inline uint64_t KeyOf(uint64_t i) noexcept {
+    return i * 0x9E3779B97F4A7C15ull;
+}
+
+template<typename TABLE>
+void StorageSetup(const bench::MpArgs& args) {
+    auto& storage = ShmStorage<TABLE, MpPath>::GetInstance();
+    for (int64_t i = 0; i < args.values[2]; ++i) {
+        storage->Visit(KeyOf(i), AccessMode::CreateIfMiss,
+            [](std::size_t, uint64_t& v, bool) { v = 0; });
+    }
+}
+
+template<typename TABLE>
+void StorageRun(bench::MpWorker& worker) {
+    const auto& args = worker.Args();
+    const int64_t readPct = args.values[0];
+    const bool zipfian = args.values[1] != 0;
+    const uint64_t keys = static_cast<uint64_t>(args.values[2]);
+
+    auto& storage = ShmStorage<TABLE, MpPath>::GetInstance();
+    bench::Rng rng(worker.Index() + 1);
+    bench::Zipf zipf(keys);
+
+    worker.Ready();
+    uint64_t ops = 0;
+    while (worker.Running()) {
+        for (int batch = 0; batch < 64; ++batch, ++ops) {
+            uint64_t key = KeyOf(zipfian ? zipf.Next(rng) : rng.Uniform(keys));
+            bool read = static_cast<int64_t>(rng.Uniform(100)) < readPct;
+            bool sample = ops % bench::LatencyRecorder::SAMPLE_EVERY == 0;
+            auto t0 = sample ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+            if (read) {
+                uint64_t value = 0;
+                storage->Visit(key, AccessMode::AccessExist,
+                    [&value](std::size_t, uint64_t& v, bool) { value = v; });
+                benchmark::DoNotOptimize(value);
+            } else {
+                storage->Visit(key, AccessMode::CreateIfMiss,
+                    [](std::size_t, uint64_t& v, bool) { ++v; });
+            }
+            if (sample) {
+                worker.Record(std::chrono::steady_clock::now() - t0);
+            }
+        }
+    }
+    worker.AddOps(ops);
+}
+
+template<typename TABLE>
+void BM_MpStorageVisit(benchmark::State& state) {
+    bench::MpArgs args;
+    args.procs = static_cast<uint32_t>(state.range(0));
+    args.values = {state.range(1), state.range(2), 1 << 15};
+
+    bench::MpHarness harness;
+    for (auto _ : state) {
+        // The storage is only ever mapped by the workers, unlink what they left behind
+        shm_unlink(MpPath::value);
+        if (!harness.Run({StorageSetup<TABLE>, StorageRun<TABLE>}, args, bench::MpDuration())) {
+            state.SkipWithError("worker process failed");
+            break;
+        }
+        shm_unlink(MpPath::value);
+        state.SetIterationTime(harness.Seconds());
+    }
+
+    double minOps = 1e300, maxOps = 0;
+    for (uint32_t i = 0; i < harness.Procs(); ++i) {
+        const auto& r = harness.Result(i);
+        double rate = r.elapsedNs ? r.ops * 1e9 / r.elapsedNs : 0;
+        minOps = std::min(minOps, rate);
+        maxOps = std::max(maxOps, rate);
+    }
+    auto latency = harness.MergedLatency();
+    state.counters["ops/s"]      = benchmark::Counter(static_cast<double>(harness.TotalOps()), benchmark::Counter::kIsRate);
+    state.counters["proc_min/s"] = minOps;
+    state.counters["proc_max/s"] = maxOps;
+    state.counters["p50_ns"]     = latency.Percentile(0.50);
+    state.counters["p99_ns"]     = latency.Percentile(0.99);
+    state.counters["p999_ns"]    = latency.Percentile(0.999);
+    state.counters["max_ns"]     = latency.Max();
+    bench::ReportVsBaseline(state, bench::CaseKey("MpStorageVisit", state, 3), bench::IsBaseline<TABLE>::value,
+        harness.Seconds() > 0 ? harness.TotalOps() / harness.Seconds() : 0);
+    // Summed over the workers, per op of the whole run
+    bench::ReportPerf(state, harness.MergedPerf(), harness.TotalOps(), benchmark::Counter::kDefaults);
+}
+
+void MpStorageArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"procs", "read", "zipf"});
+    b->ArgsProduct({{1, 2, 4, 8}, {95, 50}, {0, 1}});
+    b->Iterations(1);
+    b->UseManualTime();
+}
+
+}
+
+// Baseline first, so the shmap cases can report vs_baseline
+BENCHMARK_TEMPLATE(BM_MpStorageVisit, MutexMpTable)->Apply(MpStorageArgs);
+BENCHMARK_TEMPLATE(BM_MpStorageVisit, ShmMpTable)->Apply(MpStorageArgs);
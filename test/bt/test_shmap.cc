@@ -1,5 +1,7 @@
 #include <benchmark/benchmark.h>
-#include "shmap.h"
+#include <cstdlib>
+
+#include "shmap/shmap.h"
 
 //////////////////////////////////////////////////////////////
 static void system_malloc_and_free_once(benchmark::State &state) {
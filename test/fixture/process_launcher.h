@@ -110,7 +110,7 @@ private:
         Res() : idx(0), status(shmap::Status::SUCCESS), msg("") {}
         uint32_t idx;
         shmap::Status status;
-        shmap::FixedString msg;
+        shmap::FixedString<> msg;
     };
 
 private:
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "shmap/atomic_bits_integer.h"
+
+using namespace shmap;
+
+namespace {
+    enum class Slot { State, Version, Owner };
+
+    using SlotWord = AtomicBitsInteger<uint32_t,
+        BitField<Slot::State,   0,  4>,
+        BitField<Slot::Version, 4,  12>,
+        BitField<Slot::Owner,   16, 16>
+    >;
+    using SlotBits = SlotWord::Bits;
+}
+
+TEST(AtomicBitsInteger, LoadStoreAndCompareExchange) {
+    SlotWord word;
+    EXPECT_EQ(word.Load().GetValue(), 0u);
+
+    SlotBits bits;
+    bits.Set<Slot::State>(2).Set<Slot::Owner>(100);
+    word.Store(bits);
+    EXPECT_EQ(word.Load().Get<Slot::State>(), 2u);
+    EXPECT_EQ(word.Load().Get<Slot::Owner>(), 100u);
+
+    SlotBits expected;  // stale expectation
+    SlotBits desired = SlotBits(bits).Set<Slot::State>(3);
+    EXPECT_FALSE(word.CompareExchange(expected, desired));
+    EXPECT_EQ(expected, bits);
+    EXPECT_TRUE(word.CompareExchange(expected, desired));
+    EXPECT_EQ(word.Load().Get<Slot::State>(), 3u);
+
+    EXPECT_EQ(word.Exchange(SlotBits()), desired);
+    EXPECT_EQ(word.Load().GetValue(), 0u);
+}
+
+TEST(AtomicBitsInteger, FetchUpdateField) {
+    SlotWord word(SlotBits().Set<Slot::Owner>(7));
+
+    auto old = word.FetchUpdate<Slot::State>([](uint32_t s) { return s + 5; });
+    ASSERT_TRUE(old.has_value());
+    EXPECT_EQ(old->Get<Slot::State>(), 0u);
+    EXPECT_EQ(word.Load().Get<Slot::State>(), 5u);
+    EXPECT_EQ(word.Load().Get<Slot::Owner>(), 7u);
+
+    // Result not fitting in 4 bits is rejected
+    EXPECT_FALSE(word.FetchUpdate<Slot::State>([](uint32_t) { return 16u; }).has_value());
+
+    // Visitor giving up
+    EXPECT_FALSE(word.FetchUpdate<Slot::State>([](uint32_t) -> std::optional<uint32_t> {
+        return std::nullopt;
+    }).has_value());
+    EXPECT_EQ(word.Load().Get<Slot::State>(), 5u);
+
+    // Whole word update
+    auto prev = word.FetchUpdate([](SlotBits b) { return b.Set<Slot::Version>(9); });
+    ASSERT_TRUE(prev.has_value());
+    EXPECT_EQ(word.Load().Get<Slot::Version>(), 9u);
+}
+
+TEST(AtomicBitsInteger, FetchAddChecksOverflow) {
+    SlotWord word;
+    ASSERT_TRUE(word.FetchAdd<Slot::Version>(4090).has_value());
+    EXPECT_TRUE(word.FetchAdd<Slot::Version>(5).has_value());
+    EXPECT_EQ(word.Load().Get<Slot::Version>(), 4095u);
+
+    // Would overflow into Owner
+    EXPECT_FALSE(word.FetchAdd<Slot::Version>(1).has_value());
+    EXPECT_EQ(word.Load().Get<Slot::Version>(), 4095u);
+    EXPECT_EQ(word.Load().Get<Slot::Owner>(), 0u);
+
+    EXPECT_TRUE(word.FetchSub<Slot::Version>(4095).has_value());
+    EXPECT_FALSE(word.FetchSub<Slot::Version>(1).has_value());
+    EXPECT_EQ(word.Load().GetValue(), 0u);
+}
+
+TEST(AtomicBitsInteger, ConcurrentFetchAddOnDifferentFields) {
+    SlotWord word;
+    constexpr int PER_THREAD = 2000;
+
+    std::thread versions([&] {
+        for (int i = 0; i < PER_THREAD; ++i) {
+            ASSERT_TRUE(word.FetchAdd<Slot::Version>(1).has_value());
+        }
+    });
+    std::thread owners([&] {
+        for (int i = 0; i < PER_THREAD * 2; ++i) {
+            ASSERT_TRUE(word.FetchAdd<Slot::Owner>(1).has_value());
+        }
+    });
+    versions.join();
+    owners.join();
+
+    EXPECT_EQ(word.Load().Get<Slot::Version>(), static_cast<uint32_t>(PER_THREAD));
+    EXPECT_EQ(word.Load().Get<Slot::Owner>(), static_cast<uint32_t>(PER_THREAD * 2));
+    EXPECT_EQ(word.Load().Get<Slot::State>(), 0u);
+}
@@ -12,12 +12,32 @@ using namespace shmap;
 using namespace std::chrono_literals;
 
 namespace {
+    // Wall-clock upper bounds only catch gross mistakes, sanitizers slow everything down
+#if defined(__SANITIZE_THREAD__) || defined(__SANITIZE_ADDRESS__)
+    constexpr int SLOWDOWN = 20;
+#else
+    constexpr int SLOWDOWN = 1;
+#endif
+
     // Hash table disabled rollback
     using Table = ShmHashTable<int,int,16>;
 
     // Hash table enabled rollback
     using RbTable = ShmHashTable<int, int, 16, std::hash<int>, std::equal_to<int>, true>;
 
+    // Reads whatever the test sets, e.g. a TSC a little behind after a migration
+    struct ScriptedClock {
+        using Ticks = uint64_t;
+        static inline Ticks now = 0;
+
+        static Ticks Now() noexcept { return now; }
+        static Ticks FromNanos(std::chrono::nanoseconds ns) noexcept { return static_cast<Ticks>(ns.count()); }
+    };
+
+    struct ScriptedPolicy : YieldSleepBackoffPolicy {
+        using Clock = ScriptedClock;
+    };
+
     template<typename TABLE>
     static std::pair<bool,int> peek(TABLE& table, int key) {
         bool found = false;
@@ -127,31 +147,103 @@ TEST(TimeoutTest, VisitorHoldLockCausesTimeout) {
 }
 
 TEST(BackoffTest, LateAverageGreaterThanEarly) {
-    constexpr int YIELD_LIMIT = 10;
-    constexpr int LATE_STEPS  = 10;
+    // Early steps are pause spinning, late steps are past the yield phase and sleep
+    constexpr uint32_t EARLY_STEPS = DefaultBackoffPolicy::SPIN_LIMIT;
+    constexpr uint32_t SKIP_STEPS  = DefaultBackoffPolicy::YIELD_LIMIT;
+    constexpr uint32_t LATE_STEPS  = 10;
 
     Backoff bf(std::chrono::seconds(1));
 
     std::vector<long long> early, late;
-    early.reserve(YIELD_LIMIT);
+    early.reserve(EARLY_STEPS);
     late .reserve(LATE_STEPS);
 
-    for(int i = 0; i < YIELD_LIMIT; ++i) {
+    for(uint32_t i = 0; i < EARLY_STEPS; ++i) {
         auto t0 = std::chrono::high_resolution_clock::now();
         EXPECT_TRUE(bf.next());
 
         auto t1 = std::chrono::high_resolution_clock::now();
-        early.push_back(std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count());
+        early.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    }
+    for(uint32_t i = 0; i < SKIP_STEPS; ++i) {
+        EXPECT_TRUE(bf.next());
     }
-    for(int i = 0; i < LATE_STEPS; ++i) {
+    for(uint32_t i = 0; i < LATE_STEPS; ++i) {
         auto t0 = std::chrono::high_resolution_clock::now();
         EXPECT_TRUE(bf.next());
         auto t1 = std::chrono::high_resolution_clock::now();
-        late.push_back( std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count());
+        late.push_back( std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
     }
+    EXPECT_EQ(bf.steps(), EARLY_STEPS + SKIP_STEPS + LATE_STEPS);
 
-    double avg_early = std::accumulate(early.begin(),  early.end(), 0.0) / YIELD_LIMIT;
+    double avg_early = std::accumulate(early.begin(),  early.end(), 0.0) / EARLY_STEPS;
     double avg_late  = std::accumulate(late.begin(),   late.end(),  0.0) / LATE_STEPS;
 
-    EXPECT_GT(avg_late, avg_early * 1.5) << "avg_early=" << avg_early << "us, avg_late=" << avg_late << "us";
-}
\ No newline at end of file
+    EXPECT_GT(avg_late, avg_early * 1.5) << "avg_early=" << avg_early << "ns, avg_late=" << avg_late << "ns";
+}
+
+TEST(BackoffTest, SpinPhaseStaysShort) {
+    // All pause steps together are far below a single scheduler tick
+    Backoff bf(std::chrono::seconds(1));
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < DefaultBackoffPolicy::SPIN_LIMIT; ++i) {
+        ASSERT_TRUE(bf.next());
+    }
+    auto dur = std::chrono::steady_clock::now() - t0;
+    EXPECT_LT(dur, 10ms * SLOWDOWN);
+}
+
+namespace {
+    template<typename BACKOFF>
+    std::chrono::nanoseconds RunUntilTimeout(std::chrono::nanoseconds timeout) {
+        auto t0 = std::chrono::steady_clock::now();
+        BACKOFF backoff(timeout);
+        while (backoff.next()) {}
+        return std::chrono::steady_clock::now() - t0;
+    }
+}
+
+TEST(BackoffTest, TimeoutWithEachPolicy) {
+    for (auto timeout : {0ms, 20ms}) {
+        auto slow = RunUntilTimeout<BasicBackoff<YieldSleepBackoffPolicy>>(timeout);
+        auto fast = RunUntilTimeout<Backoff>(timeout);
+
+        EXPECT_GE(slow, timeout);
+        EXPECT_LT(slow, timeout + 200ms * SLOWDOWN);
+        // TSC rate is calibrated, allow a little error
+        EXPECT_GE(fast, timeout * 99 / 100);
+        EXPECT_LT(fast, timeout + 200ms * SLOWDOWN);
+    }
+}
+
+TEST(BackoffTest, TscClockTicksAdvance) {
+    auto t0 = TscClock::Now();
+    std::this_thread::sleep_for(2ms);
+    auto t1 = TscClock::Now();
+    EXPECT_GE(t1 - t0, TscClock::FromNanos(1ms));
+    EXPECT_LT(t1 - t0, TscClock::FromNanos(1s));
+    EXPECT_EQ(TscClock::FromNanos(-1ns), 0u);
+}
+
+TEST(BackoffTest, ClockReadingBehindStartIsNoTimeout) {
+    BasicBackoff<ScriptedPolicy> backoff(100ns);
+    ScriptedClock::now = 1000;
+    ASSERT_TRUE(backoff.next());
+    ScriptedClock::now = 990;
+    EXPECT_TRUE(backoff.next());
+    ScriptedClock::now = 1100;
+    EXPECT_TRUE(backoff.next());
+    ScriptedClock::now = 1101;
+    EXPECT_FALSE(backoff.next());
+}
+
+TEST(BackoffTest, TableWithCustomBackoff) {
+    struct YieldSleepOptions : TableOptions {
+        using Backoff = BasicBackoff<YieldSleepBackoffPolicy>;
+    };
+    ShmHashTable<int, int, 16, std::hash<int>, std::equal_to<int>, false, YieldSleepOptions> table;
+    ASSERT_TRUE(table.Visit(1, AccessMode::CreateIfMiss, [](auto, int& v, bool) { v = 1; }));
+    auto [found, val] = peek(table, 1);
+    ASSERT_TRUE(found);
+    ASSERT_EQ(val, 1);
+}
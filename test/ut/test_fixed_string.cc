@@ -17,26 +17,27 @@ namespace {
 }
 
 TEST(FixedStringBasic, FromAndToString) {
-    FixedString fs = FixedString::FromString("hello");
+    FixedString<> fs = FixedString<>::FromString("hello");
     ASSERT_EQ(fs.ToString(), "hello");
 
     // Empty string
-    FixedString fs2 = FixedString::FromString("");
+    FixedString<> fs2 = FixedString<>::FromString("");
     ASSERT_EQ(fs2.ToString(), "");
 
-    // Default-constructed should be zeroed → empty
-    // FixedString fs3;
-    // ASSERT_EQ(fs3.ToString(), "");
+    // Default-constructed should be empty
+    FixedString<> fs3;
+    ASSERT_EQ(fs3.ToString(), "");
+    ASSERT_TRUE(fs3.empty());
 }
 
 TEST(FixedStringBasic, StoreAndPadding) {
     std::string s = "abc";
-    FixedString fs = FixedString::FromString(s);
+    FixedString<> fs = FixedString<>::FromString(s);
     ASSERT_EQ(fs.ToString(), s);
 
     // Truncation
     std::string long_s = make_long_string(FIXED_STR_LEN_MAX + 10, 'z');
-    FixedString fs_long = FixedString::FromString(long_s);
+    FixedString<> fs_long = FixedString<>::FromString(long_s);
 
     // Since no '\0' in first FIXED_STR_LEN_MAX bytes, ToString returns FIXED_STR_LEN_MAX chars
     std::string ts = fs_long.ToString();
@@ -47,10 +48,10 @@ TEST(FixedStringBasic, StoreAndPadding) {
 }
 
 TEST(FixedStringCompare, FixedStringVsFixedString) {
-    FixedString a = FixedString::FromString("abc");
-    FixedString b = FixedString::FromString("abc");
-    FixedString c = FixedString::FromString("abcd");
-    FixedString d = FixedString::FromString("ab");
+    FixedString<> a = FixedString<>::FromString("abc");
+    FixedString<> b = FixedString<>::FromString("abc");
+    FixedString<> c = FixedString<>::FromString("abcd");
+    FixedString<> d = FixedString<>::FromString("ab");
 
     ASSERT_TRUE(a == b);
     ASSERT_FALSE(a != b);
@@ -62,8 +63,28 @@ TEST(FixedStringCompare, FixedStringVsFixedString) {
     ASSERT_TRUE(a <= b);
 }
 
+TEST(FixedStringBasic, CompileTimeCapacity) {
+    static_assert(FixedString<16>::capacity() == 16);
+    static_assert(sizeof(FixedString<16>) < sizeof(FixedString<32>));
+
+    FixedString<16> sym = FixedString<16>::FromString("AAPL.NASDAQ");
+    ASSERT_EQ(sym.size(), 11u);
+    ASSERT_EQ(sym.ToString(), "AAPL.NASDAQ");
+
+    // Truncated to the capacity
+    FixedString<16> longSym = FixedString<16>::FromString(make_long_string(20, 'q'));
+    ASSERT_EQ(longSym.size(), 16u);
+    ASSERT_EQ(longSym.ToString(), make_long_string(16, 'q'));
+
+    // Reassigning a shorter value only keeps the new bytes
+    sym = "IBM";
+    ASSERT_EQ(sym.size(), 3u);
+    ASSERT_EQ(sym, FixedString<16>("IBM"));
+    ASSERT_EQ(std::hash<FixedString<16>>()(sym), std::hash<FixedString<16>>()(FixedString<16>("IBM")));
+}
+
 TEST(FixedStringCompare, FixedStringVsStdString) {
-    FixedString a = FixedString::FromString("foo");
+    FixedString<> a = FixedString<>::FromString("foo");
     std::string s1 = "foo";
     std::string s2 = "bar";
 
@@ -77,47 +98,70 @@ TEST(FixedStringCompare, FixedStringVsStdString) {
     ASSERT_TRUE(std::string("a") < a);
 }
 
+TEST(FixedStringCompare, FixedStringVsStringViewAndCString) {
+    FixedString<32> a("foo");
+    std::string_view sv = "foo";
+
+    ASSERT_EQ(a.View(), sv);
+    ASSERT_TRUE(a == sv);
+    ASSERT_TRUE(sv == a);
+    ASSERT_TRUE(a == "foo");
+    ASSERT_TRUE("foo" == a);
+    ASSERT_TRUE(a != "fo");
+    ASSERT_TRUE(a != "fooo");
+    ASSERT_TRUE(a < "fooo");
+    ASSERT_TRUE("fo" < a);
+    ASSERT_TRUE(a > std::string_view("bar"));
+    ASSERT_TRUE(a <= "foo");
+    ASSERT_TRUE(a >= "foo");
+
+    // Constructed from a view of a larger buffer
+    std::string buf = "foo:bar";
+    FixedString<32> b(std::string_view(buf).substr(0, 3));
+    ASSERT_EQ(a, b);
+}
+
 TEST(FixedStringStreaming, Ostream) {
-    FixedString a = FixedString::FromString("stream test");
+    FixedString<> a = FixedString<>::FromString("stream test");
     std::ostringstream oss;
     oss << a;
     ASSERT_EQ(oss.str(), "stream test");
 }
 
 TEST(FixedStringHash, UnorderedSetAndMap) {
-    FixedString a = FixedString::FromString("key1");
-    FixedString b = FixedString::FromString("key2");
-    FixedString a2 = FixedString::FromString("key1");
+    FixedString<> a = FixedString<>::FromString("key1");
+    FixedString<> b = FixedString<>::FromString("key2");
+    FixedString<> a2 = FixedString<>::FromString("key1");
 
     // unordered_set
-    std::unordered_set<FixedString> uset;
+    std::unordered_set<FixedString<>> uset;
     uset.insert(a);
     uset.insert(b);
     ASSERT_EQ(uset.size(), 2u);
     ASSERT_TRUE(uset.find(a2) != uset.end());
 
     // unordered_map
-    std::unordered_map<FixedString, int> umap;
+    std::unordered_map<FixedString<>, int> umap;
     umap[a] = 10;
     umap[b] = 20;
     ASSERT_EQ(umap[a2], 10);
-    ASSERT_EQ(umap[FixedString::FromString("key2")], 20);
+    ASSERT_EQ(umap[FixedString<>::FromString("key2")], 20);
 }
 
 TEST(FixedStringEqualTo, StdEqualToSpecialization) {
-    FixedString a = FixedString::FromString("xyz");
-    FixedString b = FixedString::FromString("xyz");
-    std::equal_to<FixedString> eq;
+    FixedString<> a = FixedString<>::FromString("xyz");
+    FixedString<> b = FixedString<>::FromString("xyz");
+    std::equal_to<FixedString<>> eq;
     ASSERT_TRUE(eq(a, b));
-    ASSERT_FALSE(eq(a, FixedString::FromString("xy")));
+    ASSERT_FALSE(eq(a, FixedString<>::FromString("xy")));
 }
 
 TEST(FixedStringFormat, FromFormatBasic) {
-    FixedString f1 = FixedString::FromFormat("Hello %s %d", "World", 123);
+    FixedString<> f1 = FixedString<>::FromFormat("Hello %s %d", "World", 123);
     ASSERT_EQ(f1.ToString(), "Hello World 123");
 
     // Leading zeros / width
-    FixedString f2 = FixedString::FromFormat("%04d-%02d", 7, 5);
+    FixedString<> f2 = FixedString<>::FromFormat("%04d-%02d", 7, 5);
     ASSERT_EQ(f2.ToString(), "0007-05");
 }
 
@@ -126,9 +170,46 @@ TEST(FixedStringFormat, FromFormatTruncation) {
     std::string pat = "%s";
     std::string big = make_long_string(FIXED_STR_LEN_MAX + 50, 'A');
     std::string fmt = pat;
-    FixedString f = FixedString::FromFormat(fmt.c_str(), big.c_str());
+    FixedString<> f = FixedString<>::FromFormat(fmt.c_str(), big.c_str());
     std::string out = f.ToString();
     // Should be truncated to FIXED_STR_LEN_MAX characters
-    ASSERT_EQ(out.size(), FIXED_STR_LEN_MAX - 1);
+    ASSERT_EQ(out.size(), FIXED_STR_LEN_MAX);
     for (char c : out) ASSERT_EQ(c, 'A');
-}
\ No newline at end of file
+
+    // Same cap as Store, an output of exactly N chars is kept whole
+    ASSERT_EQ(FixedString<4>::FromFormat("%d", 1234), FixedString<4>("12345"));
+    ASSERT_EQ(FixedString<4>::FromFormat("%d", 1234), "1234");
+}
+
+TEST(FixedStringFormat, FormatTypeSafe) {
+    auto key = FixedString<32>::Format("acct:{}:{}", 42u, "usd");
+    ASSERT_EQ(key, "acct:42:usd");
+
+    FixedString<16> sym("IBM");
+    auto mixed = FixedString<>::Format("{}|{}|{}|{}|{}|{}", -7, sym, std::string("s"), 'c', true, 1.5);
+    ASSERT_EQ(mixed, "-7|IBM|s|c|true|1.5");
+
+    // Escaped braces
+    ASSERT_EQ(FixedString<>::Format("{{{}}}", 1), "{1}");
+    ASSERT_EQ(FixedString<>::Format(""), "");
+}
+
+TEST(FixedStringFormat, FormatArgumentCountMismatch) {
+    // A placeholder without argument stays visible
+    ASSERT_EQ(FixedString<>::Format("a{}b{}c", 1), "a1b{?}c");
+    ASSERT_EQ(FixedString<>::Format("{}:{}"), "{?}:{?}");
+
+    // Extra arguments are appended, not dropped
+    ASSERT_EQ(FixedString<>::Format("x", 1, 2), "x{+1}{+2}");
+    ASSERT_EQ(FixedString<>::Format("id:{}", 7, "usd"), "id:7{+usd}");
+}
+
+TEST(FixedStringFormat, FormatTruncation) {
+    auto f = FixedString<8>::Format("id:{}", 123456789);
+    ASSERT_EQ(f.size(), 8u);
+    ASSERT_EQ(f, "id:12345");
+
+    FixedString<8> g("ab");
+    g.Append("cd", 12345678ull);
+    ASSERT_EQ(g, "abcd1234");
+}
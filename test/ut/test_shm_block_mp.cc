@@ -24,7 +24,7 @@ namespace {
     constexpr int         N_PROC       = 8;       // process count
     constexpr int         N_THR        = 4;       // thread per process
 
-    using Map   = ShmHashTable<FixedString, int, CAPACITY>;
+    using Map   = ShmHashTable<FixedString<>, int, CAPACITY>;
     using Block = ShmBlock<Map>;
 
     const char* SHM_PATH = "/shm_block_mp_test";
@@ -67,7 +67,7 @@ protected:
 
             for(std::size_t i = 0; i < PER_PROC_OPS; ++i){
                 int id = kd(rng);
-                auto k = FixedString::FromFormat("%d", id);
+                auto k = FixedString<>::FromFormat("%d", id);
 
                 // 70 % write， 30 % read */
                 if(i % 10 < 7){
@@ -110,7 +110,7 @@ TEST_F(ShmBlockMpTest, shm_block_multi_process_race_test) {
 
     long long total = 0;
     for(std::size_t id = 0; id < N_KEYS; ++id){
-        auto k = FixedString::FromFormat("%d", id);
+        auto k = FixedString<>::FromFormat("%d", id);
         (*blk)->Visit(k, AccessMode::AccessExist, [&](std::size_t id, int&v, bool){
             total+=v; 
         });
@@ -20,7 +20,7 @@ namespace {
     static constexpr std::size_t N_KEYS   = 1'000;
     static constexpr std::size_t OPS      = 100'000;     // operator count per thread
 
-    using Map   = ShmHashTable<FixedString, int, CAPACITY>;
+    using Map   = ShmHashTable<FixedString<>, int, CAPACITY>;
     using Block = ShmBlock<Map>;
 }
 
@@ -63,7 +63,7 @@ TEST_F(ShmBlockMtTest, shm_block_multi_thread_race_test)
 
         for(std::size_t i = 0; i < OPS; ++i) {
             int id  = key_dist(rng);
-            auto k = FixedString::FromFormat("key_%04zu", id);
+            auto k = FixedString<>::FromFormat("key_%04zu", id);
 
             int op  = op_dist(rng);
 
@@ -113,7 +113,7 @@ TEST_F(ShmBlockMtTest, shm_block_multi_thread_race_test)
     Block* block = Block::Open(sharedMem_);
 
     for(std::size_t id = 0; id < N_KEYS; ++id) {
-        auto k = FixedString::FromFormat("key_%04zu", id);
+        auto k = FixedString<>::FromFormat("key_%04zu", id);
         int got = 0;
 
         bool have = (*block)->Visit(k, AccessMode::AccessExist,
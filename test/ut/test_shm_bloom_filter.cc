@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <memory>
+#include <vector>
+
+#include "shmap/shm_bloom_filter.h"
+#include "shmap/shm_hash_table.h"
+
+using namespace shmap;
+
+TEST(ShmBloomFilterTest, NoFalseNegativesAndFewFalsePositives) {
+    constexpr std::size_t KEYS = 10000;
+    using Filter = ShmBloomFilter<BloomBlocksFor(KEYS)>;
+    static_assert(sizeof(Filter) == BloomBlocksFor(KEYS) * CACHE_LINE_SIZE, "blocks are cache lines");
+    auto filter = std::make_unique<Filter>();
+
+    // Identity hashes still spread; a new key only looks old on a false positive
+    std::size_t added = 0;
+    for (uint64_t k = 0; k < KEYS; ++k) {
+        added += filter->Add(k);
+    }
+    EXPECT_GT(added, KEYS * 99 / 100);
+    for (uint64_t k = 0; k < KEYS; ++k) {
+        ASSERT_TRUE(filter->MayContain(k));
+        EXPECT_FALSE(filter->Add(k));
+    }
+
+    std::size_t falsePositives = 0;
+    for (uint64_t k = KEYS; k < KEYS * 11; ++k) {
+        falsePositives += filter->MayContain(k);
+    }
+    EXPECT_LT(falsePositives, KEYS * 10 / 50); // under 2%
+    EXPECT_GT(filter->FillRatio(), 0.3);
+    EXPECT_LT(filter->FillRatio(), 0.6);
+
+    filter->Clear();
+    EXPECT_FALSE(filter->MayContain(1));
+    EXPECT_EQ(filter->FillRatio(), 0.0);
+}
+
+TEST(ShmBloomFilterTest, TableMissesStopAtTheFilter) {
+    struct FilteredOptions : TableOptions {
+        using Metrics = ShmTableMetrics;
+        using Filter  = ShmBloomFilter<BloomBlocksFor(1024)>;
+    };
+    using Table = ShmHashTable<uint64_t, uint64_t, 1024, std::hash<uint64_t>, std::equal_to<uint64_t>,
+        false, FilteredOptions>;
+    auto table = std::make_unique<Table>();
+
+    for (uint64_t k = 0; k < 500; ++k) {
+        table->Visit(k, AccessMode::CreateIfMiss, [k](auto, auto& v, bool) { v = k; });
+    }
+    ASSERT_EQ(table->VisitMulti({600, 601}, AccessMode::CreateIfMiss, [](auto&, const auto&) {}), Status::SUCCESS);
+    // A failed insert adds nothing
+    table->Visit(700, AccessMode::CreateIfMiss, [](auto, auto&, bool) { return Status::ERROR; });
+    EXPECT_FALSE(table->Filter().MayContain(std::hash<uint64_t>{}(700)));
+
+    for (uint64_t k : {0u, 499u, 600u, 601u}) {
+        EXPECT_EQ(table->Visit(k, AccessMode::AccessExist, [](auto, auto&, bool) {}), Status::SUCCESS) << k;
+    }
+    for (uint64_t k = 1000; k < 2000; ++k) {
+        EXPECT_EQ(table->Visit(k, AccessMode::AccessExist, [](auto, auto&, bool) {}), Status::NOT_FOUND);
+    }
+    EXPECT_EQ(table->VisitMulti({1, 5000}, AccessMode::AccessExist, [](auto&, const auto&) {}), Status::NOT_FOUND);
+
+    const auto& m = table->Metrics();
+    EXPECT_EQ(m.Get(TABLE_MISSES), 1001u);
+    EXPECT_GT(m.Get(TABLE_FILTERED), 950u);
+    EXPECT_LE(m.Get(TABLE_FILTERED), 1001u);
+    EXPECT_STREQ(MetricName(MetricKind::HashTable, TABLE_FILTERED), "filtered");
+}
+
+TEST(ShmBloomFilterTest, ProcessesDedupThroughOneFilter) {
+    using Filter = ShmBloomFilter<BloomBlocksFor(30000, 16)>;
+    struct Shared {
+        Filter filter;
+        std::atomic<uint64_t> added[3];
+    };
+    void* mem = mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0);
+    ASSERT_NE(mem, MAP_FAILED);
+    auto* shared = new (mem) Shared();
+
+    // Ranges overlap by half, each id is new to exactly one process or a racing pair
+    std::vector<pid_t> children;
+    for (uint64_t p = 0; p < 3; ++p) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            uint64_t added = 0;
+            for (uint64_t id = p * 5000; id < p * 5000 + 10000; ++id) {
+                added += shared->filter.Add(id * 0x9e3779b97f4a7c15ULL);
+            }
+            shared->added[p] = added;
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    }
+
+    for (uint64_t id = 0; id < 20000; ++id) {
+        ASSERT_TRUE(shared->filter.MayContain(id * 0x9e3779b97f4a7c15ULL));
+    }
+    const uint64_t added = shared->added[0] + shared->added[1] + shared->added[2];
+    EXPECT_GT(added, 20000u * 98 / 100);
+    EXPECT_LE(added, 30000u);
+    munmap(mem, sizeof(Shared));
+}
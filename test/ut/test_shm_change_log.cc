@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "shmap/shm_change_log.h"
+#include "shmap/shm_hash_table.h"
+
+using namespace shmap;
+
+namespace {
+    using Log   = ShmChangeLog<uint64_t, 8>;
+    struct LoggedOptions : TableOptions {
+        using ChangeLog = Log;
+    };
+    using Table = ShmHashTable<uint64_t, uint64_t, 64, std::hash<uint64_t>, std::equal_to<uint64_t>,
+        false, LoggedOptions>;
+
+    std::vector<Log::Record> Drain(Log::Reader& reader) {
+        std::vector<Log::Record> out;
+        reader.Poll([&out](const Log::Record& r) { out.push_back(r); });
+        return out;
+    }
+}
+
+TEST(ShmChangeLogTest, LogsInsertsAndRealUpdates) {
+    auto table = std::make_unique<Table>();
+    auto reader = table->ChangeLog().Subscribe();
+
+    table->Visit(1, AccessMode::CreateIfMiss, [](auto, auto& v, bool) { v = 10; });
+    table->Visit(1, AccessMode::AccessExist, [](auto, auto& v, bool) { v = 11; });
+    table->Visit(1, AccessMode::AccessExist, [](auto, auto&, bool) {});                           // read only
+    table->Visit(1, AccessMode::AccessExist, [](auto, auto& v, bool) { v = 12; return Status::ERROR; }); // failed
+    table->Visit(2, AccessMode::CreateIfMiss, [](auto, auto&, bool) { return Status::ERROR; });  // not inserted
+
+    auto records = Drain(reader);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].op, ChangeOp::Insert);
+    EXPECT_EQ(records[0].key, 1u);
+    EXPECT_EQ(records[0].version, 1u);
+    EXPECT_EQ(records[1].op, ChangeOp::Update);
+    EXPECT_EQ(records[1].version, 2u);
+    EXPECT_EQ(records[1].idx, records[0].idx);
+
+    // Updates through Travel and VisitMulti are logged too
+    table->Travel([](auto, const auto& k, auto& v) { if (k == 1) v = 20; });
+    table->VisitMulti({1, 3}, AccessMode::CreateIfMiss, [](auto& values, const auto&) { *values[0] += 1; });
+    records = Drain(reader);
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[0].op, ChangeOp::Update);
+    EXPECT_EQ(records[1].op, ChangeOp::Update); // key 1 comes first in bucket order
+    EXPECT_EQ(records[1].key, 1u);
+    EXPECT_EQ(records[2].op, ChangeOp::Insert);
+    EXPECT_EQ(records[2].key, 3u);
+    EXPECT_EQ(table->ChangeLog().Version(), 5u);
+    EXPECT_EQ(reader.Lost(), 0u);
+}
+
+TEST(ShmChangeLogTest, SlowReaderCountsLostRecords) {
+    auto log = std::make_unique<Log>();
+    auto early = log->SubscribeFrom(1);
+    for (uint64_t k = 0; k < 20; ++k) {
+        log->Append(ChangeOp::Insert, k, k);
+    }
+    EXPECT_EQ(early.Pending(), 20u);
+
+    auto records = Drain(early);
+    ASSERT_EQ(records.size(), 8u);
+    EXPECT_EQ(early.Lost(), 12u);
+    EXPECT_EQ(records.front().version, 13u);
+    EXPECT_EQ(records.back().key, 19u);
+
+    // A late subscriber only sees what comes next
+    auto late = log->Subscribe();
+    EXPECT_EQ(Drain(late).size(), 0u);
+    log->Append(ChangeOp::Update, 0, 42);
+    EXPECT_EQ(late.Poll([](const Log::Record& r) { EXPECT_EQ(r.key, 42u); }, 1), 1u);
+}
+
+TEST(ShmChangeLogTest, ReadersSkipARecordItsWriterNeverPublished) {
+    auto log = std::make_unique<Log>();
+    for (uint64_t k = 0; k < 3; ++k) {
+        log->Append(ChangeOp::Insert, k, k);
+    }
+    // A writer dying between its claim and its publish: head moved on, slot 3 left odd.
+    // The head leads the object and slot k starts k slots after the first cache line.
+    auto* bytes = reinterpret_cast<uint8_t*>(log.get());
+    const std::size_t slotBytes = (sizeof(Log) - CACHE_LINE_SIZE) / 8;
+    reinterpret_cast<std::atomic<uint64_t>*>(bytes)->fetch_add(1);
+    reinterpret_cast<std::atomic<uint64_t>*>(bytes + CACHE_LINE_SIZE + 3 * slotBytes)
+        ->store(SlotSequence::Writing(3));
+
+    auto reader = log->SubscribeFrom(1);
+    EXPECT_EQ(Drain(reader).size(), 3u);
+
+    // Waited for while the head is near, given up STALL_RECORDS records later
+    log->Append(ChangeOp::Insert, 4, 4);
+    EXPECT_TRUE(Drain(reader).empty());
+    EXPECT_EQ(reader.Lost(), 0u);
+    for (uint64_t k = 5; k < 4 + Log::STALL_RECORDS; ++k) {
+        log->Append(ChangeOp::Insert, k, k);
+    }
+    auto records = Drain(reader);
+    ASSERT_EQ(records.size(), Log::STALL_RECORDS);
+    EXPECT_EQ(records.front().version, 5u);
+    EXPECT_EQ(reader.Lost(), 1u);
+
+    // The writer a lap later gives its record up at once for every reader
+    for (uint64_t k = 4 + Log::STALL_RECORDS; k <= 11; ++k) {
+        log->Append(ChangeOp::Insert, k, k);
+    }
+    auto late = log->SubscribeFrom(12);
+    EXPECT_TRUE(Drain(late).empty());
+    EXPECT_EQ(late.Lost(), 1u);
+    EXPECT_EQ(Drain(reader).size(), 3u);
+    EXPECT_EQ(reader.Lost(), 2u);
+}
+
+TEST(ShmChangeLogTest, ParentFollowsChildProcessMutations) {
+    void* mem = mmap(nullptr, sizeof(Table), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0);
+    ASSERT_NE(mem, MAP_FAILED);
+    auto* table = new (mem) Table();
+    auto reader = table->ChangeLog().Subscribe();
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        for (uint64_t k = 0; k < 5; ++k) {
+            table->Visit(k, AccessMode::CreateIfMiss, [k](auto, auto& v, bool) { v = k; });
+        }
+        _exit(0);
+    }
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+
+    // The follower keeps a sum in sync from the log alone
+    uint64_t sum = 0;
+    EXPECT_EQ(reader.Poll([&](const Log::Record& r) {
+        table->Visit(r.key, AccessMode::AccessExist, [&](auto, auto& v, bool) { sum += v; });
+    }), 5u);
+    EXPECT_EQ(sum, 0u + 1 + 2 + 3 + 4);
+    munmap(mem, sizeof(Table));
+}
+
+TEST(ShmChangeLogTest, WritersLapsApartNeverTearARecord) {
+    auto log = std::make_unique<Log>();
+    auto reader = log->SubscribeFrom(1);
+
+    // Twice as many writers as slots keep lapping each other; every field follows the key
+    constexpr uint64_t WRITERS    = 16;
+    constexpr uint64_t PER_WRITER = 50000;
+    std::atomic<bool> done{false};
+    std::vector<std::thread> writers;
+    for (uint64_t w = 0; w < WRITERS; ++w) {
+        writers.emplace_back([&log, w]() {
+            for (uint64_t i = 0; i < PER_WRITER; ++i) {
+                const uint64_t key = (w << 32) | i;
+                log->Append(i & 1 ? ChangeOp::Update : ChangeOp::Insert, static_cast<uint32_t>(key * 7), key);
+            }
+        });
+    }
+    std::thread follower([&]() {
+        uint64_t last = 0;
+        while (!done.load()) {
+            reader.Poll([&](const Log::Record& r) {
+                EXPECT_GT(r.version, last);
+                last = r.version;
+                EXPECT_EQ(r.idx, static_cast<uint32_t>(r.key * 7)) << r.version;
+                EXPECT_EQ(r.op, r.key & 1 ? ChangeOp::Update : ChangeOp::Insert) << r.version;
+            });
+        }
+    });
+    for (auto& t : writers) {
+        t.join();
+    }
+    done = true;
+    follower.join();
+    EXPECT_EQ(log->Version(), WRITERS * PER_WRITER);
+}
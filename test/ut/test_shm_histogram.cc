@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "shmap/shm_histogram.h"
+
+using namespace shmap;
+
+TEST(ShmHistogramTest, BucketsCoverTheRangeWithBoundedError) {
+    using B = LogLinearBuckets<3>;
+    EXPECT_EQ(B::IndexOf(0), 0u);
+    EXPECT_EQ(B::IndexOf(7), 7u);
+    EXPECT_EQ(B::IndexOf(8), 8u);
+    EXPECT_EQ(B::IndexOf(UINT64_MAX), B::BUCKETS - 1);
+    EXPECT_EQ(B::UpperBound(B::BUCKETS - 1), UINT64_MAX);
+
+    for (uint64_t v : {1ull, 9ull, 100ull, 1000ull, 123456789ull, 1ull << 40, (1ull << 63) + 5}) {
+        const uint32_t idx = B::IndexOf(v);
+        EXPECT_LE(B::LowerBound(idx), v);
+        EXPECT_GE(B::UpperBound(idx), v);
+        EXPECT_LE(static_cast<double>(v - B::LowerBound(idx)), v / 8.0);
+    }
+    // Buckets are contiguous
+    for (uint32_t i = 0; i + 1 < B::BUCKETS; ++i) {
+        ASSERT_EQ(B::UpperBound(i) + 1, B::LowerBound(i + 1));
+    }
+}
+
+TEST(ShmHistogramTest, SnapshotPercentilesAndMerge) {
+    HistogramSnapshot<> a, b;
+    EXPECT_EQ(a.Percentile(0.5), 0u);
+    for (uint64_t v = 1; v <= 1000; ++v) {
+        (v % 2 ? a : b).Record(v);
+    }
+    a.Merge(b);
+    EXPECT_EQ(a.Count(), 1000u);
+    EXPECT_EQ(a.Min(), 1u);
+    EXPECT_EQ(a.Max(), 1000u);
+    EXPECT_DOUBLE_EQ(a.Mean(), 500.5);
+
+    auto near = [](uint64_t got, double want) {
+        return got <= want && got >= want * 0.875;
+    };
+    EXPECT_TRUE(near(a.Percentile(0.5), 500));
+    EXPECT_TRUE(near(a.Percentile(0.99), 990));
+    EXPECT_EQ(a.Percentile(0.0), 1u);
+    EXPECT_EQ(a.Percentile(1.0), 960u); // lower bound of the bucket holding 1000
+
+    a.Reset();
+    EXPECT_EQ(a.Count(), 0u);
+    EXPECT_EQ(a.Min(), 0u);
+}
+
+TEST(ShmHistogramTest, ThreadsRecordIntoShards) {
+    auto hist = std::make_unique<ShmHistogram<3, 4>>();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&hist, t] {
+            for (uint64_t i = 0; i < 10000; ++i) hist->Record(100 + t, 1);
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    auto snap = hist->Read();
+    EXPECT_EQ(snap.Count(), 40000u);
+    EXPECT_EQ(snap.Min(), 100u);
+    EXPECT_EQ(snap.Max(), 103u);
+    EXPECT_EQ(snap.Sum(), 10000u * (100 + 101 + 102 + 103));
+
+    hist->Reset();
+    EXPECT_EQ(hist->Read().Count(), 0u);
+    EXPECT_EQ(hist->Read().Min(), 0u);
+}
+
+TEST(ShmHistogramTest, ProcessesShareOneHistogram) {
+    using Hist = ShmHistogram<3, 2>;
+    void* mem = mmap(nullptr, sizeof(Hist), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0);
+    ASSERT_NE(mem, MAP_FAILED);
+    auto* hist = new (mem) Hist();
+
+    std::vector<pid_t> children;
+    for (uint64_t p = 0; p < 3; ++p) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            for (uint64_t i = 1; i <= 1000; ++i) hist->Record(i * (p + 1));
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    }
+
+    auto snap = hist->Read();
+    EXPECT_EQ(snap.Count(), 3000u);
+    EXPECT_EQ(snap.Max(), 3000u);
+
+    // Several shm histograms merge into one snapshot
+    HistogramSnapshot<> total = snap;
+    hist->ReadInto(total);
+    EXPECT_EQ(total.Count(), 6000u);
+    munmap(mem, sizeof(Hist));
+}
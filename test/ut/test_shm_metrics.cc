@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "shmap/shm_metrics.h"
+#include "shmap/shm_hash_table.h"
+#include "shmap/shm_ring_buffer.h"
+
+using namespace shmap;
+
+namespace {
+    struct CountedOptions : TableOptions {
+        using Metrics = ShmTableMetrics;
+    };
+    using Table = ShmHashTable<uint64_t, uint64_t, 64, std::hash<uint64_t>, std::equal_to<uint64_t>,
+        false, CountedOptions>;
+    using Ring = ShmRingBuffer<int, 8, ShmRingMetrics>;
+}
+
+TEST(ShmMetricsTest, NoMetricsAddsNothing) {
+    using Plain = ShmHashTable<uint64_t, uint64_t, 64>;
+    struct PlainOptions : TableOptions {
+        using Metrics = NoMetrics;
+    };
+    EXPECT_EQ(sizeof(Plain), sizeof(ShmHashTable<uint64_t, uint64_t, 64, std::hash<uint64_t>,
+        std::equal_to<uint64_t>, false, PlainOptions>));
+    EXPECT_FALSE(NoMetrics::ENABLED);
+    EXPECT_TRUE(ShmTableMetrics::ENABLED);
+}
+
+TEST(ShmMetricsTest, CountsTableVisits) {
+    auto table = std::make_unique<Table>();
+
+    for (uint64_t k = 0; k < 10; ++k) {
+        ASSERT_EQ(table->Visit(k, AccessMode::CreateIfMiss, [](auto, auto& v, bool) { v = 1; }), Status::SUCCESS);
+    }
+    for (uint64_t k = 0; k < 5; ++k) {
+        ASSERT_EQ(table->Visit(k, AccessMode::AccessExist, [](auto, auto& v, bool) { ++v; }), Status::SUCCESS);
+    }
+    EXPECT_EQ(table->Visit(100, AccessMode::AccessExist, [](auto, auto&, bool) {}), Status::NOT_FOUND);
+    EXPECT_EQ(table->Visit(1, AccessMode::AccessExist, [](auto, auto&, bool) { return Status::ERROR; }), Status::ERROR);
+    ASSERT_EQ(table->Travel([](auto, auto&, auto&) {}), Status::SUCCESS);
+
+    const auto& m = table->Metrics();
+    EXPECT_EQ(m.Get(TABLE_VISITS), 17u);
+    EXPECT_EQ(m.Get(TABLE_INSERTS), 10u);
+    EXPECT_EQ(m.Get(TABLE_MISSES), 1u);
+    EXPECT_EQ(m.Get(TABLE_FAILURES), 1u);
+    EXPECT_EQ(m.Get(TABLE_TIMEOUTS), 0u);
+    EXPECT_EQ(m.Get(TABLE_TRAVELS), 1u);
+}
+
+TEST(ShmMetricsTest, CountsTableTimeoutsAndBackoff) {
+    auto table = std::make_unique<Table>();
+    ASSERT_EQ(table->Visit(7, AccessMode::CreateIfMiss, [](auto, auto&, bool) {}), Status::SUCCESS);
+
+    // Visit the key again while it is held, the nested visit has to wait and times out
+    Status inner = Status::SUCCESS;
+    ASSERT_EQ(table->Visit(7, AccessMode::AccessExist, [&](auto, auto&, bool) {
+        inner = table->Visit(7, AccessMode::AccessExist, [](auto, auto&, bool) {}, std::chrono::milliseconds(1));
+    }), Status::SUCCESS);
+    EXPECT_EQ(inner, Status::TIMEOUT);
+
+    EXPECT_EQ(table->Metrics().Get(TABLE_TIMEOUTS), 1u);
+    EXPECT_GT(table->Metrics().Get(TABLE_BACKOFF_STEPS), 0u);
+}
+
+TEST(ShmMetricsTest, CountsRingOpsAndHighWater) {
+    Ring ring;
+    for (int i = 0; i < 10; ++i) {
+        ring.push(i); // the last two are rejected
+    }
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(ring.pop());
+    }
+    ASSERT_TRUE(ring.push(10));
+    while (ring.pop()) {}
+
+    const auto& m = ring.metrics();
+    EXPECT_EQ(m.Get(RING_PUSHES), 9u);
+    EXPECT_EQ(m.Get(RING_PUSH_FULL), 2u);
+    EXPECT_EQ(m.Get(RING_POPS), 9u);
+    EXPECT_EQ(m.Get(RING_POP_EMPTY), 1u);
+    EXPECT_EQ(m.GetGauge(RING_DEPTH_HIGH_WATER), 8u);
+}
+
+TEST(ShmMetricsTest, ThreadsUseSeparateShards) {
+    ShmTableMetrics metrics;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&metrics] {
+            for (int i = 0; i < 10000; ++i) metrics.Add(TABLE_VISITS);
+        });
+    }
+    for (auto& t : threads) t.join();
+    EXPECT_EQ(metrics.Get(TABLE_VISITS), 40000u);
+
+    metrics.Reset();
+    EXPECT_EQ(metrics.Read().counters[TABLE_VISITS], 0u);
+}
+
+TEST(ShmMetricsTest, ForkedChildCountsIntoSharedBlock) {
+    void* mem = mmap(nullptr, sizeof(ShmTableMetrics), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0);
+    ASSERT_NE(mem, MAP_FAILED);
+    auto* metrics = new (mem) ShmTableMetrics();
+    metrics->Add(TABLE_VISITS);
+    const uint32_t parentHint = detail::MetricsShardHint();
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        // A new hint after fork, so parent and child do not share a shard by default
+        bool rehashed = detail::MetricsShardHint() != parentHint;
+        for (int i = 0; i < 100; ++i) metrics->Add(TABLE_VISITS);
+        _exit(rehashed ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    EXPECT_EQ(metrics->Get(TABLE_VISITS), 101u);
+    munmap(mem, sizeof(ShmTableMetrics));
+}
+
+TEST(ShmMetricsTest, ViewScansForBlocks) {
+    struct Both {
+        Table table;
+        Ring ring;
+    };
+    auto both = std::make_unique<Both>();
+    both->table.Visit(1, AccessMode::CreateIfMiss, [](auto, auto&, bool) {});
+    both->ring.push(1);
+
+    std::vector<std::pair<std::size_t, ShmMetricsView>> found;
+    ShmMetricsView::Scan(both.get(), sizeof(Both), [&](std::size_t off, const ShmMetricsView& view) {
+        found.emplace_back(off, view);
+    });
+    ASSERT_EQ(found.size(), 2u);
+    EXPECT_EQ(found[0].second.Kind(), MetricKind::HashTable);
+    EXPECT_EQ(found[0].second.Shards(), 16u);
+    EXPECT_EQ(found[0].second.Get(TABLE_VISITS), 1u);
+    EXPECT_EQ(found[0].second.Get(TABLE_INSERTS), 1u);
+    EXPECT_EQ(found[1].second.Kind(), MetricKind::RingBuffer);
+    EXPECT_EQ(found[1].second.Get(RING_PUSHES), 1u);
+    EXPECT_EQ(found[1].second.GetGauge(RING_DEPTH_HIGH_WATER), 1u);
+    EXPECT_STREQ(MetricName(MetricKind::RingBuffer, RING_PUSH_FULL), "push_full");
+
+    // A block cut off by the end of the range is not reported
+    std::size_t cut = found[1].first + ShmMetricsView::SizeOf(16) - 1;
+    EXPECT_FALSE(ShmMetricsView::At(reinterpret_cast<const uint8_t*>(both.get()) + found[1].first,
+        cut - found[1].first).Valid());
+}
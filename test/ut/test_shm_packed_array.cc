@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "shmap/shm_packed_array.h"
+
+using namespace shmap;
+
+namespace {
+    template<std::size_t BITS, std::size_t N, typename OutT>
+    void CheckRoundTrip(uint64_t seed) {
+        auto* arr = new ShmPackedArray<BITS, N>();
+        std::vector<uint32_t> expected(N);
+        std::mt19937_64 rng(seed);
+        for (std::size_t i = 0; i < N; ++i) {
+            expected[i] = static_cast<uint32_t>(rng() & ShmPackedArray<BITS, N>::MASK);
+            arr->Set(i, expected[i]);
+        }
+        for (std::size_t i = 0; i < N; ++i) {
+            ASSERT_EQ(arr->Get(i), expected[i]) << "BITS=" << BITS << " i=" << i;
+        }
+
+        // Bulk decode with unaligned start and length
+        for (std::size_t start : {std::size_t(0), std::size_t(1), std::size_t(13), N / 2}) {
+            std::vector<OutT> out(N, 0);
+            std::size_t n = arr->Decode(start, N, out.data());
+            ASSERT_EQ(n, N - start);
+            for (std::size_t i = 0; i < n; ++i) {
+                ASSERT_EQ(out[i], expected[start + i]) << "BITS=" << BITS << " start=" << start << " i=" << i;
+            }
+        }
+        delete arr;
+    }
+}
+
+TEST(ShmPackedArrayTest, SetGetDecodeRoundTrip) {
+    CheckRoundTrip<1, 1000, uint8_t>(1);
+    CheckRoundTrip<3, 1000, uint8_t>(3);
+    CheckRoundTrip<8, 1000, uint8_t>(8);
+    CheckRoundTrip<5, 1000, uint32_t>(5);
+    CheckRoundTrip<12, 1000, uint16_t>(12);
+    CheckRoundTrip<16, 1000, uint16_t>(16);
+    CheckRoundTrip<21, 1000, uint32_t>(21);
+    CheckRoundTrip<32, 1000, uint32_t>(32);
+}
+
+TEST(ShmPackedArrayTest, DensePacking) {
+    static_assert(ShmPackedArray<3, 1 << 20>::PER_WORD == 21);
+    static_assert(sizeof(ShmPackedArray<3, 1 << 20>) * 8 < (1 << 20) * 4);
+    static_assert(ShmPackedArray<12, 10>::max_value() == 4095);
+
+    ShmPackedArray<3, 64> arr;
+    arr.Set(5, 0xF);  // truncated to 3 bits
+    EXPECT_EQ(arr.Get(5), 7u);
+    EXPECT_EQ(arr.Get(4), 0u);
+    EXPECT_EQ(arr.Get(6), 0u);
+    EXPECT_EQ(arr.Decode(60, 10, std::vector<uint8_t>(10).data()), 4u);
+}
+
+TEST(ShmPackedArrayTest, CompareExchange) {
+    ShmPackedArray<4, 16> arr;
+    uint32_t expected = 1;
+    EXPECT_FALSE(arr.CompareExchange(3, expected, 9));
+    EXPECT_EQ(expected, 0u);
+    EXPECT_TRUE(arr.CompareExchange(3, expected, 9));
+    EXPECT_EQ(arr.Get(3), 9u);
+}
+
+TEST(ShmPackedArrayTest, ConcurrentSetOnSameWord) {
+    // 21 elements of 3 bits share one word, each thread owns some of them
+    constexpr int THREADS = 7;
+    ShmPackedArray<3, 21> arr;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&arr, t] {
+            for (int round = 0; round < 2000; ++round) {
+                for (std::size_t i = t; i < 21; i += THREADS) {
+                    arr.Set(i, (round + t) & 7);
+                }
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    for (std::size_t i = 0; i < 21; ++i) {
+        EXPECT_EQ(arr.Get(i), static_cast<uint32_t>((1999 + i % THREADS) & 7));
+    }
+}
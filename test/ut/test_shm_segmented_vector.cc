@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "shmap/shm_segmented_vector.h"
+#include "process_launcher.h"
+
+using namespace shmap;
+
+namespace {
+    struct SegPath { static constexpr const char* value = "/shm_segmented_vector_test"; };
+    struct SegMpPath { static constexpr const char* value = "/shm_segmented_vector_mp_test"; };
+    struct SegFailPath { static constexpr const char* value = "/shm_segmented_vector_fail_test"; };
+    struct SegCommitPath { static constexpr const char* value = "/shm_segmented_vector_commit_test"; };
+
+    using SegVector   = ShmSegmentedVector<long, 64, 16, SegPath>;
+    using SegMpVector = ShmSegmentedVector<int, 128, 32, SegMpPath>;
+    using SegFailVector = ShmSegmentedVector<long, 64, 4, SegFailPath>;
+    // Same path, a fresh singleton once SegFailVector is destroyed
+    using SegStaleVector = ShmSegmentedVector<long, 64, 2, SegFailPath>;
+    using SegCommitVector = ShmSegmentedVector<long, 64, 4, SegCommitPath>;
+
+    // What a crashed run leaves behind: chunk 0 full of old data
+    void LeaveStaleChunk() {
+        const std::string path = std::string(SegFailPath::value) + ".0";
+        int fd = shm_open(path.c_str(), O_RDWR | O_CREAT, 0666);
+        ASSERT_GE(fd, 0);
+        ASSERT_EQ(ftruncate(fd, 64 * sizeof(long)), 0);
+        void* addr = mmap(nullptr, 64 * sizeof(long), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        ASSERT_NE(addr, MAP_FAILED);
+        memset(addr, 0x5a, 64 * sizeof(long));
+        munmap(addr, 64 * sizeof(long));
+    }
+}
+
+TEST(ShmSegmentedVectorTest, GrowsChunkByChunk) {
+    auto& v = SegVector::GetInstance();
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(v.capacity(), 64u * 16u);
+    EXPECT_EQ(v.chunk_count(), 0u);
+
+    for (long i = 0; i < 64; ++i) {
+        ASSERT_TRUE(v.push_back(i).has_value());
+    }
+    EXPECT_EQ(v.chunk_count(), 1u);
+
+    ASSERT_TRUE(v.push_back(64).has_value());
+    EXPECT_EQ(v.chunk_count(), 2u);
+
+    // Allocation spanning several chunks creates all of them
+    auto off = v.allocate(200);
+    ASSERT_TRUE(off.has_value());
+    for (std::size_t i = 0; i < 200; ++i) {
+        v[*off + i] = static_cast<long>(*off + i);
+    }
+    ASSERT_TRUE(v.commit(*off, 200));
+    EXPECT_EQ(v.chunk_count(), 5u);
+    EXPECT_EQ(v.committed(), 265u);
+
+    long sum = 0;
+    EXPECT_EQ(v.iterate_committed([&](std::size_t idx, const long& x) {
+        EXPECT_EQ(x, static_cast<long>(idx));
+        sum += x;
+    }), 265u);
+    EXPECT_EQ(sum, 264L * 265 / 2);
+
+    // Overflow
+    EXPECT_FALSE(v.allocate(v.capacity()).has_value());
+
+    v.Destroy();
+}
+
+TEST(ShmSegmentedVectorTest, MultiProcessLazyMapping) {
+    constexpr int NPROC    = 4;
+    constexpr int PER_PROC = 1000;
+
+    auto& v = SegMpVector::GetInstance();
+
+    ProcessLauncher launcher;
+    std::vector<Processor> procs;
+    for (int p = 0; p < NPROC; ++p) {
+        procs.emplace_back(launcher.Launch("seg_writer_" + std::to_string(p), [p] {
+            auto& vec = SegMpVector::GetInstance();
+            for (int i = 0; i < PER_PROC; ++i) {
+                if (!vec.push_back(p * PER_PROC + i)) {
+                    throw std::runtime_error("push_back failed");
+                }
+            }
+        }));
+        ASSERT_TRUE(procs.back());
+    }
+
+    auto results = launcher.Wait(procs, std::chrono::seconds(10));
+    for (auto& r : results) {
+        EXPECT_EQ(r.status, Status::SUCCESS) << r.detail;
+    }
+    launcher.Stop(procs);
+
+    // Chunks created by children are mapped lazily in parent
+    EXPECT_EQ(v.committed(), static_cast<std::size_t>(NPROC * PER_PROC));
+    EXPECT_EQ(v.chunk_count(), (NPROC * PER_PROC + 127) / 128u);
+
+    std::vector<bool> seen(NPROC * PER_PROC, false);
+    v.iterate_committed([&](std::size_t, const int& x) {
+        ASSERT_GE(x, 0);
+        ASSERT_LT(x, NPROC * PER_PROC);
+        seen[x] = true;
+    });
+    for (bool b : seen) {
+        EXPECT_TRUE(b);
+    }
+
+    v.Destroy();
+}
+
+TEST(ShmSegmentedVectorTest, FailedChunkCreationReservesNothing) {
+    auto& v = SegFailVector::GetInstance();
+    LeaveStaleChunk();
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        // No chunk fits under this file size limit, so creating one fails
+        signal(SIGXFSZ, SIG_IGN);
+        rlimit limit{64, 64};
+        setrlimit(RLIMIT_FSIZE, &limit);
+        const bool failed = !v.allocate(1).has_value() && !v.push_back(1).has_value();
+        _exit(failed && v.size() == 0 ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+
+    // Nothing was left reserved, later writers commit right away
+    EXPECT_EQ(v.size(), 0u);
+    auto idx = v.push_back(7);
+    ASSERT_TRUE(idx.has_value());
+    EXPECT_EQ(*idx, 0u);
+    EXPECT_EQ(v.committed(), 1u);
+    v.Destroy();
+}
+
+TEST(ShmSegmentedVectorTest, StaleChunkIsNotReused) {
+    LeaveStaleChunk();
+    auto& v = SegStaleVector::GetInstance();
+
+    auto off = v.allocate(64);
+    ASSERT_TRUE(off.has_value());
+    for (std::size_t i = 0; i < 64; ++i) {
+        EXPECT_EQ(v[*off + i], 0L) << i;
+    }
+    v.Destroy();
+}
+
+TEST(ShmSegmentedVectorTest, TimedOutPushBackDoesNotBlockLaterWriters) {
+    auto& v = SegCommitVector::GetInstance();
+    auto stalled = v.allocate(1);
+    ASSERT_TRUE(stalled.has_value());
+
+    // Gives up waiting for the stalled slot, yet its element is not lost
+    auto off = v.allocate(1);
+    ASSERT_TRUE(off.has_value());
+    v[*off] = 2;
+    EXPECT_FALSE(v.commit(*off, 1, std::chrono::milliseconds(1)));
+
+    // Returns its index at once, published only behind the stalled slot
+    auto idx = v.push_back(3);
+    ASSERT_TRUE(idx.has_value());
+    EXPECT_EQ(v.committed(), 0u);
+
+    v[*stalled] = 1;
+    ASSERT_TRUE(v.commit(*stalled, 1));
+    EXPECT_EQ(v.committed(), 3u);
+
+    // A range spanning a chunk boundary is carried along the same way
+    auto span = v.allocate(100);
+    ASSERT_TRUE(span.has_value());
+    ASSERT_TRUE(v.push_back(4).has_value());
+    EXPECT_EQ(v.committed(), 3u);
+    ASSERT_TRUE(v.commit(*span, 100));
+    EXPECT_EQ(v.committed(), 104u);
+    EXPECT_EQ(v[1], 2);
+    EXPECT_EQ(v[2], 3);
+    v.Destroy();
+}
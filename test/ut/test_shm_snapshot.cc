@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <map>
+#include <memory>
+#include <thread>
+
+#include "shmap/shm_snapshot.h"
+#include "shmap/shm_storage.h"
+#include "shmap/shm_hash_table.h"
+#include "shmap/shm_change_log.h"
+
+using namespace shmap;
+
+namespace {
+    // Both halves are always written together, a torn copy shows them apart
+    struct Pair {
+        uint64_t a;
+        uint64_t b;
+    };
+
+    struct ShmPath { static constexpr const char* value = "/shm_snapshot_test"; };
+    using Table   = ShmHashTable<uint64_t, Pair, 4096>;
+    using Storage = ShmStorage<Table, ShmPath>;
+
+    struct VersionedPath { static constexpr const char* value = "/shm_snapshot_versioned_test"; };
+    struct VersionedOptions : TableOptions {
+        using ChangeLog = ShmChangeLog<uint64_t>;
+        static constexpr bool VERSION_ENABLE = true;
+    };
+    using VersionedTable = ShmHashTable<uint64_t, Pair, 4096, std::hash<uint64_t>, std::equal_to<uint64_t>,
+        false, VersionedOptions>;
+    using VersionedStorage = ShmStorage<VersionedTable, VersionedPath>;
+
+    struct ShmSnapshotTest : testing::Test {
+        void SetUp() override {
+            path_ = "/tmp/shmap_snapshot_test." + std::to_string(getpid());
+        }
+        void TearDown() override {
+            Storage::GetInstance().Clear();
+            std::remove(path_.c_str());
+        }
+        static void TearDownTestSuite() {
+            Storage::GetInstance().Destroy();
+            VersionedStorage::GetInstance().Destroy();
+        }
+        std::string path_;
+    };
+}
+
+TEST_F(ShmSnapshotTest, WritesWhileWritersKeepGoing) {
+    auto& storage = Storage::GetInstance();
+    for (uint64_t k = 0; k < 1000; ++k) {
+        storage->Visit(k, AccessMode::CreateIfMiss, [k](auto, Pair& p, bool) { p = {k, k}; });
+    }
+
+    // Small chunks so the helper runs long enough to overlap the writer
+    ShmSnapshot snap = storage.Snapshot(path_, 4096);
+    ASSERT_GT(snap.Pid(), 0);
+    std::atomic<bool> stop{false};
+    std::thread writer([&]() {
+        for (uint64_t i = 0; !stop.load(); ++i) {
+            storage->Visit(i % 2000, AccessMode::CreateIfMiss, [i](auto, Pair& p, bool) { p = {i, i}; });
+        }
+    });
+    ASSERT_EQ(snap.Wait(), Status::SUCCESS);
+    stop = true;
+    writer.join();
+
+    SnapshotProgress progress = snap.Progress();
+    EXPECT_TRUE(progress.done);
+    EXPECT_EQ(progress.bytesTotal, Storage::Block::GetMemUsage());
+    EXPECT_EQ(progress.bytesDone, progress.bytesTotal);
+    EXPECT_DOUBLE_EQ(progress.Fraction(), 1.0);
+    EXPECT_GT(progress.seconds, 0.0);
+    EXPECT_GT(progress.MBps(), 0.0);
+    EXPECT_NE(access((path_ + ".tmp").c_str(), F_OK), 0);
+
+    // Every key of the snapshot time is back, none of the values torn
+    storage.Clear();
+    ASSERT_EQ(storage.Restore(path_), Status::SUCCESS);
+    std::size_t keys = 0;
+    storage->Travel([&](auto, const uint64_t&, Pair& p) {
+        ++keys;
+        EXPECT_EQ(p.a, p.b);
+    });
+    EXPECT_GE(keys, 1000u);
+    for (uint64_t k = 0; k < 1000; ++k) {
+        EXPECT_EQ(storage->Visit(k, AccessMode::AccessExist, [](auto, Pair&, bool) {}), Status::SUCCESS);
+    }
+}
+
+TEST_F(ShmSnapshotTest, RestoreFindsKeysPushedPastABucketCopiedEmpty) {
+    auto& storage = Storage::GetInstance();
+    const uint64_t home = 200;
+    const uint64_t later = home + Table::Capacity(); // same home bucket
+    const std::size_t tableOffset = Storage::Block::GetTableOffset();
+    const std::size_t boundary = tableOffset + Table::BucketsOffset() + (home + 1) * sizeof(Table::Bucket);
+    const auto* base = reinterpret_cast<const uint8_t*>(&*storage) - tableOffset;
+    const Table* table = &*storage;
+
+    // Bucket `home` is copied EMPTY, then filled, pushing `later` into the next bucket
+    ShmSnapshot snap = ShmSnapshot::Start(path_, Storage::Block::GetMemUsage(),
+        [&](std::size_t offset, std::size_t bytes, void* dst) {
+            auto* out = static_cast<uint8_t*>(dst);
+            if (offset >= boundary || offset + bytes <= boundary) {
+                return detail::CopySegment(base, tableOffset, *table, offset, bytes, out);
+            }
+            Status status = detail::CopySegment(base, tableOffset, *table, offset, boundary - offset, out);
+            if (!status) return status;
+            for (uint64_t k : {home, later}) {
+                storage->Visit(k, AccessMode::CreateIfMiss, [k](auto, Pair& p, bool) { p = {k, k}; });
+            }
+            return detail::CopySegment(base, tableOffset, *table, boundary,
+                offset + bytes - boundary, out + (boundary - offset));
+        });
+    ASSERT_EQ(snap.Wait(), Status::SUCCESS);
+
+    storage.Clear();
+    ASSERT_EQ(storage.Restore(path_), Status::SUCCESS);
+    EXPECT_EQ(storage->Visit(home, AccessMode::AccessExist, [](auto, Pair&, bool) {}), Status::NOT_FOUND);
+    EXPECT_EQ(storage->Visit(later, AccessMode::AccessExist, [&](auto, Pair& p, bool) {
+        EXPECT_EQ(p.a, later);
+    }), Status::SUCCESS);
+    EXPECT_EQ(storage->Visit(later, AccessMode::CreateIfMiss, [](auto, Pair&, bool isNew) {
+        EXPECT_FALSE(isNew);
+    }), Status::SUCCESS);
+    std::size_t keys = 0;
+    storage->Travel([&](auto, const uint64_t&, Pair&) { ++keys; });
+    EXPECT_EQ(keys, 1u);
+}
+
+TEST_F(ShmSnapshotTest, CopyWaitsForHeldBuckets) {
+    auto& storage = Storage::GetInstance();
+    storage->Visit(7, AccessMode::CreateIfMiss, [](auto, Pair& p, bool) { p = {1, 1}; });
+
+    auto copy = std::make_unique<Table>();
+    EXPECT_EQ(storage->CopyBytes(0, sizeof(Table), copy.get()), Status::SUCCESS);
+    storage->Visit(7, AccessMode::AccessExist, [&](auto, Pair&, bool) {
+        EXPECT_EQ(storage->CopyBytes(0, sizeof(Table), copy.get(), std::chrono::milliseconds(1)), Status::TIMEOUT);
+    });
+    // Once released the held bucket is copied as READY with its value
+    ASSERT_EQ(storage->CopyBytes(0, sizeof(Table), copy.get()), Status::SUCCESS);
+    EXPECT_EQ(copy->Visit(7, AccessMode::AccessExist, [](auto, Pair& p, bool) { EXPECT_EQ(p.a, 1u); }),
+        Status::SUCCESS);
+}
+
+TEST_F(ShmSnapshotTest, RestoreRejectsOtherFiles) {
+    auto& storage = Storage::GetInstance();
+    EXPECT_EQ(storage.Restore(path_), Status::NOT_FOUND);
+
+    FILE* f = std::fopen(path_.c_str(), "wb");
+    ASSERT_NE(f, nullptr);
+    std::fputs("not a snapshot, far too short", f);
+    std::fclose(f);
+    EXPECT_EQ(storage.Restore(path_), Status::INVALID_ARGUMENT);
+
+    // A failing helper reports its error and leaves no file behind
+    ShmSnapshot snap = storage.Snapshot("/nonexistent-dir/snap");
+    EXPECT_EQ(snap.Wait(), Status::ERROR);
+    EXPECT_TRUE(snap.Progress().done);
+    EXPECT_FALSE(snap.Running());
+}
+
+TEST_F(ShmSnapshotTest, HeaderVersionsBracketTheWritesMadeMeanwhile) {
+    auto& storage = VersionedStorage::GetInstance();
+    for (uint64_t k = 0; k < 1000; ++k) {
+        storage->Visit(k, AccessMode::CreateIfMiss, [k](auto, Pair& p, bool) { p = {k, k}; });
+    }
+    const uint64_t before = storage->Version();
+
+    ShmSnapshot snap = storage.Snapshot(path_, 4096);
+    std::atomic<bool> stop{false};
+    std::thread writer([&]() {
+        for (uint64_t i = 1; !stop.load(); ++i) {
+            storage->Visit(i % 2000, AccessMode::CreateIfMiss, [i](auto, Pair& p, bool) { p = {i << 32, i << 32}; });
+        }
+    });
+    ASSERT_EQ(snap.Wait(), Status::SUCCESS);
+    stop = true;
+    writer.join();
+    const uint64_t after    = storage->Version();
+    const uint64_t logAfter = storage->ChangeLog().Version();
+
+    // The live state and the version of each key's last write
+    std::map<uint64_t, std::pair<uint64_t, uint64_t>> live;
+    ASSERT_EQ(storage->TravelChangedSince(0, [&](auto, const uint64_t& k, const Pair& p, uint64_t version) {
+        live[k] = {p.a, version};
+        return Status::SUCCESS;
+    }), Status::SUCCESS);
+
+    SnapshotHeader header{};
+    storage.Clear();
+    ASSERT_EQ(storage.Restore(path_, &header), Status::SUCCESS);
+    EXPECT_GE(header.versionStart, before);
+    EXPECT_LE(header.versionStart, header.versionEnd);
+    EXPECT_LE(header.versionEnd, after);
+    EXPECT_GE(header.logStart, before);
+    EXPECT_LE(header.logStart, header.logEnd);
+    EXPECT_LE(header.logEnd, logAfter);
+
+    // Writes up to the start are in the file, the ones after the end are not
+    for (const auto& [k, state] : live) {
+        uint64_t restored = UINT64_MAX;
+        storage->Visit(k, AccessMode::AccessExist, [&](auto, Pair& p, bool) { restored = p.a; });
+        if (state.second <= header.versionStart) {
+            EXPECT_EQ(restored, state.first) << k;
+        } else if (state.second > header.versionEnd) {
+            EXPECT_NE(restored, state.first) << k;
+        }
+    }
+}
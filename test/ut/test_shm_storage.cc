@@ -14,7 +14,7 @@ using namespace shmap;
 
 namespace {
     struct ShmPath { static constexpr const char* value = "/shm_storage_test"; };
-    using Storage = ShmStorage<ShmHashTable<FixedString, int, 8>, ShmPath>;
+    using Storage = ShmStorage<ShmHashTable<FixedString<>, int, 8>, ShmPath>;
 }
 
 struct ShmStorgeTest : public testing::Test {
@@ -30,7 +30,7 @@ protected:
 TEST_F(ShmStorgeTest, shm_storage_function_test) {
     auto& storage = Storage::GetInstance();
 
-    FixedString k = FixedString::FromString("cnt");
+    FixedString<> k = FixedString<>::FromString("cnt");
     int value = 0x123456;
 
     bool inserted = storage->Visit(k, AccessMode::CreateIfMiss,
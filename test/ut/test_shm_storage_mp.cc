@@ -14,19 +14,19 @@ using namespace shmap;
 
 namespace {
     struct Person {
-        FixedString name;
+        FixedString<> name;
         int age;
         long long padding[10240];
     };
 
     struct ShmPath { static constexpr const char* value = "/shm_storage_mp_test"; };
-    using Storage = ShmStorage<ShmHashTable<FixedString, Person, 8>, ShmPath>;
+    using Storage = ShmStorage<ShmHashTable<FixedString<>, Person, 8>, ShmPath>;
 
     struct PersonRepo {
         static void Add(const char* name, int age) {
             Storage::GetInstance()->Visit(name, AccessMode::CreateIfMiss, [name, age](auto idx, auto& person, bool isNew) {
                 if (isNew) {
-                    person.name = FixedString::FromString(name);
+                    person.name = FixedString<>::FromString(name);
                     person.age = age;
                 } else {
                     person.age++;
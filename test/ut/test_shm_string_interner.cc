@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shmap/shm_string_interner.h"
+
+using namespace shmap;
+
+namespace {
+    using Interner = ShmStringInterner<16, 1024>;
+}
+
+TEST(ShmStringInternerTest, InternFindAndLookup) {
+    auto* interner = new Interner();
+    EXPECT_EQ(interner->size(), 0u);
+
+    uint32_t aapl = Interner::INVALID_ID;
+    uint32_t ibm  = Interner::INVALID_ID;
+    ASSERT_EQ(interner->Intern("AAPL", aapl), Status::SUCCESS);
+    ASSERT_EQ(interner->Intern("IBM", ibm), Status::SUCCESS);
+    EXPECT_EQ(aapl, 0u);
+    EXPECT_EQ(ibm, 1u);
+
+    // Interning again gives the same id
+    uint32_t again = Interner::INVALID_ID;
+    ASSERT_EQ(interner->Intern(std::string("AAPL"), again), Status::SUCCESS);
+    EXPECT_EQ(again, aapl);
+    EXPECT_EQ(interner->size(), 2u);
+
+    uint32_t found = Interner::INVALID_ID;
+    ASSERT_EQ(interner->Find("IBM", found), Status::SUCCESS);
+    EXPECT_EQ(found, ibm);
+    EXPECT_EQ(interner->Find("MSFT", found), Status::NOT_FOUND);
+
+    ASSERT_NE(interner->Lookup(ibm), nullptr);
+    EXPECT_EQ(*interner->Lookup(ibm), "IBM");
+    EXPECT_EQ(interner->Lookup(2), nullptr);
+
+    // Too long to be stored without truncation
+    uint32_t id = Interner::INVALID_ID;
+    EXPECT_EQ(interner->Intern("A_SYMBOL_LONGER_THAN_16", id), Status::INVALID_ARGUMENT);
+    delete interner;
+}
+
+TEST(ShmStringInternerTest, FullReturnsOutOfMemory) {
+    ShmStringInterner<8, 4> interner;
+    uint32_t id = 0;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(interner.Intern(std::to_string(i), id), Status::SUCCESS);
+    }
+    EXPECT_EQ(interner.Intern("4", id), Status::OUT_OF_MEMORY);
+    EXPECT_EQ(interner.Find("4", id), Status::NOT_FOUND);
+    EXPECT_EQ(interner.size(), 4u);
+}
+
+TEST(ShmStringInternerTest, ConcurrentInternAssignsOneIdPerString) {
+    constexpr int THREADS = 8;
+    constexpr int STRINGS = 500;
+
+    auto* interner = new Interner();
+    std::vector<std::vector<uint32_t>> ids(THREADS, std::vector<uint32_t>(STRINGS));
+    std::atomic<bool> failed{false};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            // Different threads intern the same strings in different orders
+            for (int i = 0; i < STRINGS; ++i) {
+                int s = (i + t * 37) % STRINGS;
+                if (!interner->Intern("sym_" + std::to_string(s), ids[t][s])) {
+                    failed.store(true);
+                }
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    ASSERT_FALSE(failed.load());
+    EXPECT_EQ(interner->size(), static_cast<std::size_t>(STRINGS));
+    for (int s = 0; s < STRINGS; ++s) {
+        for (int t = 1; t < THREADS; ++t) {
+            ASSERT_EQ(ids[t][s], ids[0][s]);
+        }
+        ASSERT_EQ(*interner->Lookup(ids[0][s]), "sym_" + std::to_string(s));
+    }
+    delete interner;
+}
@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
@@ -8,33 +9,33 @@
 
 using namespace shmap;
 
-using Table = ShmHashTable<int, FixedString, 16>;
+using Table = ShmHashTable<int, FixedString<>, 16>;
 
 TEST(ShmHashTableTest, InsertAndAccess) {
     Table tbl;
     bool inserted = tbl.Visit(42, AccessMode::CreateIfMiss,
-        [&](size_t idx, FixedString& val, bool is_new){
+        [&](size_t idx, FixedString<>& val, bool is_new){
             ASSERT_TRUE(is_new);
             val = "hello";
         });
     ASSERT_TRUE(inserted);
 
     bool found = tbl.Visit(42, AccessMode::AccessExist,
-        [&](size_t idx, FixedString& val, bool){
-            ASSERT_EQ(val, FixedString("hello"));
+        [&](size_t idx, FixedString<>& val, bool){
+            ASSERT_EQ(val, FixedString<>("hello"));
         });
     ASSERT_TRUE(found);
 
     bool updated = tbl.Visit(42, AccessMode::CreateIfMiss,
-        [&](size_t, FixedString& v, bool is_new){
+        [&](size_t, FixedString<>& v, bool is_new){
             ASSERT_FALSE(is_new);
             v = "world";
         });
     ASSERT_TRUE(updated);
 
     bool found2 = tbl.Visit(42, AccessMode::AccessExist,
-        [&](size_t, FixedString& v, bool){
-            ASSERT_EQ(v, FixedString("world"));
+        [&](size_t, FixedString<>& v, bool){
+            ASSERT_EQ(v, FixedString<>("world"));
         });
     ASSERT_TRUE(found2);
 }
@@ -42,7 +43,7 @@ TEST(ShmHashTableTest, InsertAndAccess) {
 TEST(ShmHashTableTest, AccessNonExist) {
     Table tbl;
     bool f = tbl.Visit(999, AccessMode::AccessExist,
-        [](size_t, FixedString&, bool){});
+        [](size_t, FixedString<>&, bool){});
     ASSERT_FALSE(f);
 }
 
@@ -50,12 +51,12 @@ TEST(ShmHashTableTest, EnumerateAll) {
     Table tbl;
     for (int i = 0; i < 5; ++i) {
         tbl.Visit(i, AccessMode::CreateIfMiss,
-            [&](size_t, FixedString& v, bool){
+            [&](size_t, FixedString<>& v, bool){
                 v = std::to_string(i);
             });
     }
     std::vector<int> seen;
-    tbl.Travel([&](size_t, const int& k, const FixedString& v){
+    tbl.Travel([&](size_t, const int& k, const FixedString<>& v){
         seen.push_back(k);
     });
     std::sort(seen.begin(), seen.end());
@@ -143,3 +144,120 @@ TEST(ShmHashTableTest, TravelBucketConst_ReadOnly) {
     EXPECT_EQ(status, Status::SUCCESS);
     EXPECT_EQ(sum, (0 + 7) * 8 / 2 * 10);
 }
+
+namespace {
+    struct IdentityHash {
+        std::size_t operator()(int k) const noexcept { return static_cast<std::size_t>(k); }
+    };
+    using Accounts = ShmHashTable<int, int64_t, 16, IdentityHash, std::equal_to<int>, true>;
+
+    int64_t Balance(Accounts& tbl, int key) {
+        int64_t out = -1;
+        tbl.Visit(key, AccessMode::AccessExist, [&](size_t, int64_t& v, bool) { out = v; });
+        return out;
+    }
+}
+
+TEST(ShmHashTableTest, VisitMulti_UpdatesAllKeysTogether) {
+    Accounts tbl;
+    tbl.Visit(1, AccessMode::CreateIfMiss, [](size_t, int64_t& v, bool) { v = 100; });
+    tbl.Visit(2, AccessMode::CreateIfMiss, [](size_t, int64_t& v, bool) { v = 50; });
+
+    // Keys given out of bucket order, values come back in key order
+    auto status = tbl.VisitMulti({2, 1}, AccessMode::AccessExist, [](auto& values, const auto& isNew) {
+        EXPECT_FALSE(isNew[0] || isNew[1]);
+        *values[0] += 30;
+        *values[1] -= 30;
+    });
+    ASSERT_EQ(status, Status::SUCCESS);
+    EXPECT_EQ(Balance(tbl, 1), 70);
+    EXPECT_EQ(Balance(tbl, 2), 80);
+
+    // A missing key fails the whole visit before the visitor runs
+    bool called = false;
+    status = tbl.VisitMulti({1, 7}, AccessMode::AccessExist, [&](auto&, const auto&) { called = true; });
+    EXPECT_EQ(status, Status::NOT_FOUND);
+    EXPECT_FALSE(called);
+}
+
+TEST(ShmHashTableTest, VisitMulti_CreatesAndSharesRepeatedKeys) {
+    Accounts tbl;
+    tbl.Visit(3, AccessMode::CreateIfMiss, [](size_t, int64_t& v, bool) { v = 1; });
+
+    // 3, 19 and 35 share home bucket 3; the two new keys must get different buckets
+    auto status = tbl.VisitMulti({19, 3, 35, 19}, AccessMode::CreateIfMiss, [](auto& values, const auto& isNew) {
+        EXPECT_TRUE(isNew[0]);
+        EXPECT_FALSE(isNew[1]);
+        EXPECT_TRUE(isNew[2]);
+        EXPECT_EQ(values[0], values[3]);
+        EXPECT_NE(values[0], values[2]);
+        *values[0] += 5;
+        *values[3] += 5;
+        *values[2] = *values[1] + 1;
+    });
+    ASSERT_EQ(status, Status::SUCCESS);
+    EXPECT_EQ(Balance(tbl, 19), 10);
+    EXPECT_EQ(Balance(tbl, 35), 2);
+    EXPECT_EQ(Balance(tbl, 3), 1);
+}
+
+TEST(ShmHashTableTest, VisitMulti_RollsBackOnFailure) {
+    Accounts tbl;
+    tbl.Visit(1, AccessMode::CreateIfMiss, [](size_t, int64_t& v, bool) { v = 10; });
+    tbl.Visit(2, AccessMode::CreateIfMiss, [](size_t, int64_t& v, bool) { v = 20; });
+
+    auto status = tbl.VisitMulti({1, 2, 5}, AccessMode::CreateIfMiss, [](auto& values, const auto&) {
+        *values[0] = 0;
+        *values[1] = 0;
+        *values[2] = 99;
+        return Status::ERROR;
+    });
+    EXPECT_EQ(status, Status::ERROR);
+    EXPECT_EQ(Balance(tbl, 1), 10);
+    EXPECT_EQ(Balance(tbl, 2), 20);
+    EXPECT_EQ(Balance(tbl, 5), -1); // never inserted
+
+    // All buckets were released
+    EXPECT_EQ(tbl.VisitMulti({1, 2}, AccessMode::AccessExist, [](auto&, const auto&) {},
+        std::chrono::milliseconds(10)), Status::SUCCESS);
+}
+
+namespace {
+    struct VersionedOptions : TableOptions {
+        static constexpr bool VERSION_ENABLE = true;
+    };
+    using Versioned = ShmHashTable<int, int64_t, 256, IdentityHash, std::equal_to<int>,
+        false, VersionedOptions>;
+}
+
+TEST(ShmHashTableTest, TravelChangedSince_VisitsOnlyNewerWrites) {
+    auto tbl = std::make_unique<Versioned>();
+    for (int k = 0; k < 256; k += 2) {
+        tbl->Visit(k, AccessMode::CreateIfMiss, [k](size_t, int64_t& v, bool) { v = k; });
+    }
+    EXPECT_EQ(tbl->Version(), 128u);
+    EXPECT_EQ(tbl->VersionOf(10), 6u);
+    EXPECT_EQ(tbl->VersionOf(11), 0u);
+
+    const uint64_t mark = tbl->Version();
+    tbl->Visit(70, AccessMode::AccessExist, [](size_t, int64_t& v, bool) { v = -1; });
+    tbl->Visit(72, AccessMode::AccessExist, [](size_t, int64_t&, bool) {}); // read only, not stamped
+    tbl->Visit(201, AccessMode::CreateIfMiss, [](size_t, int64_t& v, bool) { v = 7; });
+
+    std::vector<std::pair<int, uint64_t>> seen;
+    auto status = tbl->TravelChangedSince(mark, [&](size_t idx, const int& k, const int64_t&, uint64_t version) {
+        EXPECT_EQ(idx, static_cast<size_t>(k));
+        seen.emplace_back(k, version);
+    });
+    ASSERT_EQ(status, Status::SUCCESS);
+    ASSERT_EQ(seen.size(), 2u);
+    EXPECT_EQ(seen[0], std::make_pair(70, mark + 1));
+    EXPECT_EQ(seen[1], std::make_pair(201, mark + 2));
+
+    // Nothing newer, and a failing visitor stops the pass
+    seen.clear();
+    EXPECT_EQ(tbl->TravelChangedSince(tbl->Version(), [&](auto, auto&, auto&, auto) { seen.emplace_back(0, 0); }),
+        Status::SUCCESS);
+    EXPECT_TRUE(seen.empty());
+    EXPECT_EQ(tbl->TravelChangedSince(0, [](auto, auto&, auto&, auto) { return Status::ERROR; }), Status::ERROR);
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "shmap/shm_table_inspector.h"
+#include "shmap/fixed_string.h"
+
+using namespace shmap;
+
+namespace {
+    // Every key hashes to its own value, so probe lengths are predictable
+    struct IdentityHash {
+        std::size_t operator()(uint64_t k) const noexcept { return k; }
+    };
+
+    using IntTable = ShmHashTable<uint64_t, int32_t, 16>;
+    using StrTable = ShmHashTable<FixedString<16>, uint64_t, 32>;
+    using IdTable  = ShmHashTable<uint64_t, uint64_t, 16, IdentityHash>;
+}
+
+TEST(ShmTableInspectorTest, LayoutRoundTrip) {
+    auto layout = ShmTableLayout::OfStorage<StrTable>();
+    EXPECT_EQ(layout.capacity, 32u);
+    EXPECT_EQ(layout.offset, ShmBlock<StrTable>::GetTableOffset());
+    EXPECT_EQ(layout.keyFormat, FieldFormat::FixedString);
+    EXPECT_EQ(layout.keyChars, 16u);
+    EXPECT_TRUE(layout.stdHash);
+
+    std::string text = layout.ToString();
+    auto parsed = ShmTableLayout::Parse(text);
+    ASSERT_TRUE(parsed);
+    EXPECT_EQ(parsed->ToString(), text);
+    EXPECT_EQ(parsed->bucketSize, sizeof(StrTable::Bucket));
+    EXPECT_EQ(parsed->valueFormat, FieldFormat::Unsigned);
+    ASSERT_NE(parsed->hash, nullptr);
+
+    // The reproduced hash matches std::hash of the key
+    auto key = FixedString<16>::FromString("alpha");
+    EXPECT_EQ(parsed->hash(&key, *parsed), std::hash<FixedString<16>>{}(key));
+
+    // A custom hash is usable in process but not described in the text form
+    auto custom = ShmTableLayout::Of<IdTable>();
+    EXPECT_FALSE(custom.stdHash);
+    EXPECT_NE(custom.hash, nullptr);
+    auto reparsed = ShmTableLayout::Parse(custom.ToString());
+    ASSERT_TRUE(reparsed);
+    EXPECT_EQ(reparsed->hash, nullptr);
+}
+
+TEST(ShmTableInspectorTest, ParseRejectsBadDescriptors) {
+    EXPECT_FALSE(ShmTableLayout::Parse(""));
+    EXPECT_FALSE(ShmTableLayout::Parse("cap=16,bucket=64,key=8+8:u"));                    // no value
+    EXPECT_FALSE(ShmTableLayout::Parse("cap=16,bucket=64,key=8+3:u,value=16+8:u"));       // odd int size
+    EXPECT_FALSE(ShmTableLayout::Parse("cap=16,bucket=64,key=60+8:u,value=16+8:u"));      // past bucket
+    EXPECT_FALSE(ShmTableLayout::Parse("cap=16,bucket=64,key=8+8:x,value=16+8:u,hash=std")); // no std hash for bytes
+    EXPECT_FALSE(ShmTableLayout::Parse("cap=16,bucket=64,key=8+8:u,value=16+8:u,color=red"));
+    EXPECT_TRUE(ShmTableLayout::Parse("cap=16,bucket=64,key=8+8:u,value=16+8:i,hash=std"));
+}
+
+TEST(ShmTableInspectorTest, ReportsClustersAndProbes) {
+    auto table = std::make_unique<IdTable>();
+    // 3, 19 and 35 all home at bucket 3: cluster 3..5, probes 0, 1, 2
+    for (uint64_t k : {3u, 19u, 35u, 10u}) {
+        ASSERT_EQ(table->Visit(k, AccessMode::CreateIfMiss, [k](auto, auto& v, bool) { v = k * 10; }), Status::SUCCESS);
+    }
+
+    auto inspector = ShmTableInspector::Of(*table);
+    ASSERT_TRUE(inspector.Valid());
+    auto report = inspector.Inspect(4);
+    EXPECT_EQ(report.capacity, 16u);
+    EXPECT_EQ(report.ready, 4u);
+    EXPECT_EQ(report.empty, 12u);
+    EXPECT_DOUBLE_EQ(report.LoadFactor(), 0.25);
+
+    ASSERT_EQ(report.clusters.size(), 4u);
+    EXPECT_EQ(report.clusters[1], 1u);
+    EXPECT_EQ(report.clusters[3], 1u);
+    EXPECT_EQ(report.MaxCluster(), 3u);
+
+    ASSERT_EQ(report.probes.size(), 3u);
+    EXPECT_EQ(report.probes[0], 2u);
+    EXPECT_EQ(report.probes[1], 1u);
+    EXPECT_EQ(report.probes[2], 1u);
+    EXPECT_DOUBLE_EQ(report.MeanProbe(), 0.75);
+
+    // Slices of 4 buckets: 3 | 4, 5 | 10 | -, homes 3, 3, 3 | - | 10 | -
+    EXPECT_EQ(report.regions, (std::vector<uint64_t>{1, 2, 1, 0}));
+    EXPECT_EQ(report.homes, (std::vector<uint64_t>{3, 0, 1, 0}));
+    EXPECT_DOUBLE_EQ(ShmTableReport::Skew(report.regions), 2.0);
+    EXPECT_DOUBLE_EQ(ShmTableReport::Skew(report.homes), 3.0);
+}
+
+TEST(ShmTableInspectorTest, ClusterWrapsAroundTheEnd) {
+    auto table = std::make_unique<IdTable>();
+    for (uint64_t k : {15u, 31u, 47u}) {
+        ASSERT_EQ(table->Visit(k, AccessMode::CreateIfMiss, [](auto, auto&, bool) {}), Status::SUCCESS);
+    }
+    auto report = ShmTableInspector::Of(*table).Inspect();
+    ASSERT_EQ(report.clusters.size(), 4u);
+    EXPECT_EQ(report.clusters[3], 1u);
+    EXPECT_EQ(report.MaxProbe(), 2u);
+}
+
+TEST(ShmTableInspectorTest, FindsStuckBuckets) {
+    auto table = std::make_unique<IntTable>();
+    for (uint64_t k = 0; k < 4; ++k) {
+        table->Visit(k, AccessMode::CreateIfMiss, [](auto, auto&, bool) {});
+    }
+    std::vector<std::size_t> used;
+    table->TravelBucket([&used](std::size_t idx, IntTable::Bucket& b) {
+        if (b.state.load() == IntTable::Bucket::READY) used.push_back(idx);
+    });
+    ASSERT_EQ(used.size(), 4u);
+
+    // Emulate a process that died while holding two buckets
+    auto hold = [&table](std::size_t idx, uint32_t state) {
+        table->TravelBucket([idx, state](std::size_t i, IntTable::Bucket& b) {
+            if (i == idx) b.state.store(state);
+        });
+    };
+    hold(used[0], IntTable::Bucket::ACCESSING);
+    hold(used[1], IntTable::Bucket::ACCESSING);
+
+    auto inspector = ShmTableInspector::Of(*table);
+    auto before = inspector.Inspect();
+    EXPECT_EQ(before.accessing, 2u);
+    EXPECT_EQ(before.ready, 2u);
+
+    // One of them is released between the samples
+    hold(used[1], IntTable::Bucket::READY);
+    auto after = inspector.Inspect();
+    auto stuck = ShmTableInspector::Stuck(before, after);
+    ASSERT_EQ(stuck.size(), 1u);
+    EXPECT_EQ(stuck[0].first, used[0]);
+    EXPECT_EQ(stuck[0].second, IntTable::Bucket::ACCESSING);
+}
+
+TEST(ShmTableInspectorTest, DumpsAndFormatsEntries) {
+    auto table = std::make_unique<StrTable>();
+    table->Visit(FixedString<16>::FromString("a\"b"), AccessMode::CreateIfMiss, [](auto, auto& v, bool) { v = 7; });
+    table->Visit(FixedString<16>::FromString("tab\t"), AccessMode::CreateIfMiss, [](auto, auto& v, bool) { v = 8; });
+
+    auto inspector = ShmTableInspector::Of(*table);
+    std::vector<std::string> lines;
+    EXPECT_EQ(inspector.Dump([&](std::size_t idx, const void*, const void*) {
+        lines.push_back(inspector.FormatKey(idx) + "=" + inspector.FormatValue(idx));
+    }), 2u);
+    std::sort(lines.begin(), lines.end());
+    EXPECT_EQ(lines, (std::vector<std::string>{"\"a\\\"b\"=7", "\"tab\\x09\"=8"}));
+
+    EXPECT_EQ(inspector.Dump([](std::size_t, const void*, const void*) {}, 1), 1u);
+
+    int16_t negative = -5;
+    EXPECT_EQ(ShmTableInspector::Format(&negative, 2, FieldFormat::Signed, 0), "-5");
+    uint8_t bytes[3] = {0xde, 0xad, 0x01};
+    EXPECT_EQ(ShmTableInspector::Format(bytes, 3, FieldFormat::Bytes, 0), "dead01");
+    EXPECT_EQ(ShmTableInspector::Format(bytes, 3, FieldFormat::Bytes, 0, 2), "dead...");
+}
+
+TEST(ShmTableInspectorTest, RejectsLayoutLargerThanMapping) {
+    auto table = std::make_unique<IntTable>();
+    auto layout = ShmTableLayout::Of<IntTable>();
+    EXPECT_TRUE(ShmTableInspector(table.get(), sizeof(IntTable), layout).Valid());
+    EXPECT_FALSE(ShmTableInspector(table.get(), sizeof(IntTable) / 2, layout).Valid());
+    layout.offset = sizeof(IntTable);
+    EXPECT_FALSE(ShmTableInspector(table.get(), sizeof(IntTable), layout).Valid());
+}
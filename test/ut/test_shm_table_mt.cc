@@ -1,8 +1,14 @@
 #include <gtest/gtest.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <memory>
 #include <thread>
 #include <vector>
 #include <atomic>
 #include <string>
+#include <unordered_map>
 
 #include "shmap/fixed_string.h"
 #include "shmap/shm_hash_table.h"
@@ -11,6 +17,10 @@ using namespace shmap;
 
 using Table = ShmHashTable<int, int, 1024>;
 
+struct VersionedOptions : TableOptions {
+    static constexpr bool VERSION_ENABLE = true;
+};
+
 TEST(ShmTable_Concurrent, ParallelInsertDistinct) {
     Table tbl;
     const int N = 128;
@@ -73,4 +83,167 @@ TEST(ShmTable_Concurrent, ReadWriteSameKey) {
     writer.join();
     for (auto& t : readers) t.join();
     ASSERT_FALSE(failed.load());
-}
\ No newline at end of file
+}
+
+TEST(ShmTable_Concurrent, VisitMultiTransfersKeepTheTotal) {
+    using Accounts = ShmHashTable<int, int64_t, 64>;
+    Accounts tbl;
+    constexpr int ACCOUNTS = 8;
+    for (int k = 0; k < ACCOUNTS; ++k) {
+        tbl.Visit(k, AccessMode::CreateIfMiss, [](size_t, int64_t& v, bool) { v = 1000; });
+    }
+
+    std::atomic<int> failures{0};
+    std::vector<std::thread> ths;
+    for (int t = 0; t < 4; ++t) {
+        ths.emplace_back([&, t]() {
+            uint32_t seed = t + 1;
+            for (int i = 0; i < 2000; ++i) {
+                seed = seed * 1103515245 + 12345;
+                int from = (seed >> 8) % ACCOUNTS;
+                int to   = (seed >> 16) % ACCOUNTS;
+                int via  = (seed >> 24) % ACCOUNTS;
+                // Opposite key orders in different threads must not deadlock
+                Status s = (t % 2)
+                    ? tbl.VisitMulti({from, via, to}, AccessMode::AccessExist, [](auto& v, const auto&) {
+                        *v[0] -= 3; *v[1] += 1; *v[2] += 2; })
+                    : tbl.VisitMulti({to, via, from}, AccessMode::AccessExist, [](auto& v, const auto&) {
+                        *v[2] -= 3; *v[1] += 1; *v[0] += 2; });
+                if (!s) failures.fetch_add(1);
+            }
+        });
+    }
+    for (auto& t : ths) t.join();
+    EXPECT_EQ(failures.load(), 0);
+
+    int64_t total = 0;
+    tbl.Travel([&](size_t, const int&, int64_t& v) { total += v; });
+    EXPECT_EQ(total, ACCOUNTS * 1000);
+}
+
+TEST(ShmTable_Concurrent, ChangedSinceExportKeepsAMirrorInSync) {
+    using Versioned = ShmHashTable<int, int64_t, 1024, std::hash<int>, std::equal_to<int>,
+        false, VersionedOptions>;
+    auto tbl = std::make_unique<Versioned>();
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> ths;
+    for (int t = 0; t < 3; ++t) {
+        ths.emplace_back([&, t]() {
+            for (int i = 0; i < 5000; ++i) {
+                tbl->Visit((i * 7 + t) % 300, AccessMode::CreateIfMiss, [](size_t, int64_t& v, bool) { ++v; });
+            }
+        });
+    }
+
+    // Incremental passes while writers run, then a last one once they stopped
+    std::unordered_map<int, int64_t> mirror;
+    uint64_t since = 0;
+    auto exportChanges = [&]() {
+        const uint64_t mark = tbl->Version();
+        ASSERT_EQ(tbl->TravelChangedSince(since, [&](size_t, const int& k, const int64_t& v, uint64_t) {
+            mirror[k] = v;
+        }), Status::SUCCESS);
+        since = mark;
+    };
+    std::thread exporter([&]() {
+        while (!done.load()) exportChanges();
+    });
+    for (auto& t : ths) t.join();
+    done = true;
+    exporter.join();
+    exportChanges();
+
+    EXPECT_EQ(tbl->Version(), 15000u);
+    std::size_t keys = 0;
+    tbl->Travel([&](size_t, const int& k, int64_t& v) {
+        ++keys;
+        EXPECT_EQ(mirror[k], v) << "key " << k;
+    });
+    EXPECT_EQ(keys, 300u);
+    EXPECT_EQ(mirror.size(), 300u);
+}
+
+namespace {
+    // The pass faults on the page of the held bucket; the handler lets the writer
+    // stamp and release it before the faulting load runs again
+    struct FaultGate {
+        static inline void* page = nullptr;
+        static inline std::size_t pageBytes = 0;
+        static inline std::atomic<bool> release{false};
+        static inline std::atomic<bool> released{false};
+
+        static void OnFault(int, siginfo_t* info, void*) {
+            auto* addr = static_cast<char*>(info->si_addr);
+            auto* first = static_cast<char*>(page);
+            if (addr < first || addr >= first + pageBytes) {
+                signal(SIGSEGV, SIG_DFL);
+                return;
+            }
+            mprotect(page, pageBytes, PROT_READ | PROT_WRITE);
+            release = true;
+            while (!released.load()) {}
+        }
+    };
+
+    struct IdentityIntHash {
+        std::size_t operator()(int k) const noexcept { return static_cast<std::size_t>(k); }
+    };
+}
+
+TEST(ShmTable_Concurrent, ChangedSinceSeesAWriteReleasedDuringThePass) {
+#if defined(__SANITIZE_THREAD__)
+    GTEST_SKIP() << "faults on purpose";
+#endif
+    using Versioned = ShmHashTable<int, int64_t, 1024, IdentityIntHash, std::equal_to<int>,
+        false, VersionedOptions>;
+    const std::size_t pageBytes = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::size_t perPage = pageBytes / sizeof(Versioned::Bucket);
+    if (perPage * 2 > 1024 || perPage % 64 != 0) {
+        GTEST_SKIP() << "needs the held bucket to start a page and a region";
+    }
+    void* mem = mmap(nullptr, sizeof(Versioned), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    ASSERT_NE(mem, MAP_FAILED);
+    auto* tbl = new (mem) Versioned();
+
+    // Bucket `held` opens the second page, nothing before it changes after `mark`
+    const int held = static_cast<int>(perPage);
+    tbl->Visit(held, AccessMode::CreateIfMiss, [](size_t, int64_t& v, bool) { v = 1; });
+    tbl->Visit(held + 1, AccessMode::CreateIfMiss, [](size_t, int64_t& v, bool) { v = 1; });
+    const uint64_t mark = tbl->Version();
+
+    // A writer holds `held` with a new value, not stamped yet
+    std::atomic<bool> holding{false};
+    std::thread writer([&]() {
+        tbl->Visit(held, AccessMode::AccessExist, [&](size_t, int64_t& v, bool) {
+            v = 2;
+            holding = true;
+            while (!FaultGate::release.load()) {}
+        });
+        FaultGate::released = true;
+    });
+    while (!holding.load()) {}
+    // Another change in the region, so the pass scans it
+    tbl->Visit(held + 1, AccessMode::AccessExist, [](size_t, int64_t& v, bool) { v = 2; });
+
+    FaultGate::page = static_cast<char*>(mem) + Versioned::BucketsOffset() + held * sizeof(Versioned::Bucket);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(FaultGate::page) % pageBytes, 0u);
+    FaultGate::pageBytes = pageBytes;
+    struct sigaction sa{}, old{};
+    sa.sa_sigaction = FaultGate::OnFault;
+    sa.sa_flags = SA_SIGINFO;
+    sigaction(SIGSEGV, &sa, &old);
+    ASSERT_EQ(mprotect(FaultGate::page, pageBytes, PROT_NONE), 0);
+
+    std::vector<int> seen;
+    EXPECT_EQ(tbl->TravelChangedSince(mark, [&](size_t, const int& k, const int64_t&, uint64_t) {
+        seen.push_back(k);
+    }), Status::SUCCESS);
+    writer.join();
+    sigaction(SIGSEGV, &old, nullptr);
+
+    EXPECT_TRUE(FaultGate::released.load());
+    EXPECT_NE(std::find(seen.begin(), seen.end(), held), seen.end()) << "write to the held bucket lost";
+    EXPECT_NE(std::find(seen.begin(), seen.end(), held + 1), seen.end());
+    munmap(mem, sizeof(Versioned));
+}
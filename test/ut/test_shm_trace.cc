@@ -0,0 +1,265 @@
+// Tracing is compiled in for this file only. The traced tables and rings are
+// instantiated with types local to this file, so they never share a definition
+// with the untraced instantiations of the other tests.
+#define SHMAP_TRACE_ENABLE 1
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "shmap/shm_trace.h"
+#include "shmap/shm_hash_table.h"
+#include "shmap/shm_ring_buffer.h"
+
+using namespace shmap;
+
+namespace {
+    struct TracedHash {
+        std::size_t operator()(uint64_t k) const noexcept { return k; }
+    };
+    struct TracedItem {
+        uint64_t v;
+    };
+
+    using Table = ShmHashTable<uint64_t, uint64_t, 16, TracedHash>;
+    using Ring  = BroadcastRingBuffer<TracedItem, 4, 1>;
+
+    struct TraceTest : ::testing::Test {
+        void SetUp() override {
+            saved_ = ShmTracer::SampleEvery().load();
+            ShmTracer::SampleEvery().store(1);
+            ShmTracer::Instance().Unlink();
+        }
+        void TearDown() override {
+            ShmTracer::Instance().Unlink();
+            ShmTracer::SampleEvery().store(saved_);
+        }
+
+        // Runs `f` on a fresh thread so its sampling countdown starts over
+        template<typename F>
+        static void OnThread(F&& f) {
+            std::thread(std::forward<F>(f)).join();
+        }
+
+        static std::vector<TraceEvent> Events() {
+            const ShmTraceRing* ring = ShmTracer::Instance().Ring();
+            return ring ? ring->Read() : std::vector<TraceEvent>{};
+        }
+
+        uint32_t saved_{0};
+    };
+}
+
+TEST(ShmTraceRingTest, KeepsTheNewestEvents) {
+    static_assert(std::is_empty_v<NoTraceSpan>, "a disabled span must cost nothing");
+    EXPECT_EQ(sizeof(ShmTraceRing::Slot), CACHE_LINE_SIZE);
+
+    std::vector<uint8_t> mem(ShmTraceRing::SizeOf(8) + CACHE_LINE_SIZE);
+    void* aligned = mem.data() + (CACHE_LINE_SIZE - reinterpret_cast<uintptr_t>(mem.data()) % CACHE_LINE_SIZE);
+    EXPECT_EQ(ShmTraceRing::Create(aligned, 6, 1, 1), nullptr);
+    ShmTraceRing* ring = ShmTraceRing::Create(aligned, 8, 42, 1);
+    ASSERT_NE(ring, nullptr);
+
+    for (uint32_t i = 0; i < 10; ++i) {
+        TraceEvent e;
+        e.bucket = i;
+        ring->Append(e);
+    }
+    auto events = ring->Read();
+    ASSERT_EQ(events.size(), 8u);
+    EXPECT_EQ(events.front().bucket, 2u);
+    EXPECT_EQ(events.back().bucket, 9u);
+    EXPECT_EQ(ring->Written(), 10u);
+    EXPECT_EQ(ring->Overwritten(), 2u);
+
+    EXPECT_EQ(ShmTraceRing::At(aligned, ShmTraceRing::SizeOf(8)), ring);
+    EXPECT_EQ(ShmTraceRing::At(aligned, ShmTraceRing::SizeOf(8) - 1), nullptr);
+    EXPECT_EQ(ShmTraceRing::At(mem.data(), mem.size() - CACHE_LINE_SIZE), nullptr);
+}
+
+TEST_F(TraceTest, RecordsTableVisits) {
+    auto table = std::make_unique<Table>();
+    OnThread([&table] {
+        // 3, 19 and 35 share home bucket 3, the last one probes three buckets
+        for (uint64_t k : {3u, 19u, 35u}) {
+            table->Visit(k, AccessMode::CreateIfMiss, [](auto, auto&, bool) {});
+        }
+        table->Visit(99, AccessMode::AccessExist, [](auto, auto&, bool) {});
+    });
+
+    auto events = Events();
+    ASSERT_EQ(events.size(), 4u);
+    EXPECT_EQ(events[2].op, TraceOp::TableVisit);
+    EXPECT_EQ(events[2].probes, 3u);
+    EXPECT_EQ(events[2].bucket, 5u);
+    EXPECT_EQ(events[2].status, Status::SUCCESS);
+    EXPECT_EQ(events[3].status, Status::NOT_FOUND);
+    EXPECT_GE(events[3].end, events[3].start);
+    EXPECT_NE(events[3].tid, 0u);
+    EXPECT_EQ(ShmTracer::Instance().Ring()->Pid(), static_cast<uint32_t>(getpid()));
+}
+
+TEST_F(TraceTest, RecordsWaitsAndTimeouts) {
+    auto table = std::make_unique<Table>();
+    OnThread([&table] {
+        table->Visit(7, AccessMode::CreateIfMiss, [](auto, auto&, bool) {});
+        table->Visit(7, AccessMode::AccessExist, [&](auto, auto&, bool) {
+            table->Visit(7, AccessMode::AccessExist, [](auto, auto&, bool) {}, std::chrono::milliseconds(1));
+        });
+    });
+
+    auto events = Events();
+    ASSERT_EQ(events.size(), 3u);
+    // The nested visit ends, and is recorded, first
+    const TraceEvent& nested = events[1];
+    EXPECT_EQ(nested.status, Status::TIMEOUT);
+    EXPECT_GT(nested.backoffSteps, 0u);
+    EXPECT_GT(nested.waitTicks, 0u);
+    EXPECT_EQ(events[2].status, Status::SUCCESS);
+    EXPECT_EQ(events[2].backoffSteps, 0u);
+}
+
+TEST_F(TraceTest, SamplesOneInN) {
+    ShmTracer::SampleEvery().store(4);
+    auto table = std::make_unique<Table>();
+    OnThread([&table] {
+        for (uint64_t i = 0; i < 100; ++i) {
+            table->Visit(i % 8, AccessMode::CreateIfMiss, [](auto, auto&, bool) {});
+        }
+        ASSERT_EQ(table->Travel([](auto, auto&, auto&) {}), Status::SUCCESS);
+    });
+    // Operations 0, 4, ... 100 of the thread, the last one is the travel
+    auto events = Events();
+    ASSERT_EQ(events.size(), 26u);
+    EXPECT_EQ(events.back().op, TraceOp::TableTravel);
+    EXPECT_EQ(events.back().probes, 8u);
+    EXPECT_EQ(ShmTracer::Instance().Ring()->SampleEvery(), 4u);
+
+    ShmTracer::SampleEvery().store(0);
+    OnThread([&table] {
+        for (uint64_t i = 0; i < 100; ++i) {
+            table->Visit(i % 8, AccessMode::AccessExist, [](auto, auto&, bool) {});
+        }
+    });
+    EXPECT_EQ(Events().size(), 26u);
+}
+
+TEST_F(TraceTest, RecordsRingPushes) {
+    Ring ring;
+    ring.init(1);
+    OnThread([&ring] {
+        for (uint64_t i = 0; i < 5; ++i) {
+            ring.push(TracedItem{i}); // the fifth finds the ring full and times out
+        }
+    });
+    auto events = Events();
+    ASSERT_EQ(events.size(), 5u);
+    EXPECT_EQ(events[0].op, TraceOp::RingPush);
+    EXPECT_EQ(events[3].bucket, 3u);
+    EXPECT_EQ(events[4].status, Status::TIMEOUT);
+    EXPECT_GT(events[4].waitTicks, 0u);
+}
+
+TEST_F(TraceTest, ForkedChildWritesItsOwnSegment) {
+    auto* table = static_cast<Table*>(mmap(nullptr, sizeof(Table), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0));
+    ASSERT_NE(table, MAP_FAILED);
+    new (table) Table();
+    table->Visit(1, AccessMode::CreateIfMiss, [](auto, auto&, bool) {});
+    ASSERT_NE(ShmTracer::Instance().Ring(), nullptr);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        for (uint64_t k = 2; k < 5; ++k) {
+            table->Visit(k, AccessMode::CreateIfMiss, [](auto, auto&, bool) {});
+        }
+        const ShmTraceRing* ring = ShmTracer::Instance().Ring();
+        _exit(ring && ring->Pid() == static_cast<uint32_t>(getpid()) ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    EXPECT_EQ(Events().size(), 1u);
+
+    // The child's segment outlives it
+    const std::string path = TracePath(static_cast<uint32_t>(pid));
+    int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    ASSERT_GE(fd, 0);
+    const std::size_t bytes = ShmTraceRing::SizeOf(ShmTracer::Instance().Ring()->Capacity());
+    void* addr = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(addr, MAP_FAILED);
+    const ShmTraceRing* child = ShmTraceRing::At(addr, bytes);
+    ASSERT_NE(child, nullptr);
+    EXPECT_EQ(child->Read().size(), 3u);
+
+    std::ostringstream json;
+    WriteChromeTrace(json, {ShmTracer::Instance().Ring(), child});
+    const std::string text = json.str();
+    EXPECT_NE(text.find("\"traceEvents\":["), std::string::npos);
+    EXPECT_NE(text.find("\"name\":\"TableVisit\",\"cat\":\"shmap\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(text.find("\"pid\":" + std::to_string(pid)), std::string::npos);
+    EXPECT_NE(text.find("\"status\":\"SUCCESS\""), std::string::npos);
+
+    munmap(addr, bytes);
+    shm_unlink(path.c_str());
+    munmap(table, sizeof(Table));
+}
+
+TEST_F(TraceTest, NormalExitRemovesTheSegment) {
+    auto* table = static_cast<Table*>(mmap(nullptr, sizeof(Table), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0));
+    ASSERT_NE(table, MAP_FAILED);
+    new (table) Table();
+
+    // One child exits normally, the other as if it crashed
+    pid_t pids[2];
+    for (int crash = 0; crash < 2; ++crash) {
+        pids[crash] = fork();
+        if (pids[crash] == 0) {
+            table->Visit(1, AccessMode::CreateIfMiss, [](auto, auto&, bool) {});
+            if (crash) {
+                _exit(0);
+            }
+            std::exit(0);
+        }
+        int status = 0;
+        ASSERT_EQ(waitpid(pids[crash], &status, 0), pids[crash]);
+    }
+
+    const std::string exited  = TracePath(static_cast<uint32_t>(pids[0]));
+    const std::string crashed = TracePath(static_cast<uint32_t>(pids[1]));
+    EXPECT_EQ(shm_unlink(exited.c_str()), -1);
+    EXPECT_EQ(shm_unlink(crashed.c_str()), 0);
+    munmap(table, sizeof(Table));
+}
+
+TEST_F(TraceTest, UnlinkWhileOtherThreadsRecord) {
+    auto table = std::make_unique<Table>();
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 2; ++t) {
+        writers.emplace_back([&table, &stop] {
+            while (!stop.load()) {
+                table->Visit(1, AccessMode::CreateIfMiss, [](auto, auto&, bool) {});
+            }
+        });
+    }
+    // The old ring stays mapped, a writer still appending to it never faults
+    for (int i = 0; i < 200; ++i) {
+        ShmTracer::Instance().Unlink();
+        std::this_thread::yield();
+    }
+    stop = true;
+    for (auto& w : writers) w.join();
+
+    // Events after the last Unlink go to a new segment
+    OnThread([&table] { table->Visit(1, AccessMode::AccessExist, [](auto, auto&, bool) {}); });
+    ASSERT_NE(ShmTracer::Instance().Ring(), nullptr);
+    EXPECT_EQ(ShmTracer::Instance().Ring()->Pid(), static_cast<uint32_t>(getpid()));
+}
@@ -104,6 +104,124 @@ TEST(ShmVectorTest, MultiThreadedPushBack) {
     }
 }
 
+TEST(ShmVectorTest, CommitAdvancesInOrder) {
+    ShmVector<int, 16> v{};
+    auto off1 = v.allocate(2);
+    auto off2 = v.allocate(3);
+    ASSERT_TRUE(off1.has_value() && off2.has_value());
+    EXPECT_EQ(v.size(), 5u);
+    EXPECT_EQ(v.committed(), 0u);
+
+    // Later slots can not be published before the earlier ones
+    EXPECT_FALSE(v.commit(*off2, 3, std::chrono::milliseconds(1)));
+    EXPECT_EQ(v.committed(), 0u);
+
+    // The timed out slots are carried along once the earlier ones commit
+    ASSERT_TRUE(v.commit(*off1, 2));
+    EXPECT_EQ(v.committed(), 5u);
+
+    v.clear();
+    EXPECT_EQ(v.committed(), 0u);
+    auto off3 = v.allocate(1);
+    ASSERT_TRUE(off3.has_value());
+    EXPECT_EQ(*off3, 0u);
+    ASSERT_TRUE(v.commit(*off3, 1));
+    EXPECT_EQ(v.committed(), 1u);
+}
+
+TEST(ShmVectorTest, TimedOutPushBackDoesNotBlockLaterWriters) {
+    ShmVector<int, 16> v{};
+    auto stalled = v.allocate(1);
+    ASSERT_TRUE(stalled.has_value());
+
+    // Gives up waiting for the stalled slot, yet its element is not lost
+    auto off = v.allocate(1);
+    ASSERT_TRUE(off.has_value());
+    v[*off] = 2;
+    EXPECT_FALSE(v.commit(*off, 1, std::chrono::milliseconds(1)));
+
+    v[*stalled] = 1;
+    ASSERT_TRUE(v.commit(*stalled, 1));
+    EXPECT_EQ(v.committed(), 2u);
+
+    auto idx = v.push_back(3);
+    ASSERT_TRUE(idx.has_value());
+    EXPECT_EQ(v.committed(), 3u);
+    EXPECT_EQ(v[1], 2);
+}
+
+TEST(ShmVectorTest, PushBackDoesNotWaitForEarlierWriters) {
+    ShmVector<int, 16> v{};
+    auto stalled = v.allocate(1);
+    ASSERT_TRUE(stalled.has_value());
+
+    // Returns its index at once, published only behind the stalled slot
+    auto idx = v.push_back(2);
+    ASSERT_TRUE(idx.has_value());
+    EXPECT_EQ(*idx, 1u);
+    EXPECT_EQ(v.committed(), 0u);
+
+    v[*stalled] = 1;
+    ASSERT_TRUE(v.commit(*stalled, 1));
+    EXPECT_EQ(v.committed(), 2u);
+    EXPECT_EQ(v[1], 2);
+}
+
+TEST(ShmVectorTest, IterateCommitted) {
+    ShmVector<int, 16> v{};
+    for (int i = 0; i < 6; ++i) {
+        ASSERT_TRUE(v.push_back(i).has_value());
+    }
+    // Reserved but not yet committed slot is invisible
+    ASSERT_TRUE(v.allocate(1).has_value());
+
+    int sum = 0;
+    EXPECT_EQ(v.iterate_committed([&sum](std::size_t, const int& x) { sum += x; }), 6u);
+    EXPECT_EQ(sum, 15);
+
+    // Early stop
+    std::size_t visited = v.iterate_committed([](std::size_t idx, const int&) { return idx < 2; });
+    EXPECT_EQ(visited, 3u);
+}
+
+TEST(ShmVectorTest, ConcurrentReadersSeeOnlyCompleteElements) {
+    struct Pair {
+        long a;
+        long b;
+    };
+    ShmVector<Pair, 8192> v{};
+    const int nthreads = 4;
+    const int per_thread = 1024;
+    std::atomic<bool> done{false};
+    std::atomic<bool> torn{false};
+
+    std::thread reader([&]() {
+        while (!done.load(std::memory_order_acquire)) {
+            v.iterate_committed([&](std::size_t, const Pair& p) {
+                if (p.a != -p.b) torn.store(true);
+            });
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < nthreads; ++t) {
+        writers.emplace_back([t, &v]() {
+            for (int i = 0; i < per_thread; ++i) {
+                long val = t * per_thread + i + 1;
+                if (!v.push_back(Pair{val, -val})) {
+                    std::abort();
+                }
+            }
+        });
+    }
+    for (auto& th : writers) th.join();
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    EXPECT_FALSE(torn.load());
+    EXPECT_EQ(v.committed(), static_cast<std::size_t>(nthreads * per_thread));
+}
+
 // =============================================================================
 // Multi-Process Test (POSIX shared memory + fork)
 // =============================================================================
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "shmap/shm_vector_algorithm.h"
+
+using namespace shmap;
+
+namespace {
+    template<typename VEC>
+    void FillRandom(VEC& v, std::size_t n, uint64_t seed, uint64_t range) {
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<uint64_t> dist(0, range);
+        for (std::size_t i = 0; i < n; ++i) {
+            ASSERT_TRUE(v.push_back(dist(rng)).has_value());
+        }
+    }
+}
+
+TEST(ShmVectorAlgorithmTest, ParallelSortMatchesStdSort) {
+    using Vec = ShmVector<uint64_t, 1 << 17>;
+    auto* v = new Vec{};
+    FillRandom(*v, 100000, 42, 1 << 20);
+
+    std::vector<uint64_t> expected(v->begin(), v->end());
+    std::sort(expected.begin(), expected.end());
+
+    ParallelSort(*v, 4);
+    ASSERT_TRUE(std::equal(expected.begin(), expected.end(), v->begin(), v->end()));
+
+    // Descending with custom comparator
+    ParallelSort(*v, 3, std::greater<uint64_t>());
+    ASSERT_TRUE(std::is_sorted(v->begin(), v->end(), std::greater<uint64_t>()));
+    delete v;
+}
+
+TEST(ShmVectorAlgorithmTest, UniqueShrinksVector) {
+    ShmVector<int, 16> v{};
+    for (int x : {1, 1, 2, 3, 3, 3, 7, 9, 9}) {
+        ASSERT_TRUE(v.push_back(x).has_value());
+    }
+    EXPECT_EQ(Unique(v), 5u);
+    EXPECT_EQ(v.committed(), 5u);
+    EXPECT_EQ(std::vector<int>(v.begin(), v.end()), std::vector<int>({1, 2, 3, 7, 9}));
+
+    // Freed slots can be appended again
+    ASSERT_EQ(v.push_back(11), std::optional<std::size_t>(5));
+}
+
+TEST(ShmVectorAlgorithmTest, LowerBound) {
+    ShmVector<int, 16> v{};
+    for (int x : {2, 4, 6, 8}) {
+        ASSERT_TRUE(v.push_back(x).has_value());
+    }
+    EXPECT_EQ(LowerBound(v, 1), 0u);
+    EXPECT_EQ(LowerBound(v, 4), 1u);
+    EXPECT_EQ(LowerBound(v, 5), 2u);
+    EXPECT_EQ(LowerBound(v, 9), 4u);
+}
+
+TEST(ShmVectorAlgorithmTest, EytzingerLowerBoundMatchesBinarySearch) {
+    using Vec = ShmVector<uint64_t, 4096>;
+    for (std::size_t n : {0u, 1u, 2u, 7u, 8u, 1000u, 4096u}) {
+        Vec sorted{};
+        Vec layout{};
+        FillRandom(sorted, n, n, 10000);
+        ParallelSort(sorted, 2);
+        Unique(sorted);
+        ASSERT_TRUE(BuildEytzinger(sorted, layout));
+        ASSERT_EQ(layout.committed(), sorted.committed());
+        if (n > 0) {
+            ASSERT_FALSE(BuildEytzinger(sorted, layout));
+        }
+
+        for (uint64_t key = 0; key <= 10001; key += 7) {
+            std::size_t expect = LowerBound(sorted, key);
+            std::size_t got = EytzingerLowerBound(layout, key);
+            if (expect == sorted.committed()) {
+                ASSERT_EQ(got, layout.committed()) << "n=" << n << " key=" << key;
+            } else {
+                ASSERT_LT(got, layout.committed()) << "n=" << n << " key=" << key;
+                ASSERT_EQ(layout[got], sorted[expect]) << "n=" << n << " key=" << key;
+            }
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "shmap/tagged_index.h"
+#include "shmap/shm_pool.h"
+
+using namespace shmap;
+
+TEST(TaggedIndexTest, PackIndexAndTag) {
+    using Small = TaggedIndex<20, 12>;
+    static_assert(sizeof(Small) == sizeof(uint32_t));
+    static_assert(Small::NIL == (1u << 20) - 1);
+
+    Small ti(12345, 7);
+    EXPECT_EQ(ti.Index(), 12345u);
+    EXPECT_EQ(ti.Tag(), 7u);
+    EXPECT_FALSE(ti.IsNil());
+    EXPECT_TRUE(Small::Nil().IsNil());
+
+    // Next bumps the tag, the same index of another generation is not equal
+    Small next = ti.Next(12345);
+    EXPECT_EQ(next.Index(), 12345u);
+    EXPECT_EQ(next.Tag(), 8u);
+    EXPECT_NE(next, ti);
+
+    // Tag wraps around inside its bits
+    Small last(1, Small::MAX_TAG);
+    EXPECT_EQ(last.Next(2).Tag(), 0u);
+    EXPECT_EQ(last.Next(2).Index(), 2u);
+}
+
+TEST(TaggedIndexTest, AtomicCompareExchange) {
+    AtomicTaggedIndex<32, 32> atomic(TaggedIndex<32, 32>(1, 0));
+
+    auto stale = atomic.Load();
+    auto current = stale;
+    ASSERT_TRUE(atomic.CompareExchange(current, current.Next(2)));
+    current = atomic.Load();
+    ASSERT_TRUE(atomic.CompareExchange(current, current.Next(1)));
+
+    // Index 1 is back but the tag moved on, the stale snapshot must fail
+    EXPECT_EQ(atomic.Load().Index(), 1u);
+    auto expected = stale;
+    EXPECT_FALSE(atomic.CompareExchange(expected, stale.Next(3)));
+    EXPECT_EQ(expected, atomic.Load());
+    EXPECT_EQ(expected.Tag(), 2u);
+}
+
+TEST(TaggedIndexTest, WideCompareExchange) {
+    AtomicWideTaggedIndex atomic(WideTaggedIndex{UINT64_MAX - 1, 5});
+    EXPECT_EQ(atomic.Load(), (WideTaggedIndex{UINT64_MAX - 1, 5}));
+
+    WideTaggedIndex expected{UINT64_MAX - 1, 4};
+    EXPECT_FALSE(atomic.CompareExchange(expected, WideTaggedIndex{0, 0}));
+    EXPECT_EQ(expected, (WideTaggedIndex{UINT64_MAX - 1, 5}));
+    EXPECT_TRUE(atomic.CompareExchange(expected, expected.Next(42)));
+    EXPECT_EQ(atomic.Load(), (WideTaggedIndex{42, 6}));
+
+    atomic.Store(WideTaggedIndex{7, 7});
+    EXPECT_EQ(atomic.Load(), (WideTaggedIndex{7, 7}));
+}
+
+TEST(TaggedIndexTest, WideConcurrentIncrement) {
+    constexpr int THREADS = 4;
+    constexpr int LOOPS = 20000;
+    AtomicWideTaggedIndex atomic;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < LOOPS; ++i) {
+                auto current = atomic.Load();
+                while (!atomic.CompareExchange(current, current.Next(current.index + 2))) {}
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    EXPECT_EQ(atomic.Load(), (WideTaggedIndex{2ull * THREADS * LOOPS, 1ull * THREADS * LOOPS}));
+}
+
+TEST(TaggedIndexTest, SlotPayloadRoundTrip) {
+    // Not a multiple of the word size: the tail word is padded
+    struct Odd {
+        uint32_t a;
+        uint8_t  b;
+        uint64_t c;
+        uint8_t  d[3];
+    };
+    static_assert(SlotPayload<Odd>::WORDS == 3, "24 bytes take three words");
+
+    SlotPayload<Odd> payload;
+    payload.Store(Odd{1, 2, 3, {4, 5, 6}});
+    Odd out{};
+    payload.Load(out);
+    EXPECT_EQ(out.a, 1u);
+    EXPECT_EQ(out.b, 2u);
+    EXPECT_EQ(out.c, 3u);
+    EXPECT_EQ(out.d[2], 6u);
+}
+
+TEST(ShmPoolTest, AllocateAndRelease) {
+    ShmPool<uint64_t, 4> pool;
+    EXPECT_EQ(pool.available(), 4u);
+
+    std::set<uint32_t> taken;
+    for (int i = 0; i < 4; ++i) {
+        auto idx = pool.allocate();
+        ASSERT_TRUE(idx.has_value());
+        pool[*idx] = *idx * 10;
+        taken.insert(*idx);
+    }
+    EXPECT_EQ(taken.size(), 4u);
+    EXPECT_FALSE(pool.allocate().has_value());
+    EXPECT_EQ(pool.available(), 0u);
+
+    pool.release(2);
+    auto idx = pool.allocate();
+    ASSERT_TRUE(idx.has_value());
+    EXPECT_EQ(*idx, 2u);
+    EXPECT_EQ(pool[*idx], 20u);
+}
+
+TEST(ShmPoolTest, ConcurrentAllocateReleaseKeepsSlotsExclusive) {
+    constexpr int THREADS = 8;
+    constexpr int LOOPS = 20000;
+    constexpr std::size_t CAPACITY = 16;
+
+    auto* pool = new ShmPool<uint64_t, CAPACITY>();
+    std::atomic<int> owners[CAPACITY] = {};
+    std::atomic<bool> shared{false};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < LOOPS; ++i) {
+                auto idx = pool->allocate();
+                if (!idx) continue;
+                // Two owners of one slot would see each other's mark
+                if (owners[*idx].fetch_add(1) != 0) shared.store(true);
+                (*pool)[*idx] += 1;
+                owners[*idx].fetch_sub(1);
+                pool->release(*idx);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    EXPECT_FALSE(shared.load());
+    EXPECT_EQ(pool->available(), CAPACITY);
+
+    std::set<uint32_t> all;
+    while (auto idx = pool->allocate()) {
+        all.insert(*idx);
+    }
+    EXPECT_EQ(all.size(), CAPACITY);
+    delete pool;
+}
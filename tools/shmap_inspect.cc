@@ -0,0 +1,187 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+// shmap-inspect: attach read-only to a ShmHashTable segment and report its health.
+//
+// The layout descriptor comes from the owning program:
+//   std::puts(ShmTableLayout::OfStorage<Table>().ToString().c_str());
+//
+//   shmap-inspect -l 'cap=65536,bucket=128,off=64,key=8+8:u,value=16+8:u,hash=std' /my_table
+//   shmap-inspect -l ... -s 200 /my_table      report buckets held for 200ms
+//   shmap-inspect -l ... -d 100 /my_table      dump the first 100 entries
+
+#include "shmap/shm_table_inspector.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace shmap;
+
+namespace {
+
+void Usage(const char* prog) {
+    std::fprintf(stderr,
+        "usage: %s -l <layout> [-s stuck_ms] [-d limit] [-r regions] <shm-path>\n"
+        "  -l  layout descriptor printed by ShmTableLayout::ToString()\n"
+        "  -s  sample again after stuck_ms and report buckets busy in both samples (default 100)\n"
+        "  -d  dump up to `limit` entries (0 for all)\n"
+        "  -r  number of table slices for the skew figures (default 64)\n", prog);
+}
+
+const char* StateName(uint32_t state) {
+    using States = ShmBucket<char, char>;
+    switch (state) {
+    case States::EMPTY:     return "EMPTY";
+    case States::INSERTING: return "INSERTING";
+    case States::READY:     return "READY";
+    case States::ACCESSING: return "ACCESSING";
+    default:                return "INVALID";
+    }
+}
+
+// Power of two bins: 0, 1, 2, 3-4, 5-8, ...
+void PrintHistogram(const char* title, const std::vector<uint64_t>& counts, std::size_t first) {
+    uint64_t total = 0;
+    for (std::size_t i = first; i < counts.size(); ++i) total += counts[i];
+    std::printf("%s\n", title);
+    if (total == 0) {
+        std::printf("  (none)\n");
+        return;
+    }
+    for (std::size_t lo = first; lo < counts.size(); ) {
+        const std::size_t hi = lo <= 2 ? lo : 2 * (lo - 1);
+        const std::size_t next = hi + 1;
+        uint64_t n = 0;
+        for (std::size_t i = lo; i <= hi && i < counts.size(); ++i) n += counts[i];
+        if (n == 0) {
+            lo = next;
+            continue;
+        }
+        double pct = 100.0 * static_cast<double>(n) / static_cast<double>(total);
+        char range[48];
+        if (lo == hi) {
+            std::snprintf(range, sizeof(range), "%zu", lo);
+        } else {
+            std::snprintf(range, sizeof(range), "%zu-%zu", lo, hi);
+        }
+        std::printf("  %-12s %12" PRIu64 " %6.2f%% %s\n", range, n, pct,
+            std::string(static_cast<std::size_t>(pct / 2), '#').c_str());
+        lo = next;
+    }
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const char* layoutText = nullptr;
+    long stuckMs = 100;
+    long dumpLimit = -1;
+    long regions = 64;
+    int opt;
+    while ((opt = getopt(argc, argv, "l:s:d:r:h")) != -1) {
+        switch (opt) {
+        case 'l': layoutText = optarg; break;
+        case 's': stuckMs = std::atol(optarg); break;
+        case 'd': dumpLimit = std::atol(optarg); break;
+        case 'r': regions = std::atol(optarg); break;
+        default:  Usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (!layoutText || optind + 1 != argc || regions <= 0 || stuckMs < 0) {
+        Usage(argv[0]);
+        return 2;
+    }
+    auto layout = ShmTableLayout::Parse(layoutText);
+    if (!layout) {
+        std::fprintf(stderr, "invalid layout: %s\n", layoutText);
+        return 2;
+    }
+
+    const char* path = argv[optind];
+    int fd = ::shm_open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        std::fprintf(stderr, "%s: shm_open failed: %s\n", path, std::strerror(errno));
+        return 1;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        std::fprintf(stderr, "%s: fstat failed: %s\n", path, std::strerror(errno));
+        ::close(fd);
+        return 1;
+    }
+    const auto bytes = static_cast<std::size_t>(st.st_size);
+    void* addr = bytes ? ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        std::fprintf(stderr, "%s: mmap failed: %s\n", path, std::strerror(errno));
+        return 1;
+    }
+
+    ShmTableInspector inspector(addr, bytes, *layout);
+    if (!inspector.Valid()) {
+        std::fprintf(stderr, "%s: layout needs %zu bytes at offset %zu, segment has %zu\n",
+            path, layout->Span(), layout->offset, bytes);
+        return 1;
+    }
+
+    auto report = inspector.Inspect(static_cast<std::size_t>(regions));
+    std::printf("%s: %zu buckets of %u bytes\n", path, report.capacity, layout->bucketSize);
+    std::printf("  load factor   %.4f\n", report.LoadFactor());
+    std::printf("  ready         %zu\n", report.ready);
+    std::printf("  inserting     %zu\n", report.inserting);
+    std::printf("  accessing     %zu\n", report.accessing);
+    if (report.invalid) {
+        std::printf("  invalid       %zu (wrong layout?)\n", report.invalid);
+    }
+    std::printf("  max cluster   %zu\n", report.MaxCluster());
+    if (layout->hash) {
+        std::printf("  probe mean    %.3f\n", report.MeanProbe());
+        std::printf("  probe max     %zu\n", report.MaxProbe());
+    }
+    std::printf("  region skew   %.3f (fullest of %ld slices / mean)\n", ShmTableReport::Skew(report.regions), regions);
+    if (layout->hash) {
+        std::printf("  hash skew     %.3f (most homed slice / mean)\n", ShmTableReport::Skew(report.homes));
+    }
+    std::printf("\n");
+    PrintHistogram("Cluster lengths (runs of occupied buckets):", report.clusters, 1);
+    if (layout->hash) {
+        PrintHistogram("Probe lengths (distance from home bucket):", report.probes, 0);
+    } else {
+        std::printf("Probe lengths: unavailable, table does not use std::hash (hash=none)\n");
+    }
+
+    if (!report.busy.empty() && stuckMs > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(stuckMs));
+        auto stuck = ShmTableInspector::Stuck(report, inspector.Inspect(static_cast<std::size_t>(regions)));
+        std::printf("\nBuckets busy for over %ldms: %zu\n", stuckMs, stuck.size());
+        for (const auto& [idx, state] : stuck) {
+            std::printf("  [%zu] %s", idx, StateName(state));
+            if (state == ShmBucket<char, char>::ACCESSING) {
+                std::printf(" key=%s", inspector.FormatKey(idx).c_str());
+            }
+            std::printf("\n");
+        }
+    }
+
+    if (dumpLimit >= 0) {
+        std::printf("\nEntries:\n");
+        const std::size_t limit = dumpLimit == 0 ? SIZE_MAX : static_cast<std::size_t>(dumpLimit);
+        inspector.Dump([&inspector](std::size_t idx, const void*, const void*) {
+            std::printf("  [%zu] %s => %s\n", idx, inspector.FormatKey(idx).c_str(), inspector.FormatValue(idx).c_str());
+        }, limit);
+    }
+    return 0;
+}
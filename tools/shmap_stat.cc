@@ -0,0 +1,168 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+// shmap-stat: attach read-only to shm segments and print their metrics blocks.
+//
+//   shmap-stat /my_table                 print every counter once
+//   shmap-stat -i 1000 /my_table /ring   print totals and rates every second
+//   shmap-stat -i 500 -n 10 /my_table    stop after 10 samples
+
+#include "shmap/shm_metrics.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace shmap;
+
+namespace {
+
+struct Segment {
+    std::string path;
+    const void* addr{nullptr};
+    std::size_t bytes{0};
+    std::vector<std::pair<std::size_t, ShmMetricsView>> blocks;
+};
+
+struct Sample {
+    std::vector<uint64_t> values; // counters of every block, in order
+};
+
+void Usage(const char* prog) {
+    std::fprintf(stderr,
+        "usage: %s [-i interval_ms] [-n count] <shm-path>...\n"
+        "  -i  print every interval_ms with per second rates\n"
+        "  -n  number of samples to print with -i (default unlimited)\n", prog);
+}
+
+bool Attach(Segment& seg) {
+    int fd = ::shm_open(seg.path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::fprintf(stderr, "%s: shm_open failed: %s\n", seg.path.c_str(), std::strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        std::fprintf(stderr, "%s: empty or unreadable segment\n", seg.path.c_str());
+        ::close(fd);
+        return false;
+    }
+    seg.bytes = static_cast<std::size_t>(st.st_size);
+    void* addr = ::mmap(nullptr, seg.bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        std::fprintf(stderr, "%s: mmap failed: %s\n", seg.path.c_str(), std::strerror(errno));
+        return false;
+    }
+    seg.addr = addr;
+    ShmMetricsView::Scan(seg.addr, seg.bytes, [&seg](std::size_t off, const ShmMetricsView& view) {
+        seg.blocks.emplace_back(off, view);
+    });
+    if (seg.blocks.empty()) {
+        std::fprintf(stderr, "%s: no metrics block found (built without ShmTableMetrics/ShmRingMetrics?)\n",
+            seg.path.c_str());
+    }
+    return true;
+}
+
+Sample Take(const std::vector<Segment>& segments) {
+    Sample sample;
+    for (const auto& seg : segments) {
+        for (const auto& [off, view] : seg.blocks) {
+            for (uint32_t id = 0; id < METRIC_COUNTERS; ++id) {
+                sample.values.push_back(view.Get(id));
+            }
+            for (uint32_t id = 0; id < METRIC_GAUGES; ++id) {
+                sample.values.push_back(view.GetGauge(id));
+            }
+        }
+    }
+    return sample;
+}
+
+// `prev` is null for a one-shot print, rates are printed otherwise
+void Print(const std::vector<Segment>& segments, const Sample& cur, const Sample* prev, double seconds) {
+    std::size_t i = 0;
+    for (const auto& seg : segments) {
+        for (const auto& [off, view] : seg.blocks) {
+            std::printf("%s +0x%zx %s (%u shards)\n", seg.path.c_str(), off,
+                MetricKindName(view.Kind()), view.Shards());
+            for (uint32_t id = 0; id < METRIC_COUNTERS; ++id, ++i) {
+                const char* name = MetricName(view.Kind(), id);
+                if (!name) continue;
+                if (prev) {
+                    double rate = static_cast<double>(cur.values[i] - prev->values[i]) / seconds;
+                    std::printf("  %-18s %16" PRIu64 " %14.1f/s\n", name, cur.values[i], rate);
+                } else {
+                    std::printf("  %-18s %16" PRIu64 "\n", name, cur.values[i]);
+                }
+            }
+            for (uint32_t id = 0; id < METRIC_GAUGES; ++id, ++i) {
+                const char* name = GaugeName(view.Kind(), id);
+                if (!name) continue;
+                std::printf("  %-18s %16" PRIu64 "\n", name, cur.values[i]);
+            }
+        }
+    }
+    std::fflush(stdout);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    long intervalMs = 0;
+    long count = -1;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:n:h")) != -1) {
+        switch (opt) {
+        case 'i': intervalMs = std::atol(optarg); break;
+        case 'n': count = std::atol(optarg); break;
+        default:  Usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind >= argc || intervalMs < 0) {
+        Usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<Segment> segments;
+    for (int i = optind; i < argc; ++i) {
+        Segment seg;
+        seg.path = argv[i];
+        if (!Attach(seg)) {
+            return 1;
+        }
+        segments.push_back(std::move(seg));
+    }
+
+    Sample prev = Take(segments);
+    if (intervalMs == 0) {
+        Print(segments, prev, nullptr, 0);
+        return 0;
+    }
+
+    auto last = std::chrono::steady_clock::now();
+    for (long n = 0; count < 0 || n < count; ++n) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        Sample cur = Take(segments);
+        auto now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - last).count();
+        Print(segments, cur, &prev, seconds);
+        std::printf("\n");
+        prev = std::move(cur);
+        last = now;
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+/**
+* Copyright (c) wangbo@joycode.art 2024
+*/
+
+// shmap-trace: export the trace rings of processes built with SHMAP_TRACE_ENABLE.
+//
+//   shmap-trace 1234 1235 > trace.json        rings of two processes, by pid
+//   shmap-trace -o trace.json /shmap_trace.1234
+//   shmap-trace -u -o trace.json 1234         remove the segment after export
+//
+// Open the output in chrome://tracing or https://ui.perfetto.dev.
+
+#include "shmap/shm_trace.h"
+
+#include <cctype>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace shmap;
+
+namespace {
+
+void Usage(const char* prog) {
+    std::fprintf(stderr,
+        "usage: %s [-o out.json] [-u] <pid|shm-path>...\n"
+        "  -o  write the Chrome trace JSON here instead of stdout\n"
+        "  -u  unlink the trace segments after exporting them\n", prog);
+}
+
+std::string PathOf(const char* arg) {
+    for (const char* c = arg; *c; ++c) {
+        if (!std::isdigit(static_cast<unsigned char>(*c))) {
+            return arg;
+        }
+    }
+    return TracePath(static_cast<uint32_t>(std::strtoul(arg, nullptr, 10)));
+}
+
+const ShmTraceRing* Attach(const std::string& path) {
+    int fd = ::shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::fprintf(stderr, "%s: shm_open failed: %s\n", path.c_str(), std::strerror(errno));
+        return nullptr;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        std::fprintf(stderr, "%s: empty or unreadable segment\n", path.c_str());
+        ::close(fd);
+        return nullptr;
+    }
+    const auto bytes = static_cast<std::size_t>(st.st_size);
+    void* addr = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        std::fprintf(stderr, "%s: mmap failed: %s\n", path.c_str(), std::strerror(errno));
+        return nullptr;
+    }
+    const ShmTraceRing* ring = ShmTraceRing::At(addr, bytes);
+    if (!ring) {
+        std::fprintf(stderr, "%s: not a trace segment\n", path.c_str());
+        ::munmap(addr, bytes);
+    }
+    return ring;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const char* output = nullptr;
+    bool unlink = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "o:uh")) != -1) {
+        switch (opt) {
+        case 'o': output = optarg; break;
+        case 'u': unlink = true; break;
+        default:  Usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind >= argc) {
+        Usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<std::string> paths;
+    std::vector<const ShmTraceRing*> rings;
+    for (int i = optind; i < argc; ++i) {
+        paths.push_back(PathOf(argv[i]));
+        const ShmTraceRing* ring = Attach(paths.back());
+        if (!ring) {
+            return 1;
+        }
+        rings.push_back(ring);
+        std::fprintf(stderr, "%s: pid %u, %" PRIu64 " events written, %" PRIu64 " overwritten, 1 in %u sampled\n",
+            paths.back().c_str(), ring->Pid(), ring->Written(), ring->Overwritten(), ring->SampleEvery());
+    }
+
+    if (output) {
+        std::ofstream out(output);
+        if (!out) {
+            std::fprintf(stderr, "%s: cannot open for writing\n", output);
+            return 1;
+        }
+        WriteChromeTrace(out, rings);
+    } else {
+        WriteChromeTrace(std::cout, rings);
+    }
+
+    if (unlink) {
+        for (const auto& path : paths) {
+            ::shm_unlink(path.c_str());
+        }
+    }
+    return 0;
+}